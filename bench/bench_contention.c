@@ -0,0 +1,684 @@
+/**
+ * @file bench_contention.c
+ * @brief Multithreaded contention and tail-latency benchmark.
+ *
+ * Runs N pinned threads against one shared pool and records the latency of
+ * every acquire and release (cycle counter, log-linear histograms). Reports
+ * p50 / p99 / p99.9 / p99.99 / max per thread count.
+ *
+ * The pool API is single-writer by contract, so threads serialize through a
+ * pool mode:
+ *  - mutex: pthread mutex around each call
+ *  - spin:  test-and-test-and-set spinlock around each call
+ *
+ * Workload mixes:
+ *  - same:    acquire, hold, release on the same thread
+ *  - handoff: acquire, hold, pass to the next thread, which releases it
+ *  - bursty:  acquire a burst of buffers, hold, release them all
+ *
+ * Build:
+ *   cc -O2 -pthread -I. bench/bench_contention.c bench/bench_util.c buffer.c -o bench_contention
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "buffer.h"
+#include "bench_util.h"
+
+#define BENCH_HANDOFF_SLOTS      (1024u)     /**< Per-thread handoff queue length (power of two). */
+#define BENCH_MAX_BURST          (256u)
+#define BENCH_MAX_THREADS        (256u)
+
+/**
+ * @brief Pool serialization mode.
+ */
+typedef enum
+{
+    BENCH_MODE_MUTEX = 0,
+    BENCH_MODE_SPIN,
+    BENCH_MODE_COUNT
+} bench_mode_et;
+
+/**
+ * @brief Workload mix.
+ */
+typedef enum
+{
+    BENCH_MIX_SAME = 0,
+    BENCH_MIX_HANDOFF,
+    BENCH_MIX_BURSTY,
+    BENCH_MIX_COUNT
+} bench_mix_et;
+
+static char const *const bench_mode_names_acp[BENCH_MODE_COUNT] = { "mutex", "spin" };
+static char const *const bench_mix_names_acp[BENCH_MIX_COUNT]   = { "same", "handoff", "bursty" };
+
+/**
+ * @brief Benchmark run configuration (from the command line).
+ */
+typedef struct
+{
+    bench_format_et format_e;
+    FILE           *out_fp;
+    unsigned        max_threads;
+    size_t          buffer_count;
+    size_t          buffer_size;
+    uint64_t        duration_ns;
+    unsigned        hold_iters;      /**< Busy-loop iterations a buffer is held for. */
+    unsigned        burst;           /**< Buffers per burst in the bursty mix. */
+    int             mode_filter;     /**< Mode to run, or -1 for all. */
+    int             mix_filter;      /**< Mix to run, or -1 for all. */
+} bench_cfg_st;
+
+/**
+ * @brief Single-producer single-consumer queue of handed-off buffers.
+ */
+typedef struct
+{
+    buffer_st *volatile slot_asp[BENCH_HANDOFF_SLOTS];
+    volatile uint32_t   head_u32;    /**< Written by the producer (previous thread). */
+    char                pad_ac[64];
+    volatile uint32_t   tail_u32;    /**< Written by the consumer (owning thread). */
+} bench_handoff_st;
+
+/**
+ * @brief Per-thread state and results.
+ */
+typedef struct
+{
+    struct bench_shared_st *shared_sp;
+    pthread_t        thread;
+    unsigned         thread_index;
+    bench_handoff_st handoff_s;
+    bench_hist_st    acquire_hist_s;
+    bench_hist_st    release_hist_s;
+    uint64_t         acquire_failures;
+} bench_thread_st;
+
+/**
+ * @brief State shared by all threads of one run.
+ */
+typedef struct bench_shared_st
+{
+    bench_cfg_st const *cfg_csp;
+    bench_mode_et       mode_e;
+    bench_mix_et        mix_e;
+    unsigned            thread_count;
+    buffer_array_ctx_st ctx_s;
+    pthread_mutex_t     mutex;
+    volatile int        spin_lock;
+    volatile int        start_flag;
+    volatile int        stop_flag;
+    volatile unsigned   ready_count;
+    bench_thread_st    *threads_as;
+} bench_shared_st;
+
+/* -------------------------------------------------------------------------- */
+/* Pool access under the selected mode                                        */
+/* -------------------------------------------------------------------------- */
+
+static void bench_lock(bench_shared_st *shared_sp)
+{
+    if (BENCH_MODE_MUTEX == shared_sp->mode_e)
+    {
+        (void)pthread_mutex_lock(&shared_sp->mutex);
+        return;
+    }
+
+    for (;;)
+    {
+        if (0 == __atomic_exchange_n(&shared_sp->spin_lock, 1, __ATOMIC_ACQUIRE))
+        {
+            return;
+        }
+        while (0 != __atomic_load_n(&shared_sp->spin_lock, __ATOMIC_RELAXED))
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            __asm__ __volatile__("pause");
+#endif
+        }
+    }
+}
+
+static void bench_unlock(bench_shared_st *shared_sp)
+{
+    if (BENCH_MODE_MUTEX == shared_sp->mode_e)
+    {
+        (void)pthread_mutex_unlock(&shared_sp->mutex);
+        return;
+    }
+
+    __atomic_store_n(&shared_sp->spin_lock, 0, __ATOMIC_RELEASE);
+}
+
+static buffer_st *bench_acquire(bench_thread_st *thread_sp)
+{
+    bench_shared_st *shared_sp = thread_sp->shared_sp;
+    buffer_st       *buf_sp;
+    uint64_t         start_ticks;
+
+    start_ticks = bench_ticks();
+    bench_lock(shared_sp);
+    buf_sp = buffer_array_acquire(&shared_sp->ctx_s);
+    bench_unlock(shared_sp);
+    bench_hist_record(&thread_sp->acquire_hist_s, bench_ticks() - start_ticks);
+
+    if (NULL == buf_sp)
+    {
+        thread_sp->acquire_failures++;
+    }
+
+    return buf_sp;
+}
+
+static void bench_release(bench_thread_st *thread_sp, buffer_st *buf_sp)
+{
+    bench_shared_st *shared_sp = thread_sp->shared_sp;
+    uint64_t         start_ticks;
+
+    start_ticks = bench_ticks();
+    bench_lock(shared_sp);
+    (void)buffer_array_release_by_ptr(&shared_sp->ctx_s, buf_sp->data_u8p);
+    bench_unlock(shared_sp);
+    bench_hist_record(&thread_sp->release_hist_s, bench_ticks() - start_ticks);
+}
+
+static void bench_hold(bench_cfg_st const *cfg_csp, buffer_st *buf_sp)
+{
+    volatile uint8_t *data_u8p = buf_sp->data_u8p;
+    unsigned          iter;
+
+    data_u8p[0] = 1u;
+    for (iter = 0u; iter < cfg_csp->hold_iters; ++iter)
+    {
+        __asm__ __volatile__("" ::: "memory");
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Handoff queue                                                              */
+/* -------------------------------------------------------------------------- */
+
+static bool bench_handoff_push(bench_handoff_st *queue_sp, buffer_st *buf_sp)
+{
+    uint32_t head = queue_sp->head_u32;
+    uint32_t tail = __atomic_load_n(&queue_sp->tail_u32, __ATOMIC_ACQUIRE);
+
+    if ((head - tail) >= BENCH_HANDOFF_SLOTS)
+    {
+        return false;
+    }
+
+    queue_sp->slot_asp[head & (BENCH_HANDOFF_SLOTS - 1u)] = buf_sp;
+    __atomic_store_n(&queue_sp->head_u32, head + 1u, __ATOMIC_RELEASE);
+    return true;
+}
+
+static buffer_st *bench_handoff_pop(bench_handoff_st *queue_sp)
+{
+    uint32_t   tail = queue_sp->tail_u32;
+    uint32_t   head = __atomic_load_n(&queue_sp->head_u32, __ATOMIC_ACQUIRE);
+    buffer_st *buf_sp;
+
+    if (head == tail)
+    {
+        return NULL;
+    }
+
+    buf_sp = queue_sp->slot_asp[tail & (BENCH_HANDOFF_SLOTS - 1u)];
+    __atomic_store_n(&queue_sp->tail_u32, tail + 1u, __ATOMIC_RELEASE);
+    return buf_sp;
+}
+
+static void bench_drain_incoming(bench_thread_st *thread_sp)
+{
+    buffer_st *buf_sp;
+
+    while (NULL != (buf_sp = bench_handoff_pop(&thread_sp->handoff_s)))
+    {
+        bench_release(thread_sp, buf_sp);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Worker                                                                     */
+/* -------------------------------------------------------------------------- */
+
+static void bench_pin(unsigned thread_index)
+{
+    cpu_set_t set_s;
+    long      cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (cpu_count <= 0)
+    {
+        return;
+    }
+
+    CPU_ZERO(&set_s);
+    CPU_SET(thread_index % (unsigned)cpu_count, &set_s);
+    (void)pthread_setaffinity_np(pthread_self(), sizeof(set_s), &set_s);
+}
+
+static void *bench_worker(void *arg_p)
+{
+    bench_thread_st    *thread_sp = arg_p;
+    bench_shared_st    *shared_sp = thread_sp->shared_sp;
+    bench_cfg_st const *cfg_csp   = shared_sp->cfg_csp;
+    bench_thread_st    *next_sp   = &shared_sp->threads_as[(thread_sp->thread_index + 1u) % shared_sp->thread_count];
+    buffer_st          *burst_asp[BENCH_MAX_BURST];
+
+    bench_pin(thread_sp->thread_index);
+
+    (void)__atomic_add_fetch(&shared_sp->ready_count, 1u, __ATOMIC_ACQ_REL);
+    while (0 == __atomic_load_n(&shared_sp->start_flag, __ATOMIC_ACQUIRE))
+    {
+    }
+
+    while (0 == __atomic_load_n(&shared_sp->stop_flag, __ATOMIC_RELAXED))
+    {
+        buffer_st *buf_sp;
+        unsigned   index;
+        unsigned   held = 0u;
+
+        switch (shared_sp->mix_e)
+        {
+            case BENCH_MIX_SAME:
+                buf_sp = bench_acquire(thread_sp);
+                if (NULL != buf_sp)
+                {
+                    bench_hold(cfg_csp, buf_sp);
+                    bench_release(thread_sp, buf_sp);
+                }
+                break;
+
+            case BENCH_MIX_HANDOFF:
+                bench_drain_incoming(thread_sp);
+                buf_sp = bench_acquire(thread_sp);
+                if (NULL != buf_sp)
+                {
+                    bench_hold(cfg_csp, buf_sp);
+                    if (false == bench_handoff_push(&next_sp->handoff_s, buf_sp))
+                    {
+                        bench_release(thread_sp, buf_sp);
+                    }
+                }
+                break;
+
+            case BENCH_MIX_BURSTY:
+                for (index = 0u; index < cfg_csp->burst; ++index)
+                {
+                    buf_sp = bench_acquire(thread_sp);
+                    if (NULL != buf_sp)
+                    {
+                        burst_asp[held++] = buf_sp;
+                    }
+                }
+                for (index = 0u; index < held; ++index)
+                {
+                    bench_hold(cfg_csp, burst_asp[index]);
+                }
+                for (index = 0u; index < held; ++index)
+                {
+                    bench_release(thread_sp, burst_asp[index]);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Run and report                                                             */
+/* -------------------------------------------------------------------------- */
+
+static void bench_report_begin(bench_cfg_st const *cfg_csp)
+{
+    switch (cfg_csp->format_e)
+    {
+        case BENCH_FORMAT_CSV:
+            fprintf(cfg_csp->out_fp,
+                    "mode,mix,threads,op,ops,failures,p50_ns,p99_ns,p999_ns,p9999_ns,max_ns\n");
+            break;
+
+        case BENCH_FORMAT_JSON:
+            fprintf(cfg_csp->out_fp,
+                    "{\n  \"context\": {\"buffer_count\": %zu, \"buffer_size\": %zu, \"duration_ns\": %llu, "
+                    "\"hold_iters\": %u, \"burst\": %u, \"ticks_per_ns\": %.4f},\n  \"benchmarks\": [",
+                    cfg_csp->buffer_count, cfg_csp->buffer_size,
+                    (unsigned long long)cfg_csp->duration_ns,
+                    cfg_csp->hold_iters, cfg_csp->burst, bench_ticks_per_ns());
+            break;
+
+        default:
+            fprintf(cfg_csp->out_fp, "%-6s %-8s %7s %-8s %12s %9s %9s %9s %9s %9s %11s\n",
+                    "mode", "mix", "threads", "op", "ops", "failures",
+                    "p50", "p99", "p99.9", "p99.99", "max (ns)");
+            break;
+    }
+}
+
+static void bench_report_row(bench_shared_st const *shared_csp,
+                             char const *op_cp,
+                             bench_hist_st const *hist_csp,
+                             uint64_t failures,
+                             bool first)
+{
+    bench_cfg_st const *cfg_csp = shared_csp->cfg_csp;
+    double              tpn     = bench_ticks_per_ns();
+    double              p50     = (double)bench_hist_percentile(hist_csp, 50.0)   / tpn;
+    double              p99     = (double)bench_hist_percentile(hist_csp, 99.0)   / tpn;
+    double              p999    = (double)bench_hist_percentile(hist_csp, 99.9)   / tpn;
+    double              p9999   = (double)bench_hist_percentile(hist_csp, 99.99)  / tpn;
+    double              max     = (double)hist_csp->max_value / tpn;
+    char const         *mode_cp = bench_mode_names_acp[shared_csp->mode_e];
+    char const         *mix_cp  = bench_mix_names_acp[shared_csp->mix_e];
+
+    switch (cfg_csp->format_e)
+    {
+        case BENCH_FORMAT_CSV:
+            fprintf(cfg_csp->out_fp, "%s,%s,%u,%s,%llu,%llu,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+                    mode_cp, mix_cp, shared_csp->thread_count, op_cp,
+                    (unsigned long long)hist_csp->total_count, (unsigned long long)failures,
+                    p50, p99, p999, p9999, max);
+            break;
+
+        case BENCH_FORMAT_JSON:
+            fprintf(cfg_csp->out_fp,
+                    "%s\n    {\"mode\": \"%s\", \"mix\": \"%s\", \"threads\": %u, \"op\": \"%s\", "
+                    "\"ops\": %llu, \"failures\": %llu, \"p50_ns\": %.1f, \"p99_ns\": %.1f, "
+                    "\"p999_ns\": %.1f, \"p9999_ns\": %.1f, \"max_ns\": %.1f}",
+                    first ? "" : ",",
+                    mode_cp, mix_cp, shared_csp->thread_count, op_cp,
+                    (unsigned long long)hist_csp->total_count, (unsigned long long)failures,
+                    p50, p99, p999, p9999, max);
+            break;
+
+        default:
+            fprintf(cfg_csp->out_fp, "%-6s %-8s %7u %-8s %12llu %9llu %9.0f %9.0f %9.0f %9.0f %11.0f\n",
+                    mode_cp, mix_cp, shared_csp->thread_count, op_cp,
+                    (unsigned long long)hist_csp->total_count, (unsigned long long)failures,
+                    p50, p99, p999, p9999, max);
+            break;
+    }
+
+    fflush(cfg_csp->out_fp);
+}
+
+static void bench_report_end(bench_cfg_st const *cfg_csp)
+{
+    if (BENCH_FORMAT_JSON == cfg_csp->format_e)
+    {
+        fprintf(cfg_csp->out_fp, "\n  ]\n}\n");
+    }
+}
+
+static void bench_run(bench_cfg_st const *cfg_csp,
+                      bench_mode_et mode_e,
+                      bench_mix_et mix_e,
+                      unsigned thread_count,
+                      bool *first_p)
+{
+    bench_shared_st shared_s;
+    buffer_st      *desc_as = bench_calloc(cfg_csp->buffer_count, sizeof(buffer_st));
+    uint8_t        *mem_au8 = bench_calloc(cfg_csp->buffer_count, cfg_csp->buffer_size);
+    bench_hist_st  *acquire_hist_sp = bench_calloc(1u, sizeof(bench_hist_st));
+    bench_hist_st  *release_hist_sp = bench_calloc(1u, sizeof(bench_hist_st));
+    uint64_t        failures = 0u;
+    uint64_t        start_ns;
+    unsigned        index;
+    buffer_st      *buf_sp;
+
+    memset(&shared_s, 0, sizeof(shared_s));
+    shared_s.cfg_csp      = cfg_csp;
+    shared_s.mode_e       = mode_e;
+    shared_s.mix_e        = mix_e;
+    shared_s.thread_count = thread_count;
+    shared_s.threads_as   = bench_calloc(thread_count, sizeof(bench_thread_st));
+    (void)pthread_mutex_init(&shared_s.mutex, NULL);
+
+    buffer_array_ctx_init(&shared_s.ctx_s, desc_as, mem_au8, cfg_csp->buffer_count, cfg_csp->buffer_size);
+
+    for (index = 0u; index < thread_count; ++index)
+    {
+        bench_thread_st *thread_sp = &shared_s.threads_as[index];
+
+        thread_sp->shared_sp    = &shared_s;
+        thread_sp->thread_index = index;
+        if (0 != pthread_create(&thread_sp->thread, NULL, bench_worker, thread_sp))
+        {
+            fprintf(stderr, "bench: pthread_create failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    while (__atomic_load_n(&shared_s.ready_count, __ATOMIC_ACQUIRE) < thread_count)
+    {
+    }
+
+    __atomic_store_n(&shared_s.start_flag, 1, __ATOMIC_RELEASE);
+    start_ns = bench_now_ns();
+    while ((bench_now_ns() - start_ns) < cfg_csp->duration_ns)
+    {
+        (void)usleep(1000);
+    }
+    __atomic_store_n(&shared_s.stop_flag, 1, __ATOMIC_RELAXED);
+
+    for (index = 0u; index < thread_count; ++index)
+    {
+        (void)pthread_join(shared_s.threads_as[index].thread, NULL);
+    }
+
+    for (index = 0u; index < thread_count; ++index)
+    {
+        bench_thread_st *thread_sp = &shared_s.threads_as[index];
+
+        /* Buffers still in flight are returned outside of the measurement. */
+        while (NULL != (buf_sp = bench_handoff_pop(&thread_sp->handoff_s)))
+        {
+            (void)buffer_array_release_by_ptr(&shared_s.ctx_s, buf_sp->data_u8p);
+        }
+
+        bench_hist_merge(acquire_hist_sp, &thread_sp->acquire_hist_s);
+        bench_hist_merge(release_hist_sp, &thread_sp->release_hist_s);
+        failures += thread_sp->acquire_failures;
+    }
+
+    bench_report_row(&shared_s, "acquire", acquire_hist_sp, failures, *first_p);
+    bench_report_row(&shared_s, "release", release_hist_sp, 0u, false);
+    *first_p = false;
+
+    (void)pthread_mutex_destroy(&shared_s.mutex);
+    free(shared_s.threads_as);
+    free(acquire_hist_sp);
+    free(release_hist_sp);
+    free(desc_as);
+    free(mem_au8);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Main                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static void bench_usage(char const *prog_cp)
+{
+    fprintf(stderr,
+            "usage: %s [--format=console|csv|json] [--out=FILE] [--threads=N] [--count=N]\n"
+            "          [--buffer-size=N] [--duration-ms=N] [--hold=ITERS] [--burst=N]\n"
+            "          [--mode=mutex|spin] [--mix=same|handoff|bursty]\n",
+            prog_cp);
+}
+
+static int bench_parse_name(char const *value_cp, char const *const *names_acp, int name_count)
+{
+    int index;
+
+    for (index = 0; index < name_count; ++index)
+    {
+        if (0 == strcmp(value_cp, names_acp[index]))
+        {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+static bool bench_parse_args(int argc, char **argv, bench_cfg_st *cfg_sp)
+{
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    int  index;
+
+    cfg_sp->format_e     = BENCH_FORMAT_CONSOLE;
+    cfg_sp->out_fp       = stdout;
+    cfg_sp->max_threads  = (cpu_count > 0) ? (unsigned)cpu_count : 1u;
+    cfg_sp->buffer_count = 1024u;
+    cfg_sp->buffer_size  = 256u;
+    cfg_sp->duration_ns  = UINT64_C(200000000);
+    cfg_sp->hold_iters   = 100u;
+    cfg_sp->burst        = 32u;
+    cfg_sp->mode_filter  = -1;
+    cfg_sp->mix_filter   = -1;
+
+    for (index = 1; index < argc; ++index)
+    {
+        char const *value_cp;
+
+        if (true == bench_match_option(argv[index], "--format", &value_cp))
+        {
+            if (false == bench_parse_format(value_cp, &cfg_sp->format_e))
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--out", &value_cp))
+        {
+            cfg_sp->out_fp = fopen(value_cp, "w");
+            if (NULL == cfg_sp->out_fp)
+            {
+                perror(value_cp);
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--threads", &value_cp))
+        {
+            cfg_sp->max_threads = (unsigned)strtoul(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--count", &value_cp))
+        {
+            cfg_sp->buffer_count = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--buffer-size", &value_cp))
+        {
+            cfg_sp->buffer_size = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--duration-ms", &value_cp))
+        {
+            cfg_sp->duration_ns = strtoull(value_cp, NULL, 10) * UINT64_C(1000000);
+        }
+        else if (true == bench_match_option(argv[index], "--hold", &value_cp))
+        {
+            cfg_sp->hold_iters = (unsigned)strtoul(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--burst", &value_cp))
+        {
+            cfg_sp->burst = (unsigned)strtoul(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--mode", &value_cp))
+        {
+            cfg_sp->mode_filter = bench_parse_name(value_cp, bench_mode_names_acp, (int)BENCH_MODE_COUNT);
+            if (cfg_sp->mode_filter < 0)
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--mix", &value_cp))
+        {
+            cfg_sp->mix_filter = bench_parse_name(value_cp, bench_mix_names_acp, (int)BENCH_MIX_COUNT);
+            if (cfg_sp->mix_filter < 0)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return ((0u < cfg_sp->max_threads)                  &&
+            (BENCH_MAX_THREADS >= cfg_sp->max_threads)  &&
+            (0u < cfg_sp->buffer_count)                 &&
+            (0u < cfg_sp->buffer_size)                  &&
+            (0u < cfg_sp->burst)                        &&
+            (BENCH_MAX_BURST >= cfg_sp->burst));
+}
+
+int main(int argc, char **argv)
+{
+    bench_cfg_st cfg_s;
+    bool         first = true;
+    int          mode;
+    int          mix;
+
+    if (false == bench_parse_args(argc, argv, &cfg_s))
+    {
+        bench_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    (void)bench_ticks_per_ns();
+    bench_report_begin(&cfg_s);
+
+    for (mode = 0; mode < (int)BENCH_MODE_COUNT; ++mode)
+    {
+        if ((cfg_s.mode_filter >= 0) && (cfg_s.mode_filter != mode))
+        {
+            continue;
+        }
+
+        for (mix = 0; mix < (int)BENCH_MIX_COUNT; ++mix)
+        {
+            unsigned threads;
+
+            if ((cfg_s.mix_filter >= 0) && (cfg_s.mix_filter != mix))
+            {
+                continue;
+            }
+
+            /* 1, 2, 4, ... and always the requested maximum. */
+            for (threads = 1u; ; threads *= 2u)
+            {
+                if (threads > cfg_s.max_threads)
+                {
+                    threads = cfg_s.max_threads;
+                }
+
+                bench_run(&cfg_s, (bench_mode_et)mode, (bench_mix_et)mix, threads, &first);
+
+                if (threads == cfg_s.max_threads)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    bench_report_end(&cfg_s);
+
+    if (stdout != cfg_s.out_fp)
+    {
+        fclose(cfg_s.out_fp);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file bench_perf.c
+ * @brief Optional hardware performance counters for the benchmarks.
+ */
+
+#define _GNU_SOURCE
+
+#include "bench_perf.h"
+
+#include <string.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+char const *const bench_perf_names_acp[BENCH_PERF_COUNT] =
+{
+    "instructions",
+    "cache_misses",
+    "dtlb_misses",
+    "branch_misses"
+};
+
+#if defined(__linux__)
+
+static int bench_perf_open_one(uint32_t type_u32, uint64_t config_u64)
+{
+    struct perf_event_attr attr_s;
+
+    memset(&attr_s, 0, sizeof(attr_s));
+    attr_s.size           = sizeof(attr_s);
+    attr_s.type           = type_u32;
+    attr_s.config         = config_u64;
+    attr_s.disabled       = 1;
+    attr_s.exclude_kernel = 1;
+    attr_s.exclude_hv     = 1;
+
+    return (int)syscall(SYS_perf_event_open, &attr_s, 0 /* this thread */, -1 /* any cpu */, -1, 0);
+}
+
+bool bench_perf_open(bench_perf_st *perf_sp)
+{
+    bool any = false;
+    int  event;
+
+    memset(perf_sp, 0, sizeof(*perf_sp));
+
+    perf_sp->fd_ai[BENCH_PERF_INSTRUCTIONS] =
+        bench_perf_open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    perf_sp->fd_ai[BENCH_PERF_CACHE_MISSES] =
+        bench_perf_open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    perf_sp->fd_ai[BENCH_PERF_DTLB_MISSES] =
+        bench_perf_open_one(PERF_TYPE_HW_CACHE,
+                            (uint64_t)PERF_COUNT_HW_CACHE_DTLB                |
+                            ((uint64_t)PERF_COUNT_HW_CACHE_OP_READ      << 8) |
+                            ((uint64_t)PERF_COUNT_HW_CACHE_RESULT_MISS  << 16));
+    perf_sp->fd_ai[BENCH_PERF_BRANCH_MISSES] =
+        bench_perf_open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+
+    for (event = 0; event < (int)BENCH_PERF_COUNT; ++event)
+    {
+        if (perf_sp->fd_ai[event] >= 0)
+        {
+            any = true;
+        }
+    }
+
+    return any;
+}
+
+void bench_perf_close(bench_perf_st *perf_sp)
+{
+    int event;
+
+    for (event = 0; event < (int)BENCH_PERF_COUNT; ++event)
+    {
+        if (perf_sp->fd_ai[event] >= 0)
+        {
+            (void)close(perf_sp->fd_ai[event]);
+            perf_sp->fd_ai[event] = -1;
+        }
+    }
+}
+
+void bench_perf_start(bench_perf_st *perf_sp)
+{
+    int event;
+
+    for (event = 0; event < (int)BENCH_PERF_COUNT; ++event)
+    {
+        if (perf_sp->fd_ai[event] >= 0)
+        {
+            (void)ioctl(perf_sp->fd_ai[event], PERF_EVENT_IOC_RESET, 0);
+            (void)ioctl(perf_sp->fd_ai[event], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void bench_perf_stop(bench_perf_st *perf_sp)
+{
+    int event;
+
+    for (event = 0; event < (int)BENCH_PERF_COUNT; ++event)
+    {
+        if (perf_sp->fd_ai[event] >= 0)
+        {
+            (void)ioctl(perf_sp->fd_ai[event], PERF_EVENT_IOC_DISABLE, 0);
+            if (sizeof(uint64_t) != read(perf_sp->fd_ai[event], &perf_sp->value_au64[event], sizeof(uint64_t)))
+            {
+                perf_sp->value_au64[event] = 0u;
+            }
+        }
+    }
+}
+
+#else /* !__linux__ */
+
+bool bench_perf_open(bench_perf_st *perf_sp)
+{
+    int event;
+
+    memset(perf_sp, 0, sizeof(*perf_sp));
+    for (event = 0; event < (int)BENCH_PERF_COUNT; ++event)
+    {
+        perf_sp->fd_ai[event] = -1;
+    }
+
+    return false;
+}
+
+void bench_perf_close(bench_perf_st *perf_sp)
+{
+    (void)perf_sp;
+}
+
+void bench_perf_start(bench_perf_st *perf_sp)
+{
+    (void)perf_sp;
+}
+
+void bench_perf_stop(bench_perf_st *perf_sp)
+{
+    (void)perf_sp;
+}
+
+#endif /* __linux__ */
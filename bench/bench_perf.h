@@ -0,0 +1,75 @@
+/**
+ * @file bench_perf.h
+ * @brief Optional hardware performance counters for the benchmarks.
+ *
+ * Counters are opened with the raw perf_event_open(2) syscall for the calling
+ * thread, user space only. Each counter is opened on its own so that a PMU
+ * lacking one event (or a container forbidding perf) only loses that column.
+ * On non-Linux hosts every counter reports as unavailable.
+ */
+
+#ifndef BENCH_PERF_H_
+#define BENCH_PERF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Counted hardware event.
+ */
+typedef enum
+{
+    BENCH_PERF_INSTRUCTIONS = 0,
+    BENCH_PERF_CACHE_MISSES,
+    BENCH_PERF_DTLB_MISSES,
+    BENCH_PERF_BRANCH_MISSES,
+    BENCH_PERF_COUNT
+} bench_perf_event_et;
+
+/**
+ * @brief Set of per-thread counters.
+ */
+typedef struct
+{
+    int      fd_ai[BENCH_PERF_COUNT];         /**< Counter fd, or -1 when unavailable. */
+    uint64_t value_au64[BENCH_PERF_COUNT];    /**< Values from the last start/stop pair. */
+} bench_perf_st;
+
+/**
+ * @brief Short column names, indexed by @ref bench_perf_event_et.
+ */
+extern char const *const bench_perf_names_acp[BENCH_PERF_COUNT];
+
+/**
+ * @brief Open all counters for the calling thread.
+ *
+ * @param[out] perf_sp  Counter set.
+ *
+ * @return true if at least one counter could be opened.
+ */
+bool bench_perf_open(bench_perf_st *perf_sp);
+
+/**
+ * @brief Close all counters.
+ */
+void bench_perf_close(bench_perf_st *perf_sp);
+
+/**
+ * @brief Reset and enable all open counters.
+ */
+void bench_perf_start(bench_perf_st *perf_sp);
+
+/**
+ * @brief Disable all open counters and read them into @ref bench_perf_st::value_au64.
+ */
+void bench_perf_stop(bench_perf_st *perf_sp);
+
+/**
+ * @brief Check whether a counter is available.
+ */
+static inline bool bench_perf_has(bench_perf_st const *perf_csp, bench_perf_event_et event_e)
+{
+    return (perf_csp->fd_ai[event_e] >= 0);
+}
+
+#endif /* BENCH_PERF_H_ */
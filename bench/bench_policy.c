@@ -0,0 +1,456 @@
+/**
+ * @file bench_policy.c
+ * @brief Produce-then-consume workload under each reuse policy.
+ *
+ * Each round a producer acquires --batch buffers and writes them whole,
+ * then a consumer reads them back in the same order and releases them by
+ * pointer. The pool holds between 64 and --max-count buffers, of which a
+ * random fraction (hold%) stays acquired for the whole run to fragment the
+ * free set. Reports ns and, with --perf, cache and dTLB misses per buffer
+ * for each policy (see BUFFER_CFG_POLICY in buffer.h):
+ *  - scan:   first free by index, linear search (the default)
+ *  - lifo:   most recently released first; the batch stays cache-hot
+ *  - fifo:   least recently released first; cycles through the whole pool
+ *  - lowest: lowest free index via a bitmap; like scan without the search
+ *
+ * Build:
+ *   cc -O2 -I. -DBUFFER_CFG_POLICY=1 bench/bench_policy.c bench/bench_util.c bench/bench_perf.c buffer.c -o bench_policy
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "bench_util.h"
+#include "bench_perf.h"
+
+#if (0 == BUFFER_CFG_POLICY)
+#error "bench_policy needs the library built with -DBUFFER_CFG_POLICY=1"
+#endif
+
+#define BENCH_POLICY_MIN_COUNT   (64u)
+#define BENCH_POLICY_MAX_COUNT   (65536u)
+#define BENCH_POLICY_MAX_BATCH   (1024u)
+#define BENCH_POLICY_MAX_ROUNDS  (UINT64_C(1) << 26)
+
+/**
+ * @brief Benchmark run configuration (from the command line).
+ */
+typedef struct
+{
+    bench_format_et format_e;
+    FILE           *out_fp;
+    uint64_t        min_time_ns;
+    size_t          max_count;
+    size_t          buffer_size;
+    size_t          batch;           /**< Buffers produced per round. */
+    bool            use_perf;
+    bench_perf_st   perf_s;
+} bench_cfg_st;
+
+/**
+ * @brief Pool under test.
+ */
+typedef struct
+{
+    buffer_array_ctx_st   ctx_s;
+    buffer_pool_policy_st policy_s;
+    buffer_st            *desc_as;
+    uint8_t              *mem_au8;
+    uint64_t             *work_au64;
+    size_t                count;
+    size_t                buffer_size;
+} bench_pool_st;
+
+/**
+ * @brief Result of one measurement.
+ */
+typedef struct
+{
+    buffer_policy_et policy_e;
+    size_t           count;
+    unsigned         hold_pct;
+    uint64_t         buffers;        /**< Buffers produced and consumed. */
+    double           ns_per_buffer;
+    double           perf_per_buffer_ad[BENCH_PERF_COUNT];
+} bench_result_st;
+
+static char const *const bench_policy_names_acp[] = { "scan", "lifo", "fifo", "lowest" };
+
+static unsigned const bench_hold_pcts_au[] = { 0u, 50u };
+
+/* Sink to keep the compiler from discarding the consumer's reads. */
+static volatile uint64_t bench_sink_u64;
+
+/* -------------------------------------------------------------------------- */
+/* Workload                                                                   */
+/* -------------------------------------------------------------------------- */
+
+static bool bench_pool_setup(bench_pool_st *bp_sp, buffer_policy_et policy_e, unsigned hold_pct)
+{
+    uint64_t seed_u64 = UINT64_C(0x9E3779B97F4A7C15) + bp_sp->count;
+    size_t   index;
+
+    buffer_array_ctx_init(&bp_sp->ctx_s, bp_sp->desc_as, bp_sp->mem_au8, bp_sp->count, bp_sp->buffer_size);
+
+    /* Held buffers are chosen at random so that the free set has holes. */
+    for (index = 0u; index < bp_sp->count; ++index)
+    {
+        if ((bench_rng_next(&seed_u64) % 100u) < hold_pct)
+        {
+            buffer_mark_in_use(&bp_sp->desc_as[index]);
+        }
+    }
+
+    return buffer_pool_policy_attach(&bp_sp->ctx_s.pool_s, &bp_sp->policy_s, policy_e, bp_sp->work_au64);
+}
+
+/* Returns the buffers actually produced; a round stops early when the pool runs dry. */
+static uint64_t bench_run(bench_pool_st *bp_sp, size_t batch, uint64_t rounds)
+{
+    buffer_st *batch_asp[BENCH_POLICY_MAX_BATCH];
+    uint64_t   round;
+    uint64_t   sum_u64 = 0u;
+    uint64_t   total_u64 = 0u;
+    size_t     taken;
+    size_t     index;
+    size_t     offset;
+
+    for (round = 0u; round < rounds; ++round)
+    {
+        /* Produce. */
+        for (taken = 0u; taken < batch; ++taken)
+        {
+            batch_asp[taken] = buffer_array_acquire(&bp_sp->ctx_s);
+            if (NULL == batch_asp[taken])
+            {
+                break;
+            }
+            memset(batch_asp[taken]->data_u8p, (int)(round & 0xFFu), bp_sp->buffer_size);
+        }
+        total_u64 += taken;
+
+        /* Consume, in production order. */
+        for (index = 0u; index < taken; ++index)
+        {
+            for (offset = 0u; offset < bp_sp->buffer_size; offset += 64u)
+            {
+                sum_u64 += batch_asp[index]->data_u8p[offset];
+            }
+            (void)buffer_array_release_by_ptr(&bp_sp->ctx_s, batch_asp[index]->data_u8p);
+        }
+    }
+
+    bench_sink_u64 = sum_u64;
+    return total_u64;
+}
+
+static bool bench_measure(bench_cfg_st *cfg_sp,
+                          bench_pool_st *bp_sp,
+                          buffer_policy_et policy_e,
+                          unsigned hold_pct,
+                          bench_result_st *result_sp)
+{
+    uint64_t rounds = 1u;
+    uint64_t buffers = 0u;
+    uint64_t elapsed_ns;
+    int      event;
+
+    for (;;)
+    {
+        uint64_t start_ns;
+
+        if (false == bench_pool_setup(bp_sp, policy_e, hold_pct))
+        {
+            return false;
+        }
+
+        /* One untimed round so every policy starts from its steady state. */
+        (void)bench_run(bp_sp, cfg_sp->batch, 1u);
+
+        if (true == cfg_sp->use_perf)
+        {
+            bench_perf_start(&cfg_sp->perf_s);
+        }
+
+        start_ns = bench_now_ns();
+        buffers = bench_run(bp_sp, cfg_sp->batch, rounds);
+        elapsed_ns = bench_now_ns() - start_ns;
+
+        if (true == cfg_sp->use_perf)
+        {
+            bench_perf_stop(&cfg_sp->perf_s);
+        }
+
+        if ((elapsed_ns >= cfg_sp->min_time_ns) || (rounds >= BENCH_POLICY_MAX_ROUNDS))
+        {
+            break;
+        }
+
+        rounds = (0u == elapsed_ns) ? (rounds * 10u) : (rounds * 2u);
+    }
+
+    if (0u == buffers)
+    {
+        return false;   /* Every buffer held: nothing to report. */
+    }
+
+    result_sp->policy_e      = policy_e;
+    result_sp->count         = bp_sp->count;
+    result_sp->hold_pct      = hold_pct;
+    result_sp->buffers       = buffers;
+    result_sp->ns_per_buffer = (double)elapsed_ns / (double)result_sp->buffers;
+
+    for (event = 0; event < (int)BENCH_PERF_COUNT; ++event)
+    {
+        result_sp->perf_per_buffer_ad[event] =
+            (double)cfg_sp->perf_s.value_au64[event] / (double)result_sp->buffers;
+    }
+
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Reporting                                                                  */
+/* -------------------------------------------------------------------------- */
+
+static void bench_report_begin(bench_cfg_st const *cfg_csp)
+{
+    int event;
+
+    if (BENCH_FORMAT_CSV == cfg_csp->format_e)
+    {
+        fprintf(cfg_csp->out_fp, "policy,buffer_count,hold_pct,buffers,ns_per_buffer");
+        for (event = 0; (true == cfg_csp->use_perf) && (event < (int)BENCH_PERF_COUNT); ++event)
+        {
+            fprintf(cfg_csp->out_fp, ",%s_per_buffer", bench_perf_names_acp[event]);
+        }
+    }
+    else if (BENCH_FORMAT_JSON == cfg_csp->format_e)
+    {
+        fprintf(cfg_csp->out_fp,
+                "{\n  \"context\": {\"buffer_size\": %zu, \"batch\": %zu, \"perf\": %s},\n  \"benchmarks\": [",
+                cfg_csp->buffer_size, cfg_csp->batch, (true == cfg_csp->use_perf) ? "true" : "false");
+        return;
+    }
+    else
+    {
+        fprintf(cfg_csp->out_fp, "%-8s %10s %6s %12s %14s", "policy", "count", "hold%", "buffers", "ns/buffer");
+        for (event = 0; (true == cfg_csp->use_perf) && (event < (int)BENCH_PERF_COUNT); ++event)
+        {
+            fprintf(cfg_csp->out_fp, " %14s", bench_perf_names_acp[event]);
+        }
+    }
+
+    fprintf(cfg_csp->out_fp, "\n");
+}
+
+static void bench_report_row(bench_cfg_st const *cfg_csp, bench_result_st const *result_csp, bool first)
+{
+    char const *name_cp = bench_policy_names_acp[result_csp->policy_e];
+    int         event;
+
+    switch (cfg_csp->format_e)
+    {
+        case BENCH_FORMAT_CSV:
+            fprintf(cfg_csp->out_fp, "%s,%zu,%u,%llu,%.3f", name_cp, result_csp->count, result_csp->hold_pct,
+                    (unsigned long long)result_csp->buffers, result_csp->ns_per_buffer);
+            break;
+
+        case BENCH_FORMAT_JSON:
+            fprintf(cfg_csp->out_fp,
+                    "%s\n    {\"policy\": \"%s\", \"buffer_count\": %zu, \"hold_pct\": %u, "
+                    "\"buffers\": %llu, \"ns_per_buffer\": %.3f",
+                    (true == first) ? "" : ",", name_cp, result_csp->count, result_csp->hold_pct,
+                    (unsigned long long)result_csp->buffers, result_csp->ns_per_buffer);
+            break;
+
+        default:
+            fprintf(cfg_csp->out_fp, "%-8s %10zu %6u %12llu %14.2f", name_cp, result_csp->count,
+                    result_csp->hold_pct, (unsigned long long)result_csp->buffers, result_csp->ns_per_buffer);
+            break;
+    }
+
+    for (event = 0; (true == cfg_csp->use_perf) && (event < (int)BENCH_PERF_COUNT); ++event)
+    {
+        bool   has   = bench_perf_has(&cfg_csp->perf_s, (bench_perf_event_et)event);
+        double value = result_csp->perf_per_buffer_ad[event];
+
+        switch (cfg_csp->format_e)
+        {
+            case BENCH_FORMAT_CSV:
+                (true == has) ? fprintf(cfg_csp->out_fp, ",%.4f", value) : fprintf(cfg_csp->out_fp, ",");
+                break;
+
+            case BENCH_FORMAT_JSON:
+                if (true == has)
+                {
+                    fprintf(cfg_csp->out_fp, ", \"%s_per_buffer\": %.4f", bench_perf_names_acp[event], value);
+                }
+                break;
+
+            default:
+                (true == has) ? fprintf(cfg_csp->out_fp, " %14.3f", value) : fprintf(cfg_csp->out_fp, " %14s", "n/a");
+                break;
+        }
+    }
+
+    fprintf(cfg_csp->out_fp, (BENCH_FORMAT_JSON == cfg_csp->format_e) ? "}" : "\n");
+}
+
+static void bench_report_end(bench_cfg_st const *cfg_csp)
+{
+    if (BENCH_FORMAT_JSON == cfg_csp->format_e)
+    {
+        fprintf(cfg_csp->out_fp, "\n  ]\n}\n");
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Command line                                                               */
+/* -------------------------------------------------------------------------- */
+
+static void bench_usage(char const *prog_cp)
+{
+    fprintf(stderr,
+            "usage: %s [--format=console|csv|json] [--out=FILE] [--min-time-ms=N]\n"
+            "          [--max-count=N] [--buffer-size=N] [--batch=N] [--perf]\n",
+            prog_cp);
+}
+
+static bool bench_parse_args(int argc, char **argv, bench_cfg_st *cfg_sp)
+{
+    int index;
+
+    cfg_sp->format_e    = BENCH_FORMAT_CONSOLE;
+    cfg_sp->out_fp      = stdout;
+    cfg_sp->min_time_ns = UINT64_C(50000000);
+    cfg_sp->max_count   = BENCH_POLICY_MAX_COUNT;
+    cfg_sp->buffer_size = 2048u;
+    cfg_sp->batch       = 32u;
+    cfg_sp->use_perf    = false;
+
+    for (index = 1; index < argc; ++index)
+    {
+        char const *value_cp;
+
+        if (true == bench_match_option(argv[index], "--format", &value_cp))
+        {
+            if (false == bench_parse_format(value_cp, &cfg_sp->format_e))
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--out", &value_cp))
+        {
+            cfg_sp->out_fp = fopen(value_cp, "w");
+            if (NULL == cfg_sp->out_fp)
+            {
+                perror(value_cp);
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--min-time-ms", &value_cp))
+        {
+            cfg_sp->min_time_ns = strtoull(value_cp, NULL, 10) * UINT64_C(1000000);
+        }
+        else if (true == bench_match_option(argv[index], "--max-count", &value_cp))
+        {
+            cfg_sp->max_count = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--buffer-size", &value_cp))
+        {
+            cfg_sp->buffer_size = (size_t)strtoull(value_cp, NULL, 10);
+            if (0u == cfg_sp->buffer_size)
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--batch", &value_cp))
+        {
+            cfg_sp->batch = (size_t)strtoull(value_cp, NULL, 10);
+            if ((0u == cfg_sp->batch) || (BENCH_POLICY_MAX_BATCH < cfg_sp->batch))
+            {
+                return false;
+            }
+        }
+        else if (0 == strcmp(argv[index], "--perf"))
+        {
+            cfg_sp->use_perf = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bench_cfg_st  cfg_s;
+    bench_pool_st bp_s;
+    size_t        count;
+    bool          first = true;
+
+    if (false == bench_parse_args(argc, argv, &cfg_s))
+    {
+        bench_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(&bp_s, 0, sizeof(bp_s));
+    memset(&cfg_s.perf_s, 0, sizeof(cfg_s.perf_s));
+
+    if ((true == cfg_s.use_perf) && (false == bench_perf_open(&cfg_s.perf_s)))
+    {
+        fprintf(stderr, "bench: perf_event_open unavailable, counters will read n/a\n");
+    }
+
+    bench_report_begin(&cfg_s);
+
+    for (count = BENCH_POLICY_MIN_COUNT; count <= cfg_s.max_count; count *= 8u)
+    {
+        size_t hold;
+        int    policy;
+
+        bp_s.count       = count;
+        bp_s.buffer_size = cfg_s.buffer_size;
+        bp_s.desc_as     = bench_calloc(count, sizeof(buffer_st));
+        bp_s.mem_au8     = bench_calloc(count, cfg_s.buffer_size);
+        bp_s.work_au64   = bench_calloc(count, sizeof(uint64_t));
+
+        for (hold = 0u; hold < (sizeof(bench_hold_pcts_au) / sizeof(bench_hold_pcts_au[0])); ++hold)
+        {
+            for (policy = (int)BUFFER_POLICY_SCAN; policy <= (int)BUFFER_POLICY_LOWEST; ++policy)
+            {
+                bench_result_st result_s;
+
+                if (true == bench_measure(&cfg_s, &bp_s, (buffer_policy_et)policy, bench_hold_pcts_au[hold], &result_s))
+                {
+                    bench_report_row(&cfg_s, &result_s, first);
+                    first = false;
+                }
+            }
+        }
+
+        free(bp_s.desc_as);
+        free(bp_s.mem_au8);
+        free(bp_s.work_au64);
+    }
+
+    bench_report_end(&cfg_s);
+
+    if (true == cfg_s.use_perf)
+    {
+        bench_perf_close(&cfg_s.perf_s);
+    }
+
+    if (stdout != cfg_s.out_fp)
+    {
+        fclose(cfg_s.out_fp);
+    }
+
+    return EXIT_SUCCESS;
+}
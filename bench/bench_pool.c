@@ -0,0 +1,700 @@
+/**
+ * @file bench_pool.c
+ * @brief Single-threaded microbenchmarks for the pool operations.
+ *
+ * Measures ns/op of buffer_array_acquire(), buffer_array_release_by_ptr(),
+ * buffer_array_find_by_ptr(), buffer_pool_find() and buffer_pool_mark_all_free() for pool sizes
+ * from 8 to 1M buffers (x8 steps, always ending at --max-count) and fill
+ * levels from 0% to 99%.
+ *
+ * Each measurement repeats the operation in batches whose iteration count
+ * grows until the batch runs for at least --min-time-ms, in the spirit of
+ * Google Benchmark. Pool state is kept constant across iterations:
+ *  - acquire:        acquire + buffer_pool_mark_free() of the returned buffer
+ *  - release_by_ptr: release a random buffer + buffer_pool_mark_in_use() if it was in use
+ *  - find:           find a random buffer by its data pointer
+ *  - pool_find:      same through buffer_pool_find(), which searches the
+ *                    descriptors instead of using the block offset; shows
+ *                    the effect of BUFFER_CFG_FIND_SIMD (and --find-index)
+ *  - mark_all_free:  mark all free (fill level is only meaningful for the first call)
+ *  - acquire_write:  acquire bursts of up to 32 buffers and write the first
+ *                    BENCH_POOL_WRITE_LINES cache lines of each, then free
+ *                    the burst and flush those lines from the caches (x86),
+ *                    as if the buffers had been consumed elsewhere; shows
+ *                    the effect of BUFFER_CFG_PREFETCH_LINES
+ *
+ * With --perf, hardware counters (instructions, cache misses, dTLB misses,
+ * branch misses) are collected around each measured batch and reported per
+ * operation next to ns/op. Counters the host does not provide print as n/a.
+ *
+ * Build:
+ *   cc -O2 -I. bench/bench_pool.c bench/bench_util.c bench/bench_perf.c buffer.c -o bench_pool
+ *
+ * Compare acquire_write with and without -DBUFFER_CFG_PREFETCH_LINES=2, e.g.
+ *   ./bench_pool --op=acquire_write --buffer-size=2048
+ *
+ * and pool_find with -DBUFFER_CFG_FIND_SIMD=1, with and without --find-index.
+ * With -DBUFFER_CFG_EPOCH_RESET=1 the pool gets epoch stamps, so
+ * mark_all_free measures the O(1) reset.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "bench_util.h"
+#include "bench_perf.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define BENCH_POOL_FLUSH(p)      _mm_clflush(p)
+#else
+#define BENCH_POOL_FLUSH(p)      ((void)(p))
+#endif
+
+#define BENCH_POOL_TARGETS       (1024u)     /**< Random targets per configuration (power of two). */
+#define BENCH_POOL_MIN_COUNT     (8u)
+#define BENCH_POOL_MAX_COUNT     (1048576u)
+#define BENCH_POOL_MAX_ITERS     (UINT64_C(1) << 30)
+#define BENCH_POOL_BURST         (32u)       /**< Buffers per acquire_write burst. */
+#define BENCH_POOL_WRITE_LINES   (2u)        /**< Cache lines written per acquired buffer. */
+
+/**
+ * @brief Benchmarked operation.
+ */
+typedef enum
+{
+    BENCH_OP_ACQUIRE = 0,
+    BENCH_OP_RELEASE_BY_PTR,
+    BENCH_OP_FIND,
+    BENCH_OP_MARK_ALL_FREE,
+    BENCH_OP_ACQUIRE_WRITE,
+    BENCH_OP_POOL_FIND,
+    BENCH_OP_COUNT
+} bench_op_et;
+
+/**
+ * @brief Benchmark run configuration (from the command line).
+ */
+typedef struct
+{
+    bench_format_et format_e;
+    FILE           *out_fp;
+    uint64_t        min_time_ns;
+    size_t          max_count;
+    size_t          buffer_size;
+    int             op_filter;       /**< Operation to run, or -1 for all. */
+    bool            use_perf;        /**< Collect hardware counters. */
+    bool            use_find_index;  /**< Attach a pointer array for buffer_pool_find(). */
+    bench_perf_st   perf_s;          /**< Counters, valid when @ref use_perf is set. */
+} bench_cfg_st;
+
+/**
+ * @brief Pool under test and its precomputed random targets.
+ */
+typedef struct
+{
+    buffer_array_ctx_st ctx_s;
+    buffer_st          *desc_as;
+    uint8_t            *mem_au8;
+    size_t              count;
+    size_t              buffer_size;
+    size_t              fill_count;
+    uintptr_t          *find_addr_au;    /**< Pointer array for find, or NULL. */
+    uint32_t           *epoch_au32;      /**< Epoch stamps (BUFFER_CFG_EPOCH_RESET). */
+    uint8_t            *target_au8p[BENCH_POOL_TARGETS];
+} bench_pool_st;
+
+/**
+ * @brief Result of one measurement.
+ */
+typedef struct
+{
+    bench_op_et op_e;
+    size_t      count;
+    unsigned    fill_pct;
+    uint64_t    iterations;
+    double      ns_per_op;
+    double      perf_per_op_ad[BENCH_PERF_COUNT];
+} bench_result_st;
+
+static char const *const bench_op_names_acp[BENCH_OP_COUNT] =
+{
+    "acquire",
+    "release_by_ptr",
+    "find",
+    "mark_all_free",
+    "acquire_write",
+    "pool_find"
+};
+
+static unsigned const bench_fill_pcts_au[] = { 0u, 25u, 50u, 75u, 90u, 99u };
+
+/* Sink to keep the compiler from discarding benchmarked calls. */
+static volatile uintptr_t bench_sink_u;
+
+/* -------------------------------------------------------------------------- */
+/* Pool setup                                                                 */
+/* -------------------------------------------------------------------------- */
+
+static void bench_pool_setup(bench_pool_st *bp_sp, unsigned fill_pct, uint64_t seed_u64)
+{
+    size_t index;
+
+    buffer_array_ctx_init(&bp_sp->ctx_s, bp_sp->desc_as, bp_sp->mem_au8,
+                          bp_sp->count, bp_sp->buffer_size);
+
+    /* Keep at least one free buffer so acquire always succeeds. */
+    bp_sp->fill_count = (bp_sp->count * fill_pct) / 100u;
+    if (bp_sp->fill_count >= bp_sp->count)
+    {
+        bp_sp->fill_count = bp_sp->count - 1u;
+    }
+
+    /* Same state as fill_count acquires (lowest indices first), in O(n)
+     * rather than O(n^2); done before attaching anything that tracks it. */
+    for (index = 0u; index < bp_sp->fill_count; ++index)
+    {
+        buffer_mark_in_use(&bp_sp->desc_as[index]);
+    }
+
+#if (0 != BUFFER_CFG_FIND_SIMD)
+    (void)buffer_pool_find_index_attach(&bp_sp->ctx_s.pool_s, bp_sp->find_addr_au);
+#endif
+#if (0 != BUFFER_CFG_EPOCH_RESET)
+    (void)buffer_pool_epoch_attach(&bp_sp->ctx_s.pool_s, bp_sp->epoch_au32);
+#endif
+
+    for (index = 0u; index < BENCH_POOL_TARGETS; ++index)
+    {
+        size_t target = (size_t)(bench_rng_next(&seed_u64) % bp_sp->count);
+        bp_sp->target_au8p[index] = bp_sp->desc_as[target].data_u8p;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Operations                                                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Acquire bursts of buffers and write their first lines.
+ */
+static uintptr_t bench_acquire_write(bench_pool_st *bp_sp, uint64_t iterations)
+{
+    buffer_st *burst_asp[BENCH_POOL_BURST];
+    size_t     burst = bp_sp->count - bp_sp->fill_count;
+    size_t     line_count;
+    size_t     index;
+    size_t     line;
+    uint64_t   iter = 0u;
+    uintptr_t  sink_u = 0u;
+
+    if (burst > BENCH_POOL_BURST)
+    {
+        burst = BENCH_POOL_BURST;
+    }
+
+    line_count = (bp_sp->buffer_size + 63u) / 64u;
+    if (line_count > BENCH_POOL_WRITE_LINES)
+    {
+        line_count = BENCH_POOL_WRITE_LINES;
+    }
+
+    while (iter < iterations)
+    {
+        size_t taken = 0u;
+
+        for (index = 0u; (index < burst) && (iter < iterations); ++index, ++iter)
+        {
+            buffer_st *buf_sp = buffer_array_acquire(&bp_sp->ctx_s);
+
+            for (line = 0u; line < line_count; ++line)
+            {
+                buf_sp->data_u8p[line * 64u] = (uint8_t)iter;
+            }
+            burst_asp[taken] = buf_sp;
+            taken++;
+        }
+
+        for (index = 0u; index < taken; ++index)
+        {
+            buffer_pool_mark_free(&bp_sp->ctx_s.pool_s, burst_asp[index]);
+            for (line = 0u; line < line_count; ++line)
+            {
+                BENCH_POOL_FLUSH(&burst_asp[index]->data_u8p[line * 64u]);
+            }
+            sink_u += (uintptr_t)burst_asp[index];
+        }
+    }
+
+    return sink_u;
+}
+
+static void bench_run_op(bench_pool_st *bp_sp, bench_op_et op_e, uint64_t iterations)
+{
+    uint64_t  iter;
+    uintptr_t sink_u = 0u;
+
+    switch (op_e)
+    {
+        case BENCH_OP_ACQUIRE:
+            for (iter = 0u; iter < iterations; ++iter)
+            {
+                buffer_st *buf_sp = buffer_array_acquire(&bp_sp->ctx_s);
+                buffer_pool_mark_free(&bp_sp->ctx_s.pool_s, buf_sp);
+                sink_u += (uintptr_t)buf_sp;
+            }
+            break;
+
+        case BENCH_OP_RELEASE_BY_PTR:
+            for (iter = 0u; iter < iterations; ++iter)
+            {
+                uint8_t   *data_u8p = bp_sp->target_au8p[iter & (BENCH_POOL_TARGETS - 1u)];
+                size_t     index    = (size_t)(data_u8p - bp_sp->mem_au8) / bp_sp->buffer_size;
+                buffer_st *buf_sp   = &bp_sp->desc_as[index];
+                bool       was_free = buf_sp->is_available;
+
+                sink_u += (uintptr_t)buffer_array_release_by_ptr(&bp_sp->ctx_s, data_u8p);
+                if (false == was_free)
+                {
+                    buffer_pool_mark_in_use(&bp_sp->ctx_s.pool_s, buf_sp);
+                }
+            }
+            break;
+
+        case BENCH_OP_FIND:
+            for (iter = 0u; iter < iterations; ++iter)
+            {
+                uint8_t *data_u8p = bp_sp->target_au8p[iter & (BENCH_POOL_TARGETS - 1u)];
+                sink_u += (uintptr_t)buffer_array_find_by_ptr(&bp_sp->ctx_s, data_u8p);
+            }
+            break;
+
+        case BENCH_OP_POOL_FIND:
+            for (iter = 0u; iter < iterations; ++iter)
+            {
+                uint8_t *data_u8p = bp_sp->target_au8p[iter & (BENCH_POOL_TARGETS - 1u)];
+                sink_u += (uintptr_t)buffer_pool_find(&bp_sp->ctx_s.pool_s, data_u8p);
+            }
+            break;
+
+        case BENCH_OP_MARK_ALL_FREE:
+            for (iter = 0u; iter < iterations; ++iter)
+            {
+                buffer_pool_mark_all_free(&bp_sp->ctx_s.pool_s);
+            }
+            sink_u += bp_sp->desc_as[0].is_available;
+            break;
+
+        case BENCH_OP_ACQUIRE_WRITE:
+            sink_u += bench_acquire_write(bp_sp, iterations);
+            break;
+
+        default:
+            break;
+    }
+
+    bench_sink_u = sink_u;
+}
+
+/**
+ * @brief Measure one operation, growing the batch until it runs long enough.
+ */
+static void bench_measure(bench_cfg_st *cfg_sp,
+                          bench_pool_st *bp_sp,
+                          bench_op_et op_e,
+                          unsigned fill_pct,
+                          bench_result_st *result_sp)
+{
+    uint64_t iterations = 1u;
+    uint64_t elapsed_ns;
+    int      event;
+
+    for (;;)
+    {
+        uint64_t start_ns;
+
+        bench_pool_setup(bp_sp, fill_pct, UINT64_C(0x9E3779B97F4A7C15) + bp_sp->count);
+
+        if (true == cfg_sp->use_perf)
+        {
+            bench_perf_start(&cfg_sp->perf_s);
+        }
+
+        start_ns = bench_now_ns();
+        bench_run_op(bp_sp, op_e, iterations);
+        elapsed_ns = bench_now_ns() - start_ns;
+
+        if (true == cfg_sp->use_perf)
+        {
+            bench_perf_stop(&cfg_sp->perf_s);
+        }
+
+        if ((elapsed_ns >= cfg_sp->min_time_ns) || (iterations >= BENCH_POOL_MAX_ITERS))
+        {
+            break;
+        }
+
+        /* Predict the count needed to reach min_time, with 40% headroom. */
+        if (0u == elapsed_ns)
+        {
+            iterations *= 10u;
+        }
+        else
+        {
+            double   scale = ((double)cfg_sp->min_time_ns * 1.4) / (double)elapsed_ns;
+            uint64_t next  = (uint64_t)((double)iterations * scale);
+
+            if (next > (iterations * 10u))
+            {
+                next = iterations * 10u;
+            }
+            iterations = (next > iterations) ? next : (iterations + 1u);
+        }
+    }
+
+    result_sp->op_e       = op_e;
+    result_sp->count      = bp_sp->count;
+    result_sp->fill_pct   = fill_pct;
+    result_sp->iterations = iterations;
+    result_sp->ns_per_op  = (double)elapsed_ns / (double)iterations;
+
+    for (event = 0; event < (int)BENCH_PERF_COUNT; ++event)
+    {
+        result_sp->perf_per_op_ad[event] =
+            (double)cfg_sp->perf_s.value_au64[event] / (double)iterations;
+    }
+}
+
+/**
+ * @brief Next pool size of the sweep: x8, ending exactly at @p max_count.
+ *
+ * @return 0 once @p max_count has been measured.
+ */
+static size_t bench_next_count(size_t count, size_t max_count)
+{
+    if (count >= max_count)
+    {
+        return 0u;
+    }
+
+    return ((count * 8u) < max_count) ? (count * 8u) : max_count;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Reporting                                                                  */
+/* -------------------------------------------------------------------------- */
+
+static void bench_report_begin(bench_cfg_st const *cfg_csp)
+{
+    int event;
+
+    switch (cfg_csp->format_e)
+    {
+        case BENCH_FORMAT_CSV:
+            fprintf(cfg_csp->out_fp, "op,buffer_count,fill_pct,iterations,ns_per_op");
+            for (event = 0; (true == cfg_csp->use_perf) && (event < (int)BENCH_PERF_COUNT); ++event)
+            {
+                fprintf(cfg_csp->out_fp, ",%s_per_op", bench_perf_names_acp[event]);
+            }
+            fprintf(cfg_csp->out_fp, "\n");
+            break;
+
+        case BENCH_FORMAT_JSON:
+            fprintf(cfg_csp->out_fp,
+                    "{\n  \"context\": {\"buffer_size\": %zu, \"min_time_ns\": %llu, \"perf\": %s},\n"
+                    "  \"benchmarks\": [",
+                    cfg_csp->buffer_size,
+                    (unsigned long long)cfg_csp->min_time_ns,
+                    (true == cfg_csp->use_perf) ? "true" : "false");
+            break;
+
+        default:
+            fprintf(cfg_csp->out_fp, "%-16s %10s %6s %12s %14s",
+                    "op", "count", "fill%", "iterations", "ns/op");
+            for (event = 0; (true == cfg_csp->use_perf) && (event < (int)BENCH_PERF_COUNT); ++event)
+            {
+                fprintf(cfg_csp->out_fp, " %14s", bench_perf_names_acp[event]);
+            }
+            fprintf(cfg_csp->out_fp, "\n");
+            break;
+    }
+}
+
+/**
+ * @brief Append the per-operation counter columns of one row.
+ */
+static void bench_report_perf(bench_cfg_st const *cfg_csp, bench_result_st const *result_csp)
+{
+    int event;
+
+    for (event = 0; (true == cfg_csp->use_perf) && (event < (int)BENCH_PERF_COUNT); ++event)
+    {
+        bool   has   = bench_perf_has(&cfg_csp->perf_s, (bench_perf_event_et)event);
+        double value = result_csp->perf_per_op_ad[event];
+
+        switch (cfg_csp->format_e)
+        {
+            case BENCH_FORMAT_CSV:
+                if (true == has)
+                {
+                    fprintf(cfg_csp->out_fp, ",%.4f", value);
+                }
+                else
+                {
+                    fprintf(cfg_csp->out_fp, ",");
+                }
+                break;
+
+            case BENCH_FORMAT_JSON:
+                if (true == has)
+                {
+                    fprintf(cfg_csp->out_fp, ", \"%s_per_op\": %.4f", bench_perf_names_acp[event], value);
+                }
+                else
+                {
+                    fprintf(cfg_csp->out_fp, ", \"%s_per_op\": null", bench_perf_names_acp[event]);
+                }
+                break;
+
+            default:
+                if (true == has)
+                {
+                    fprintf(cfg_csp->out_fp, " %14.3f", value);
+                }
+                else
+                {
+                    fprintf(cfg_csp->out_fp, " %14s", "n/a");
+                }
+                break;
+        }
+    }
+}
+
+static void bench_report_row(bench_cfg_st const *cfg_csp, bench_result_st const *result_csp, bool first)
+{
+    char const *name_cp = bench_op_names_acp[result_csp->op_e];
+
+    switch (cfg_csp->format_e)
+    {
+        case BENCH_FORMAT_CSV:
+            fprintf(cfg_csp->out_fp, "%s,%zu,%u,%llu,%.3f",
+                    name_cp, result_csp->count, result_csp->fill_pct,
+                    (unsigned long long)result_csp->iterations, result_csp->ns_per_op);
+            bench_report_perf(cfg_csp, result_csp);
+            fprintf(cfg_csp->out_fp, "\n");
+            break;
+
+        case BENCH_FORMAT_JSON:
+            fprintf(cfg_csp->out_fp,
+                    "%s\n    {\"name\": \"%s/%zu/%u\", \"op\": \"%s\", \"buffer_count\": %zu, "
+                    "\"fill_pct\": %u, \"iterations\": %llu, \"ns_per_op\": %.3f",
+                    first ? "" : ",",
+                    name_cp, result_csp->count, result_csp->fill_pct,
+                    name_cp, result_csp->count, result_csp->fill_pct,
+                    (unsigned long long)result_csp->iterations, result_csp->ns_per_op);
+            bench_report_perf(cfg_csp, result_csp);
+            fprintf(cfg_csp->out_fp, "}");
+            break;
+
+        default:
+            fprintf(cfg_csp->out_fp, "%-16s %10zu %6u %12llu %14.2f",
+                    name_cp, result_csp->count, result_csp->fill_pct,
+                    (unsigned long long)result_csp->iterations, result_csp->ns_per_op);
+            bench_report_perf(cfg_csp, result_csp);
+            fprintf(cfg_csp->out_fp, "\n");
+            break;
+    }
+
+    fflush(cfg_csp->out_fp);
+}
+
+static void bench_report_end(bench_cfg_st const *cfg_csp)
+{
+    if (BENCH_FORMAT_JSON == cfg_csp->format_e)
+    {
+        fprintf(cfg_csp->out_fp, "\n  ]\n}\n");
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Main                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static void bench_usage(char const *prog_cp)
+{
+    fprintf(stderr,
+            "usage: %s [--format=console|csv|json] [--out=FILE] [--min-time-ms=N]\n"
+            "          [--max-count=N] [--buffer-size=N]\n"
+            "          [--op=acquire|release_by_ptr|find|mark_all_free|acquire_write|pool_find]\n"
+            "          [--perf] [--find-index]\n",
+            prog_cp);
+}
+
+static bool bench_parse_args(int argc, char **argv, bench_cfg_st *cfg_sp)
+{
+    int index;
+
+    cfg_sp->format_e       = BENCH_FORMAT_CONSOLE;
+    cfg_sp->out_fp         = stdout;
+    cfg_sp->min_time_ns    = UINT64_C(50000000);
+    cfg_sp->max_count      = BENCH_POOL_MAX_COUNT;
+    cfg_sp->buffer_size    = 64u;
+    cfg_sp->op_filter      = -1;
+    cfg_sp->use_perf       = false;
+    cfg_sp->use_find_index = false;
+
+    for (index = 1; index < argc; ++index)
+    {
+        char const *value_cp;
+
+        if (true == bench_match_option(argv[index], "--format", &value_cp))
+        {
+            if (false == bench_parse_format(value_cp, &cfg_sp->format_e))
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--out", &value_cp))
+        {
+            cfg_sp->out_fp = fopen(value_cp, "w");
+            if (NULL == cfg_sp->out_fp)
+            {
+                perror(value_cp);
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--min-time-ms", &value_cp))
+        {
+            cfg_sp->min_time_ns = strtoull(value_cp, NULL, 10) * UINT64_C(1000000);
+        }
+        else if (true == bench_match_option(argv[index], "--max-count", &value_cp))
+        {
+            cfg_sp->max_count = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--buffer-size", &value_cp))
+        {
+            cfg_sp->buffer_size = (size_t)strtoull(value_cp, NULL, 10);
+            if (0u == cfg_sp->buffer_size)
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--op", &value_cp))
+        {
+            int op;
+
+            for (op = 0; op < (int)BENCH_OP_COUNT; ++op)
+            {
+                if (0 == strcmp(value_cp, bench_op_names_acp[op]))
+                {
+                    cfg_sp->op_filter = op;
+                }
+            }
+            if (cfg_sp->op_filter < 0)
+            {
+                return false;
+            }
+        }
+        else if (0 == strcmp(argv[index], "--perf"))
+        {
+            cfg_sp->use_perf = true;
+        }
+        else if (0 == strcmp(argv[index], "--find-index"))
+        {
+#if (0 != BUFFER_CFG_FIND_SIMD)
+            cfg_sp->use_find_index = true;
+#else
+            fprintf(stderr, "bench: --find-index needs -DBUFFER_CFG_FIND_SIMD=1\n");
+            return false;
+#endif
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bench_cfg_st  cfg_s;
+    bench_pool_st bp_s;
+    size_t        count;
+    bool          first = true;
+
+    if (false == bench_parse_args(argc, argv, &cfg_s))
+    {
+        bench_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(&bp_s, 0, sizeof(bp_s));
+    memset(&cfg_s.perf_s, 0, sizeof(cfg_s.perf_s));
+
+    if ((true == cfg_s.use_perf) && (false == bench_perf_open(&cfg_s.perf_s)))
+    {
+        fprintf(stderr, "bench: perf_event_open unavailable, counters will read n/a\n");
+    }
+
+    bench_report_begin(&cfg_s);
+
+    for (count = BENCH_POOL_MIN_COUNT;
+         (0u != count) && (count <= cfg_s.max_count);
+         count = bench_next_count(count, cfg_s.max_count))
+    {
+        size_t fill;
+        int    op;
+
+        bp_s.count       = count;
+        bp_s.buffer_size = cfg_s.buffer_size;
+        bp_s.desc_as     = bench_calloc(count, sizeof(buffer_st));
+        bp_s.mem_au8     = bench_calloc(count, cfg_s.buffer_size);
+#if (0 != BUFFER_CFG_EPOCH_RESET)
+        bp_s.epoch_au32  = bench_calloc(count, sizeof(uint32_t));
+#endif
+        if (true == cfg_s.use_find_index)
+        {
+            bp_s.find_addr_au = bench_calloc(count, sizeof(uintptr_t));
+        }
+
+        for (op = 0; op < (int)BENCH_OP_COUNT; ++op)
+        {
+            if ((cfg_s.op_filter >= 0) && (cfg_s.op_filter != op))
+            {
+                continue;
+            }
+
+            for (fill = 0u; fill < (sizeof(bench_fill_pcts_au) / sizeof(bench_fill_pcts_au[0])); ++fill)
+            {
+                bench_result_st result_s;
+
+                bench_measure(&cfg_s, &bp_s, (bench_op_et)op, bench_fill_pcts_au[fill], &result_s);
+                bench_report_row(&cfg_s, &result_s, first);
+                first = false;
+            }
+        }
+
+        free(bp_s.desc_as);
+        free(bp_s.mem_au8);
+        free(bp_s.find_addr_au);
+        free(bp_s.epoch_au32);
+        bp_s.find_addr_au = NULL;
+    }
+
+    bench_report_end(&cfg_s);
+
+    if (true == cfg_s.use_perf)
+    {
+        bench_perf_close(&cfg_s.perf_s);
+    }
+
+    if (stdout != cfg_s.out_fp)
+    {
+        fclose(cfg_s.out_fp);
+    }
+
+    return EXIT_SUCCESS;
+}
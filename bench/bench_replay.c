@@ -0,0 +1,596 @@
+/**
+ * @file bench_replay.c
+ * @brief Trace-driven workload replay against a pool configuration.
+ *
+ * Reads a binary trace (see buffer_trace.h) and replays its acquire and
+ * release events, in timestamp order, against a fresh pool of the requested
+ * size. Reports acquire failures, peak occupancy and per-op latency.
+ *
+ * Recorded buffer indices only identify buffers within the trace: each
+ * recorded acquire is mapped to whatever buffer the replay pool hands out,
+ * and the matching recorded release returns that buffer. Releases of
+ * buffers whose replayed acquire failed are skipped. A recorded failed
+ * acquire is replayed as an acquire that is released immediately.
+ *
+ * By default events are issued back to back; --realtime paces them by
+ * their recorded timestamps (scaled by --speed).
+ *
+ * --generate writes a synthetic bursty trace with Pareto-distributed hold
+ * times instead, for trying the tool without a production recording.
+ *
+ * Build:
+ *   cc -O2 -I. bench/bench_replay.c bench/bench_util.c buffer.c -lm -o bench_replay
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "buffer_trace.h"
+#include "bench_util.h"
+
+/**
+ * @brief Replay configuration (from the command line).
+ */
+typedef struct
+{
+    bench_format_et format_e;
+    FILE           *out_fp;
+    char const     *trace_path_cp;
+    size_t          buffer_count;    /**< 0: use the count from the trace header. */
+    size_t          buffer_size;     /**< 0: use the size from the trace header. */
+    bool            realtime;
+    double          speed;
+    char const     *generate_path_cp;
+    size_t          generate_events;
+    unsigned        generate_threads;
+    uint64_t        seed_u64;
+} replay_cfg_st;
+
+/**
+ * @brief Replay results.
+ */
+typedef struct
+{
+    uint64_t      events;
+    uint64_t      acquires;
+    uint64_t      failures;          /**< Replayed acquires that returned NULL. */
+    uint64_t      recorded_failures; /**< Acquires that already failed in the recording. */
+    uint64_t      releases;
+    uint64_t      skipped_releases;  /**< Releases without a replayed buffer. */
+    size_t        peak_in_use;
+    double        duration_s;
+    bench_hist_st acquire_hist_s;    /**< Acquire latency in ns. */
+    bench_hist_st release_hist_s;    /**< Release latency in ns. */
+} replay_result_st;
+
+/* -------------------------------------------------------------------------- */
+/* Replay                                                                     */
+/* -------------------------------------------------------------------------- */
+
+static void replay_wait_until(uint64_t deadline_ns)
+{
+    while (bench_now_ns() < deadline_ns)
+    {
+    }
+}
+
+static void replay_run(replay_cfg_st const *cfg_csp,
+                       bench_trace_st const *trace_csp,
+                       buffer_array_ctx_st *ctx_sp,
+                       replay_result_st *result_sp)
+{
+    buffer_st **map_asp     = bench_calloc((size_t)trace_csp->max_index + 1u, sizeof(buffer_st *));
+    double      tpn         = bench_ticks_per_ns();
+    double      ns_per_tick = 1e9 / (double)trace_csp->header_s.ticks_per_sec;
+    uint64_t    tsc0        = (0u < trace_csp->record_count) ? trace_csp->records_as[0].tsc : 0u;
+    uint64_t    start_ns    = bench_now_ns();
+    size_t      in_use      = 0u;
+    size_t      index;
+
+    for (index = 0u; index < trace_csp->record_count; ++index)
+    {
+        buffer_trace_record_st const *rec_csp = &trace_csp->records_as[index];
+        buffer_st                    *buf_sp;
+        uint64_t                      start_ticks;
+        uint32_t                      slot = (BUFFER_TRACE_INDEX_NONE == rec_csp->index) ?
+                                             trace_csp->max_index : rec_csp->index;
+
+        if (true == cfg_csp->realtime)
+        {
+            replay_wait_until(start_ns + (uint64_t)(((double)(rec_csp->tsc - tsc0) * ns_per_tick) / cfg_csp->speed));
+        }
+
+        result_sp->events++;
+
+        switch (rec_csp->op)
+        {
+            case BUFFER_TRACE_OP_ACQUIRE:
+            case BUFFER_TRACE_OP_ACQUIRE_FAIL:
+                start_ticks = bench_ticks();
+                buf_sp      = buffer_array_acquire(ctx_sp);
+                bench_hist_record(&result_sp->acquire_hist_s,
+                                  (uint64_t)((double)(bench_ticks() - start_ticks) / tpn));
+                result_sp->acquires++;
+
+                if (BUFFER_TRACE_OP_ACQUIRE_FAIL == rec_csp->op)
+                {
+                    result_sp->recorded_failures++;
+                    if (NULL != buf_sp)
+                    {
+                        buffer_pool_mark_free(&ctx_sp->pool_s, buf_sp);
+                    }
+                    else
+                    {
+                        result_sp->failures++;
+                    }
+                    break;
+                }
+
+                if (NULL == buf_sp)
+                {
+                    result_sp->failures++;
+                }
+                else if (++in_use > result_sp->peak_in_use)
+                {
+                    result_sp->peak_in_use = in_use;
+                }
+
+                /* A buffer still mapped here was never released in the trace. */
+                map_asp[slot] = buf_sp;
+                break;
+
+            case BUFFER_TRACE_OP_RELEASE:
+                buf_sp = map_asp[slot];
+                if (NULL == buf_sp)
+                {
+                    result_sp->skipped_releases++;
+                    break;
+                }
+
+                start_ticks = bench_ticks();
+                (void)buffer_array_release_by_ptr(ctx_sp, buf_sp->data_u8p);
+                bench_hist_record(&result_sp->release_hist_s,
+                                  (uint64_t)((double)(bench_ticks() - start_ticks) / tpn));
+                result_sp->releases++;
+                map_asp[slot] = NULL;
+                in_use--;
+                break;
+
+            case BUFFER_TRACE_OP_MARK_ALL_FREE:
+                buffer_pool_mark_all_free(&ctx_sp->pool_s);
+                memset(map_asp, 0, ((size_t)trace_csp->max_index + 1u) * sizeof(buffer_st *));
+                in_use = 0u;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    result_sp->duration_s = (double)(bench_now_ns() - start_ns) / 1e9;
+    free(map_asp);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Synthetic trace generator                                                  */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Pending release in the generator's min-heap.
+ */
+typedef struct
+{
+    uint64_t time_ns;
+    uint32_t index;
+    uint16_t thread;
+} replay_pending_st;
+
+static double replay_uniform(uint64_t *rng_u64p)
+{
+    return ((double)(bench_rng_next(rng_u64p) >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static void replay_heap_push(replay_pending_st *heap_as, size_t *len_p, replay_pending_st item_s)
+{
+    size_t pos = (*len_p)++;
+
+    while ((pos > 0u) && (heap_as[(pos - 1u) / 2u].time_ns > item_s.time_ns))
+    {
+        heap_as[pos] = heap_as[(pos - 1u) / 2u];
+        pos          = (pos - 1u) / 2u;
+    }
+    heap_as[pos] = item_s;
+}
+
+static replay_pending_st replay_heap_pop(replay_pending_st *heap_as, size_t *len_p)
+{
+    replay_pending_st top_s  = heap_as[0];
+    replay_pending_st last_s = heap_as[--(*len_p)];
+    size_t            pos    = 0u;
+
+    for (;;)
+    {
+        size_t child = (2u * pos) + 1u;
+
+        if (child >= *len_p)
+        {
+            break;
+        }
+        if (((child + 1u) < *len_p) && (heap_as[child + 1u].time_ns < heap_as[child].time_ns))
+        {
+            child++;
+        }
+        if (heap_as[child].time_ns >= last_s.time_ns)
+        {
+            break;
+        }
+        heap_as[pos] = heap_as[child];
+        pos          = child;
+    }
+    heap_as[pos] = last_s;
+
+    return top_s;
+}
+
+/**
+ * @brief Write a synthetic trace: on/off bursts, Pareto(1.5) hold times.
+ */
+static bool replay_generate(replay_cfg_st const *cfg_csp)
+{
+    FILE                   *file_fp  = fopen(cfg_csp->generate_path_cp, "wb");
+    replay_pending_st      *heap_as  = bench_calloc(cfg_csp->generate_events + 1u, sizeof(replay_pending_st));
+    uint32_t               *free_au32 = bench_calloc(cfg_csp->generate_events + 1u, sizeof(uint32_t));
+    buffer_trace_header_st  header_s;
+    uint64_t                rng_u64  = cfg_csp->seed_u64;
+    uint64_t                now_ns   = 0u;
+    size_t                  heap_len = 0u;
+    size_t                  free_len = 0u;
+    uint32_t                next_index = 0u;
+    uint32_t                peak     = 0u;
+    size_t                  written  = 0u;
+    bool                    bursting = false;
+
+    if (NULL == file_fp)
+    {
+        perror(cfg_csp->generate_path_cp);
+        return false;
+    }
+
+    buffer_trace_header_init(&header_s, UINT64_C(1000000000), 0u, cfg_csp->buffer_size);
+    (void)fwrite(&header_s, sizeof(header_s), 1u, file_fp);
+
+    for (;;)
+    {
+        buffer_trace_record_st rec_s;
+        replay_pending_st      pending_s;
+        double                 gap_ns;
+        double                 hold_ns;
+
+        /* On/off source: 200 ns mean gaps inside a burst, 20 us outside. */
+        if (replay_uniform(&rng_u64) < 0.01)
+        {
+            bursting = !bursting;
+        }
+        gap_ns  = -log(replay_uniform(&rng_u64)) * ((true == bursting) ? 200.0 : 20000.0);
+        now_ns += (uint64_t)gap_ns + 1u;
+
+        while ((heap_len > 0u) && (heap_as[0].time_ns <= now_ns))
+        {
+            pending_s = replay_heap_pop(heap_as, &heap_len);
+
+            memset(&rec_s, 0, sizeof(rec_s));
+            rec_s.tsc    = pending_s.time_ns;
+            rec_s.index  = pending_s.index;
+            rec_s.thread = pending_s.thread;
+            rec_s.op     = BUFFER_TRACE_OP_RELEASE;
+            (void)fwrite(&rec_s, sizeof(rec_s), 1u, file_fp);
+            written++;
+
+            free_au32[free_len++] = pending_s.index;
+        }
+
+        if ((written + heap_len + 2u) > cfg_csp->generate_events)
+        {
+            /* No room for another acquire/release pair: drain what is held. */
+            if (0u == heap_len)
+            {
+                break;
+            }
+            now_ns = heap_as[0].time_ns;
+            continue;
+        }
+
+        memset(&rec_s, 0, sizeof(rec_s));
+        rec_s.tsc    = now_ns;
+        rec_s.index  = (0u < free_len) ? free_au32[--free_len] : next_index++;
+        rec_s.thread = (uint16_t)(bench_rng_next(&rng_u64) % cfg_csp->generate_threads);
+        rec_s.op     = BUFFER_TRACE_OP_ACQUIRE;
+        (void)fwrite(&rec_s, sizeof(rec_s), 1u, file_fp);
+        written++;
+
+        /* Pareto(alpha = 1.5, x_m = 1 us), capped at 10 ms. */
+        hold_ns = 1000.0 / pow(replay_uniform(&rng_u64), 1.0 / 1.5);
+        if (hold_ns > 1e7)
+        {
+            hold_ns = 1e7;
+        }
+
+        pending_s.time_ns = now_ns + (uint64_t)hold_ns;
+        pending_s.index   = rec_s.index;
+        pending_s.thread  = (uint16_t)(bench_rng_next(&rng_u64) % cfg_csp->generate_threads);
+        replay_heap_push(heap_as, &heap_len, pending_s);
+
+        if ((uint32_t)heap_len > peak)
+        {
+            peak = (uint32_t)heap_len;
+        }
+    }
+
+    fclose(file_fp);
+    free(heap_as);
+    free(free_au32);
+
+    fprintf(stderr, "generated %zu events, %u distinct buffers, peak %u outstanding\n",
+            written, next_index, peak);
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Reporting                                                                  */
+/* -------------------------------------------------------------------------- */
+
+static void replay_report(replay_cfg_st const *cfg_csp, size_t buffer_count, replay_result_st const *result_csp)
+{
+    bench_hist_st const *acq_csp = &result_csp->acquire_hist_s;
+    bench_hist_st const *rel_csp = &result_csp->release_hist_s;
+    double               fail_pct = (0u < result_csp->acquires) ?
+                                    ((100.0 * (double)result_csp->failures) / (double)result_csp->acquires) : 0.0;
+
+    switch (cfg_csp->format_e)
+    {
+        case BENCH_FORMAT_CSV:
+            fprintf(cfg_csp->out_fp,
+                    "buffer_count,events,acquires,failures,fail_pct,recorded_failures,releases,"
+                    "skipped_releases,peak_in_use,duration_s,acquire_p50_ns,acquire_p99_ns,"
+                    "acquire_p999_ns,acquire_max_ns,release_p50_ns,release_p99_ns,release_p999_ns,"
+                    "release_max_ns\n");
+            fprintf(cfg_csp->out_fp,
+                    "%zu,%llu,%llu,%llu,%.4f,%llu,%llu,%llu,%zu,%.6f,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                    buffer_count,
+                    (unsigned long long)result_csp->events,
+                    (unsigned long long)result_csp->acquires,
+                    (unsigned long long)result_csp->failures, fail_pct,
+                    (unsigned long long)result_csp->recorded_failures,
+                    (unsigned long long)result_csp->releases,
+                    (unsigned long long)result_csp->skipped_releases,
+                    result_csp->peak_in_use, result_csp->duration_s,
+                    (unsigned long long)bench_hist_percentile(acq_csp, 50.0),
+                    (unsigned long long)bench_hist_percentile(acq_csp, 99.0),
+                    (unsigned long long)bench_hist_percentile(acq_csp, 99.9),
+                    (unsigned long long)acq_csp->max_value,
+                    (unsigned long long)bench_hist_percentile(rel_csp, 50.0),
+                    (unsigned long long)bench_hist_percentile(rel_csp, 99.0),
+                    (unsigned long long)bench_hist_percentile(rel_csp, 99.9),
+                    (unsigned long long)rel_csp->max_value);
+            break;
+
+        case BENCH_FORMAT_JSON:
+            fprintf(cfg_csp->out_fp,
+                    "{\"buffer_count\": %zu, \"events\": %llu, \"acquires\": %llu, \"failures\": %llu, "
+                    "\"fail_pct\": %.4f, \"recorded_failures\": %llu, \"releases\": %llu, "
+                    "\"skipped_releases\": %llu, \"peak_in_use\": %zu, \"duration_s\": %.6f,\n"
+                    " \"acquire_ns\": {\"p50\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu},\n"
+                    " \"release_ns\": {\"p50\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu}}\n",
+                    buffer_count,
+                    (unsigned long long)result_csp->events,
+                    (unsigned long long)result_csp->acquires,
+                    (unsigned long long)result_csp->failures, fail_pct,
+                    (unsigned long long)result_csp->recorded_failures,
+                    (unsigned long long)result_csp->releases,
+                    (unsigned long long)result_csp->skipped_releases,
+                    result_csp->peak_in_use, result_csp->duration_s,
+                    (unsigned long long)bench_hist_percentile(acq_csp, 50.0),
+                    (unsigned long long)bench_hist_percentile(acq_csp, 99.0),
+                    (unsigned long long)bench_hist_percentile(acq_csp, 99.9),
+                    (unsigned long long)acq_csp->max_value,
+                    (unsigned long long)bench_hist_percentile(rel_csp, 50.0),
+                    (unsigned long long)bench_hist_percentile(rel_csp, 99.0),
+                    (unsigned long long)bench_hist_percentile(rel_csp, 99.9),
+                    (unsigned long long)rel_csp->max_value);
+            break;
+
+        default:
+            fprintf(cfg_csp->out_fp,
+                    "pool:     %zu buffers\n"
+                    "events:   %llu in %.3f s\n"
+                    "acquires: %llu, failed %llu (%.4f%%), failed in recording %llu\n"
+                    "releases: %llu, skipped %llu\n"
+                    "peak:     %zu buffers in use\n"
+                    "acquire:  p50 %llu ns, p99 %llu ns, p99.9 %llu ns, max %llu ns\n"
+                    "release:  p50 %llu ns, p99 %llu ns, p99.9 %llu ns, max %llu ns\n",
+                    buffer_count,
+                    (unsigned long long)result_csp->events, result_csp->duration_s,
+                    (unsigned long long)result_csp->acquires,
+                    (unsigned long long)result_csp->failures, fail_pct,
+                    (unsigned long long)result_csp->recorded_failures,
+                    (unsigned long long)result_csp->releases,
+                    (unsigned long long)result_csp->skipped_releases,
+                    result_csp->peak_in_use,
+                    (unsigned long long)bench_hist_percentile(acq_csp, 50.0),
+                    (unsigned long long)bench_hist_percentile(acq_csp, 99.0),
+                    (unsigned long long)bench_hist_percentile(acq_csp, 99.9),
+                    (unsigned long long)acq_csp->max_value,
+                    (unsigned long long)bench_hist_percentile(rel_csp, 50.0),
+                    (unsigned long long)bench_hist_percentile(rel_csp, 99.0),
+                    (unsigned long long)bench_hist_percentile(rel_csp, 99.9),
+                    (unsigned long long)rel_csp->max_value);
+            break;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Main                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static void replay_usage(char const *prog_cp)
+{
+    fprintf(stderr,
+            "usage: %s TRACE [--count=N] [--buffer-size=N] [--realtime] [--speed=X]\n"
+            "          [--format=console|csv|json] [--out=FILE]\n"
+            "       %s --generate=TRACE [--events=N] [--threads=N] [--seed=N] [--buffer-size=N]\n",
+            prog_cp, prog_cp);
+}
+
+static bool replay_parse_args(int argc, char **argv, replay_cfg_st *cfg_sp)
+{
+    int index;
+
+    memset(cfg_sp, 0, sizeof(*cfg_sp));
+    cfg_sp->format_e         = BENCH_FORMAT_CONSOLE;
+    cfg_sp->out_fp           = stdout;
+    cfg_sp->speed            = 1.0;
+    cfg_sp->generate_events  = 1000000u;
+    cfg_sp->generate_threads = 4u;
+    cfg_sp->seed_u64         = UINT64_C(0x9E3779B97F4A7C15);
+
+    for (index = 1; index < argc; ++index)
+    {
+        char const *value_cp;
+
+        if (true == bench_match_option(argv[index], "--format", &value_cp))
+        {
+            if (false == bench_parse_format(value_cp, &cfg_sp->format_e))
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--out", &value_cp))
+        {
+            cfg_sp->out_fp = fopen(value_cp, "w");
+            if (NULL == cfg_sp->out_fp)
+            {
+                perror(value_cp);
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--count", &value_cp))
+        {
+            cfg_sp->buffer_count = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--buffer-size", &value_cp))
+        {
+            cfg_sp->buffer_size = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (0 == strcmp(argv[index], "--realtime"))
+        {
+            cfg_sp->realtime = true;
+        }
+        else if (true == bench_match_option(argv[index], "--speed", &value_cp))
+        {
+            cfg_sp->speed = strtod(value_cp, NULL);
+            if (cfg_sp->speed <= 0.0)
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--generate", &value_cp))
+        {
+            cfg_sp->generate_path_cp = value_cp;
+        }
+        else if (true == bench_match_option(argv[index], "--events", &value_cp))
+        {
+            cfg_sp->generate_events = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--threads", &value_cp))
+        {
+            cfg_sp->generate_threads = (unsigned)strtoul(value_cp, NULL, 10);
+            if (0u == cfg_sp->generate_threads)
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--seed", &value_cp))
+        {
+            cfg_sp->seed_u64 = strtoull(value_cp, NULL, 0) | 1u;
+        }
+        else if (('-' != argv[index][0]) && (NULL == cfg_sp->trace_path_cp))
+        {
+            cfg_sp->trace_path_cp = argv[index];
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return ((NULL != cfg_sp->trace_path_cp) || (NULL != cfg_sp->generate_path_cp));
+}
+
+int main(int argc, char **argv)
+{
+    replay_cfg_st        cfg_s;
+    bench_trace_st       trace_s;
+    replay_result_st    *result_sp;
+    buffer_array_ctx_st  ctx_s;
+    buffer_st           *desc_as;
+    uint8_t             *mem_au8;
+    size_t               buffer_count;
+    size_t               buffer_size;
+
+    if (false == replay_parse_args(argc, argv, &cfg_s))
+    {
+        replay_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (NULL != cfg_s.generate_path_cp)
+    {
+        return (true == replay_generate(&cfg_s)) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (false == bench_trace_load(cfg_s.trace_path_cp, &trace_s))
+    {
+        return EXIT_FAILURE;
+    }
+
+    buffer_count = (0u != cfg_s.buffer_count) ? cfg_s.buffer_count : (size_t)trace_s.header_s.buffer_count;
+    buffer_size  = (0u != cfg_s.buffer_size)  ? cfg_s.buffer_size  : (size_t)trace_s.header_s.buffer_size;
+    if (0u == buffer_count)
+    {
+        buffer_count = trace_s.max_index;
+    }
+    if (0u == buffer_size)
+    {
+        buffer_size = 64u;
+    }
+    if (0u == buffer_count)
+    {
+        fprintf(stderr, "%s: empty trace, pass --count\n", cfg_s.trace_path_cp);
+        bench_trace_free(&trace_s);
+        return EXIT_FAILURE;
+    }
+
+    desc_as   = bench_calloc(buffer_count, sizeof(buffer_st));
+    mem_au8   = bench_calloc(buffer_count, buffer_size);
+    result_sp = bench_calloc(1u, sizeof(replay_result_st));
+
+    buffer_array_ctx_init(&ctx_s, desc_as, mem_au8, buffer_count, buffer_size);
+    (void)bench_ticks_per_ns();
+
+    replay_run(&cfg_s, &trace_s, &ctx_s, result_sp);
+    replay_report(&cfg_s, buffer_count, result_sp);
+
+    free(result_sp);
+    free(desc_as);
+    free(mem_au8);
+    bench_trace_free(&trace_s);
+
+    if (stdout != cfg_s.out_fp)
+    {
+        fclose(cfg_s.out_fp);
+    }
+
+    return EXIT_SUCCESS;
+}
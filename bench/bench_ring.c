@@ -0,0 +1,414 @@
+/**
+ * @file bench_ring.c
+ * @brief End-to-end RX descriptor ring benchmark with a software device.
+ *
+ * A device thread plays the NIC: it waits for posted descriptors, writes
+ * --length bytes (a sequence number and a fill pattern) into each buffer
+ * and completes it. The main thread is the driver: it harvests up to
+ * --batch completions at a time, checks the sequence, touches the data and
+ * releases the buffers to the pool; the ring refills itself once fewer
+ * than the threshold descriptors are posted.
+ *
+ * For each refill threshold (1, 1/4, 1/2 and all of the ring) and harvest
+ * batch (1, 16, 64) the run reports buffers per second, ns per buffer,
+ * the mean harvest batch, refill batches per 1000 buffers and how often
+ * the device found the ring empty (refill came too late).
+ *
+ * Build:
+ *   cc -O2 -pthread -I. bench/bench_ring.c bench/bench_util.c buffer.c buffer_ring.c -o bench_ring
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "buffer.h"
+#include "buffer_ring.h"
+#include "bench_util.h"
+
+#define BENCH_RING_MAX_BATCH     (64u)
+
+static unsigned const bench_batches_au[] = { 1u, 16u, 64u };
+static unsigned const bench_threshold_divs_au[] = { 0u, 4u, 2u, 1u };   /* 0: threshold 1 */
+
+/* Sink to keep the compiler from discarding the driver's reads. */
+static volatile uint64_t bench_sink_u64;
+
+/**
+ * @brief Benchmark run configuration (from the command line).
+ */
+typedef struct
+{
+    bench_format_et format_e;
+    FILE           *out_fp;
+    uint32_t        ring_size;
+    size_t          buffer_count;
+    size_t          buffer_size;
+    uint32_t        length;          /**< Bytes the device writes per buffer. */
+    uint64_t        duration_ns;
+} bench_cfg_st;
+
+/**
+ * @brief State shared by the driver and the device thread.
+ */
+typedef struct
+{
+    bench_cfg_st const *cfg_csp;
+    buffer_ring_st      ring_s;
+    int                 stop_flag;
+    uint64_t            device_idle;     /**< Device polls that found no posted descriptor. */
+} bench_shared_st;
+
+/**
+ * @brief Result of one configuration.
+ */
+typedef struct
+{
+    uint32_t threshold;
+    unsigned batch;
+    uint64_t buffers;
+    uint64_t harvests;               /**< Harvest calls that returned completions. */
+    uint64_t refills;
+    uint64_t device_idle;
+    uint64_t errors;                 /**< Out-of-sequence or corrupted buffers. */
+    uint64_t elapsed_ns;
+} bench_result_st;
+
+/* -------------------------------------------------------------------------- */
+/* Device and driver                                                          */
+/* -------------------------------------------------------------------------- */
+
+static void bench_pin(unsigned cpu)
+{
+    cpu_set_t set_s;
+    long      cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (cpu_count <= 1)
+    {
+        return;
+    }
+
+    CPU_ZERO(&set_s);
+    CPU_SET(cpu % (unsigned)cpu_count, &set_s);
+    (void)pthread_setaffinity_np(pthread_self(), sizeof(set_s), &set_s);
+}
+
+static void *bench_device(void *arg_p)
+{
+    bench_shared_st *shared_sp = arg_p;
+    uint32_t         length    = shared_sp->cfg_csp->length;
+    uint64_t         seq_u64   = 0u;
+    uint64_t         idle      = 0u;
+
+    bench_pin(1u);
+
+    while (0 == __atomic_load_n(&shared_sp->stop_flag, __ATOMIC_RELAXED))
+    {
+        buffer_ring_desc_st *desc_sp = buffer_ring_device_peek(&shared_sp->ring_s);
+        uint32_t             fill;
+
+        if (NULL == desc_sp)
+        {
+            idle++;
+            sched_yield();
+            continue;
+        }
+
+        fill = (length < desc_sp->capacity_u32) ? length : desc_sp->capacity_u32;
+        if (fill >= sizeof(seq_u64))
+        {
+            memcpy(desc_sp->data_u8p, &seq_u64, sizeof(seq_u64));
+            memset(&desc_sp->data_u8p[sizeof(seq_u64)], (int)(seq_u64 & 0xFFu), fill - sizeof(seq_u64));
+        }
+        seq_u64++;
+
+        buffer_ring_device_complete(&shared_sp->ring_s, fill, BUFFER_RING_STATUS_OK);
+    }
+
+    shared_sp->device_idle = idle;
+    return NULL;
+}
+
+static bool bench_run(bench_cfg_st const *cfg_csp, uint32_t threshold, unsigned batch, bench_result_st *result_sp)
+{
+    bench_shared_st      shared_s;
+    buffer_array_ctx_st  ctx_s;
+    buffer_ring_rx_st    rx_as[BENCH_RING_MAX_BATCH];
+    buffer_st           *desc_as    = bench_calloc(cfg_csp->buffer_count, sizeof(buffer_st));
+    uint8_t             *mem_au8    = bench_calloc(cfg_csp->buffer_count, cfg_csp->buffer_size);
+    buffer_ring_desc_st *ring_as    = bench_calloc(cfg_csp->ring_size, sizeof(buffer_ring_desc_st));
+    buffer_st          **posted_asp = bench_calloc(cfg_csp->ring_size, sizeof(buffer_st *));
+    pthread_t            device;
+    uint64_t             expect_u64 = 0u;
+    uint64_t             start_ns;
+    uint64_t             sink_u64   = 0u;
+    size_t               index;
+
+    memset(&shared_s, 0, sizeof(shared_s));
+    memset(result_sp, 0, sizeof(*result_sp));
+    shared_s.cfg_csp = cfg_csp;
+
+    buffer_array_ctx_init(&ctx_s, desc_as, mem_au8, cfg_csp->buffer_count, cfg_csp->buffer_size);
+    bench_pin(0u);
+    if ((false == buffer_ring_init(&shared_s.ring_s, &ctx_s, ring_as, posted_asp, cfg_csp->ring_size, threshold)) ||
+        (0 != pthread_create(&device, NULL, bench_device, &shared_s)))
+    {
+        fprintf(stderr, "bench: ring or device thread setup failed\n");
+        free(desc_as);
+        free(mem_au8);
+        free(ring_as);
+        free(posted_asp);
+        return false;
+    }
+
+    start_ns = bench_now_ns();
+    while ((bench_now_ns() - start_ns) < cfg_csp->duration_ns)
+    {
+        size_t count = buffer_ring_harvest(&shared_s.ring_s, rx_as, batch);
+
+        if (0u == count)
+        {
+            sched_yield();
+            continue;
+        }
+
+        result_sp->harvests++;
+
+        for (index = 0u; index < count; ++index)
+        {
+            buffer_st *buf_sp = rx_as[index].buffer_sp;
+            uint64_t   seq_u64;
+
+            memcpy(&seq_u64, buf_sp->data_u8p, sizeof(seq_u64));
+            if ((seq_u64 != expect_u64) ||
+                (buf_sp->data_u8p[rx_as[index].length_u32 - 1u] != (uint8_t)(seq_u64 & 0xFFu)))
+            {
+                result_sp->errors++;
+            }
+            expect_u64 = seq_u64 + 1u;
+            sink_u64  += buf_sp->data_u8p[sizeof(seq_u64)];
+
+            (void)buffer_array_release_by_ptr(&ctx_s, buf_sp->data_u8p);
+        }
+
+        result_sp->buffers += count;
+    }
+    result_sp->elapsed_ns = bench_now_ns() - start_ns;
+
+    __atomic_store_n(&shared_s.stop_flag, 1, __ATOMIC_RELAXED);
+    (void)pthread_join(device, NULL);
+
+    result_sp->threshold   = threshold;
+    result_sp->batch       = batch;
+    result_sp->refills     = shared_s.ring_s.refills;
+    result_sp->device_idle = shared_s.device_idle;
+
+    /* Completions the driver did not get to go back to the pool with the rest. */
+    buffer_ring_deinit(&shared_s.ring_s);
+
+    free(desc_as);
+    free(mem_au8);
+    free(ring_as);
+    free(posted_asp);
+
+    bench_sink_u64 = sink_u64;
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Reporting                                                                  */
+/* -------------------------------------------------------------------------- */
+
+static void bench_report_begin(bench_cfg_st const *cfg_csp)
+{
+    switch (cfg_csp->format_e)
+    {
+        case BENCH_FORMAT_CSV:
+            fprintf(cfg_csp->out_fp,
+                    "ring_size,threshold,batch,buffers,buffers_per_s,ns_per_buffer,mean_batch,"
+                    "refills_per_1k,device_idle,errors\n");
+            break;
+
+        case BENCH_FORMAT_JSON:
+            fprintf(cfg_csp->out_fp,
+                    "{\n  \"context\": {\"ring_size\": %u, \"buffer_count\": %zu, \"buffer_size\": %zu, "
+                    "\"length\": %u, \"duration_ns\": %llu},\n  \"benchmarks\": [",
+                    cfg_csp->ring_size, cfg_csp->buffer_count, cfg_csp->buffer_size, cfg_csp->length,
+                    (unsigned long long)cfg_csp->duration_ns);
+            break;
+
+        default:
+            fprintf(cfg_csp->out_fp, "%9s %9s %6s %12s %12s %10s %10s %10s %12s %7s\n",
+                    "ring", "threshold", "batch", "buffers", "buffers/s", "ns/buffer", "mean batch",
+                    "refills/1k", "device idle", "errors");
+            break;
+    }
+}
+
+static void bench_report_row(bench_cfg_st const *cfg_csp, bench_result_st const *result_csp, bool first)
+{
+    double buffers     = (double)result_csp->buffers;
+    double per_s       = (0u == result_csp->elapsed_ns) ? 0.0 : (buffers * 1e9) / (double)result_csp->elapsed_ns;
+    double ns_per      = (0u == result_csp->buffers) ? 0.0 : (double)result_csp->elapsed_ns / buffers;
+    double mean_batch  = (0u == result_csp->harvests) ? 0.0 : buffers / (double)result_csp->harvests;
+    double refills_1k  = (0u == result_csp->buffers) ? 0.0 : ((double)result_csp->refills * 1000.0) / buffers;
+
+    switch (cfg_csp->format_e)
+    {
+        case BENCH_FORMAT_CSV:
+            fprintf(cfg_csp->out_fp, "%u,%u,%u,%llu,%.0f,%.2f,%.2f,%.2f,%llu,%llu\n",
+                    cfg_csp->ring_size, result_csp->threshold, result_csp->batch,
+                    (unsigned long long)result_csp->buffers, per_s, ns_per, mean_batch, refills_1k,
+                    (unsigned long long)result_csp->device_idle, (unsigned long long)result_csp->errors);
+            break;
+
+        case BENCH_FORMAT_JSON:
+            fprintf(cfg_csp->out_fp,
+                    "%s\n    {\"ring_size\": %u, \"threshold\": %u, \"batch\": %u, \"buffers\": %llu, "
+                    "\"buffers_per_s\": %.0f, \"ns_per_buffer\": %.2f, \"mean_batch\": %.2f, "
+                    "\"refills_per_1k\": %.2f, \"device_idle\": %llu, \"errors\": %llu}",
+                    first ? "" : ",",
+                    cfg_csp->ring_size, result_csp->threshold, result_csp->batch,
+                    (unsigned long long)result_csp->buffers, per_s, ns_per, mean_batch, refills_1k,
+                    (unsigned long long)result_csp->device_idle, (unsigned long long)result_csp->errors);
+            break;
+
+        default:
+            fprintf(cfg_csp->out_fp, "%9u %9u %6u %12llu %12.0f %10.1f %10.2f %10.2f %12llu %7llu\n",
+                    cfg_csp->ring_size, result_csp->threshold, result_csp->batch,
+                    (unsigned long long)result_csp->buffers, per_s, ns_per, mean_batch, refills_1k,
+                    (unsigned long long)result_csp->device_idle, (unsigned long long)result_csp->errors);
+            break;
+    }
+
+    fflush(cfg_csp->out_fp);
+}
+
+static void bench_report_end(bench_cfg_st const *cfg_csp)
+{
+    if (BENCH_FORMAT_JSON == cfg_csp->format_e)
+    {
+        fprintf(cfg_csp->out_fp, "\n  ]\n}\n");
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Main                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static void bench_usage(char const *prog_cp)
+{
+    fprintf(stderr,
+            "usage: %s [--format=console|csv|json] [--out=FILE] [--duration-ms=N]\n"
+            "          [--ring-size=N] [--buffer-count=N] [--buffer-size=N] [--length=N]\n",
+            prog_cp);
+}
+
+static bool bench_parse_args(int argc, char **argv, bench_cfg_st *cfg_sp)
+{
+    int index;
+
+    cfg_sp->format_e     = BENCH_FORMAT_CONSOLE;
+    cfg_sp->out_fp       = stdout;
+    cfg_sp->ring_size    = 256u;
+    cfg_sp->buffer_count = 1024u;
+    cfg_sp->buffer_size  = 2048u;
+    cfg_sp->length       = 1500u;
+    cfg_sp->duration_ns  = UINT64_C(200000000);
+
+    for (index = 1; index < argc; ++index)
+    {
+        char const *value_cp;
+
+        if (true == bench_match_option(argv[index], "--format", &value_cp))
+        {
+            if (false == bench_parse_format(value_cp, &cfg_sp->format_e))
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--out", &value_cp))
+        {
+            cfg_sp->out_fp = fopen(value_cp, "w");
+            if (NULL == cfg_sp->out_fp)
+            {
+                perror(value_cp);
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--duration-ms", &value_cp))
+        {
+            cfg_sp->duration_ns = strtoull(value_cp, NULL, 10) * UINT64_C(1000000);
+        }
+        else if (true == bench_match_option(argv[index], "--ring-size", &value_cp))
+        {
+            cfg_sp->ring_size = (uint32_t)strtoul(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--buffer-count", &value_cp))
+        {
+            cfg_sp->buffer_count = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--buffer-size", &value_cp))
+        {
+            cfg_sp->buffer_size = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--length", &value_cp))
+        {
+            cfg_sp->length = (uint32_t)strtoul(value_cp, NULL, 10);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    /* The ring must fit in the pool, with room for buffers being consumed. */
+    return ((0u != cfg_sp->ring_size) && (0u == (cfg_sp->ring_size & (cfg_sp->ring_size - 1u))) &&
+            (cfg_sp->buffer_count > cfg_sp->ring_size) &&
+            (cfg_sp->length >= sizeof(uint64_t)) && (cfg_sp->length <= cfg_sp->buffer_size));
+}
+
+int main(int argc, char **argv)
+{
+    bench_cfg_st cfg_s;
+    bool         first = true;
+    size_t       div;
+    size_t       batch;
+
+    if (false == bench_parse_args(argc, argv, &cfg_s))
+    {
+        bench_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bench_report_begin(&cfg_s);
+
+    for (div = 0u; div < (sizeof(bench_threshold_divs_au) / sizeof(bench_threshold_divs_au[0])); ++div)
+    {
+        uint32_t threshold = (0u == bench_threshold_divs_au[div]) ? 1u : (cfg_s.ring_size / bench_threshold_divs_au[div]);
+
+        for (batch = 0u; batch < (sizeof(bench_batches_au) / sizeof(bench_batches_au[0])); ++batch)
+        {
+            bench_result_st result_s;
+
+            if (true == bench_run(&cfg_s, threshold, bench_batches_au[batch], &result_s))
+            {
+                bench_report_row(&cfg_s, &result_s, first);
+                first = false;
+            }
+        }
+    }
+
+    bench_report_end(&cfg_s);
+
+    if (stdout != cfg_s.out_fp)
+    {
+        fclose(cfg_s.out_fp);
+    }
+
+    return EXIT_SUCCESS;
+}
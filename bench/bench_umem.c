@@ -0,0 +1,630 @@
+/**
+ * @file bench_umem.c
+ * @brief End-to-end fill / completion ring benchmark with an engine thread.
+ *
+ * An engine thread runs buffer_umem_engine_poll() in a loop. The main
+ * thread is the application: it takes up to --batch filled frames from the
+ * completion ring, checks them, releases them to the pool and refills the
+ * fill ring with as many fresh frames in one submit.
+ *
+ * The engine writes a byte stream in which every byte is its stream offset
+ * modulo 251, so the application can check both the data and that frames
+ * come back in the order they were filled. Two engines are available:
+ *  - synthetic: rx_fn writes --length bytes of the stream into each frame.
+ *  - pipe:      a writer thread pushes the stream into a pipe in --length
+ *               chunks and the readv() engine of buffer_umem.h reads it.
+ *
+ * Every completed frame must be a frame of the pool that is currently in
+ * use. After the engine stops, the frames still in use must be exactly the
+ * ones left on the fill ring, each once: otherwise a descriptor was lost
+ * or duplicated on the way around. Both checks count as errors.
+ *
+ * For each batch (1, 16, 64) the run reports frames per second, ns per
+ * frame, MB/s of verified data, the mean completion batch, how often the
+ * engine found nothing to do and the error count.
+ *
+ * Build:
+ *   cc -O2 -pthread -I. bench/bench_umem.c bench/bench_util.c buffer.c buffer_umem.c -o bench_umem
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "buffer.h"
+#include "buffer_umem.h"
+#include "bench_util.h"
+
+#define BENCH_UMEM_PATTERN_PERIOD  (251u)    /**< Prime, so the pattern does not align with frames. */
+
+static unsigned const bench_batches_au[] = { 1u, 16u, 64u };
+
+/**
+ * @brief Engine backends.
+ */
+typedef enum
+{
+    BENCH_ENGINE_SYNTHETIC = 0,
+    BENCH_ENGINE_PIPE
+} bench_engine_et;
+
+/**
+ * @brief Benchmark run configuration (from the command line).
+ */
+typedef struct
+{
+    bench_format_et  format_e;
+    FILE            *out_fp;
+    bench_engine_et  engine_e;
+    uint32_t         ring_size;       /**< Entries of the fill and completion rings. */
+    size_t           buffer_count;
+    size_t           buffer_size;
+    uint32_t         length;          /**< Bytes per frame (synthetic) or per write (pipe). */
+    uint64_t         duration_ns;
+} bench_cfg_st;
+
+/**
+ * @brief State of the synthetic engine.
+ */
+typedef struct
+{
+    uint8_t const *pattern_au8p;
+    uint32_t       length;
+    uint64_t       offset_u64;        /**< Stream bytes written so far. */
+} bench_synth_st;
+
+/**
+ * @brief State shared by the application, the engine and the pipe writer.
+ */
+typedef struct
+{
+    bench_cfg_st const    *cfg_csp;
+    uint8_t const         *pattern_au8p;
+    buffer_umem_st         umem_s;
+    buffer_umem_engine_st  engine_s;
+    int                    write_fd;
+    int                    stop_flag;
+    uint64_t               engine_idle;  /**< Polls that completed nothing. */
+} bench_shared_st;
+
+/**
+ * @brief Result of one configuration.
+ */
+typedef struct
+{
+    unsigned batch;
+    uint64_t frames;
+    uint64_t bytes;
+    uint64_t completions;            /**< Complete calls that returned frames. */
+    uint64_t engine_idle;
+    uint64_t errors;                 /**< Bad data, foreign or idle frames, lost or duplicated descriptors. */
+    uint64_t elapsed_ns;
+} bench_result_st;
+
+/* -------------------------------------------------------------------------- */
+/* Engines                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static void bench_pin(unsigned cpu)
+{
+    cpu_set_t set_s;
+    long      cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (cpu_count <= 1)
+    {
+        return;
+    }
+
+    CPU_ZERO(&set_s);
+    CPU_SET(cpu % (unsigned)cpu_count, &set_s);
+    (void)pthread_setaffinity_np(pthread_self(), sizeof(set_s), &set_s);
+}
+
+static int bench_synth_rx(void *engine_p, buffer_umem_io_st *io_as, uint32_t count_u32)
+{
+    bench_synth_st *synth_sp = engine_p;
+    uint32_t        index;
+
+    for (index = 0u; index < count_u32; ++index)
+    {
+        uint32_t fill = (synth_sp->length < io_as[index].capacity_u32) ? synth_sp->length : io_as[index].capacity_u32;
+
+        memcpy(io_as[index].data_u8p, &synth_sp->pattern_au8p[synth_sp->offset_u64 % BENCH_UMEM_PATTERN_PERIOD], fill);
+        io_as[index].length_u32  = fill;
+        io_as[index].options_u32 = 0u;
+        synth_sp->offset_u64    += fill;
+    }
+
+    return (int)count_u32;
+}
+
+static void *bench_engine(void *arg_p)
+{
+    bench_shared_st *shared_sp = arg_p;
+    uint64_t         idle      = 0u;
+
+    bench_pin(1u);
+
+    while (0 == __atomic_load_n(&shared_sp->stop_flag, __ATOMIC_RELAXED))
+    {
+        if (0 >= buffer_umem_engine_poll(&shared_sp->umem_s, &shared_sp->engine_s))
+        {
+            idle++;
+            sched_yield();
+        }
+    }
+
+    shared_sp->engine_idle = idle;
+    return NULL;
+}
+
+/* Non-blocking, so that it notices the stop flag once the engine stops reading. */
+static void *bench_writer(void *arg_p)
+{
+    bench_shared_st *shared_sp  = arg_p;
+    uint32_t         length     = shared_sp->cfg_csp->length;
+    uint64_t         offset_u64 = 0u;
+
+    bench_pin(2u);
+
+    while (0 == __atomic_load_n(&shared_sp->stop_flag, __ATOMIC_RELAXED))
+    {
+        ssize_t put = write(shared_sp->write_fd,
+                            &shared_sp->pattern_au8p[offset_u64 % BENCH_UMEM_PATTERN_PERIOD], length);
+
+        if (0 < put)
+        {
+            offset_u64 += (uint64_t)put;
+        }
+        else if ((0 > put) && (EAGAIN != errno) && (EINTR != errno))
+        {
+            break;
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Application                                                                */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Check and release completed frames; returns the errors found.
+ */
+static uint64_t bench_consume(buffer_array_ctx_st *ctx_sp,
+                              uint8_t const *pattern_au8p,
+                              buffer_umem_frame_st const *frame_as,
+                              uint32_t count,
+                              uint64_t *offset_u64p,
+                              uint64_t *bytes_u64p)
+{
+    uint64_t errors = 0u;
+    uint32_t index;
+
+    for (index = 0u; index < count; ++index)
+    {
+        buffer_st *buf_sp = frame_as[index].buffer_sp;
+        uint32_t   length = frame_as[index].length_u32;
+
+        /* The frame must be one of ours and out on the rings, not free. */
+        if ((NULL == buf_sp) || (true == buf_sp->is_available) || (length > buf_sp->capacity_bytes))
+        {
+            errors++;
+            continue;
+        }
+
+        if (0 != memcmp(buf_sp->data_u8p, &pattern_au8p[*offset_u64p % BENCH_UMEM_PATTERN_PERIOD], length))
+        {
+            errors++;
+        }
+        *offset_u64p += length;
+        *bytes_u64p  += length;
+
+        (void)buffer_array_release_by_ptr(ctx_sp, buf_sp->data_u8p);
+    }
+
+    return errors;
+}
+
+/**
+ * @brief With the engine stopped, check that the frames in use are exactly
+ *        the ones left on the fill ring; returns the errors found.
+ */
+static uint64_t bench_check_round_trip(bench_shared_st *shared_sp, buffer_st const *desc_as, size_t buffer_count)
+{
+    buffer_umem_ring_st const *fill_csp = &shared_sp->umem_s.fill_s;
+    uint8_t                   *seen_au8 = bench_calloc(buffer_count, sizeof(uint8_t));
+    uint32_t                   pending  = fill_csp->producer_u32 - fill_csp->consumer_u32;
+    uint64_t                   errors   = 0u;
+    uint32_t                   entry;
+    size_t                     index;
+
+    for (entry = 0u; entry < pending; ++entry)
+    {
+        uint64_t   addr_u64 = fill_csp->desc_as[(fill_csp->consumer_u32 + entry) & fill_csp->mask_u32].addr_u64;
+        buffer_st *buf_sp   = buffer_umem_frame(&shared_sp->umem_s, addr_u64);
+
+        if ((NULL == buf_sp) || (true == buf_sp->is_available) || (0u != seen_au8[buf_sp - desc_as]))
+        {
+            errors++;
+            continue;
+        }
+        seen_au8[buf_sp - desc_as] = 1u;
+    }
+
+    /* A frame in use that is not on the fill ring never came back. */
+    for (index = 0u; index < buffer_count; ++index)
+    {
+        if ((false == desc_as[index].is_available) && (0u == seen_au8[index]))
+        {
+            errors++;
+        }
+    }
+
+    free(seen_au8);
+    return errors;
+}
+
+static bool bench_run(bench_cfg_st const *cfg_csp, uint8_t const *pattern_au8p, unsigned batch, bench_result_st *result_sp)
+{
+    bench_shared_st       shared_s;
+    bench_synth_st        synth_s;
+    buffer_umem_fd_st     fd_s;
+    buffer_array_ctx_st   ctx_s;
+    buffer_umem_frame_st  frame_as[BUFFER_UMEM_MAX_BATCH];
+    buffer_st            *desc_as  = bench_calloc(cfg_csp->buffer_count, sizeof(buffer_st));
+    uint8_t              *mem_au8  = bench_calloc(cfg_csp->buffer_count, cfg_csp->buffer_size);
+    buffer_umem_desc_st  *fill_as  = bench_calloc(cfg_csp->ring_size, sizeof(buffer_umem_desc_st));
+    buffer_umem_desc_st  *comp_as  = bench_calloc(cfg_csp->ring_size, sizeof(buffer_umem_desc_st));
+    int                   pipe_ai[2] = { -1, -1 };
+    pthread_t             engine;
+    pthread_t             writer;
+    bool                  has_writer = false;
+    bool                  is_ready;
+    uint64_t              offset_u64 = 0u;
+    uint64_t              start_ns;
+    uint32_t              count;
+
+    memset(&shared_s, 0, sizeof(shared_s));
+    memset(result_sp, 0, sizeof(*result_sp));
+    shared_s.cfg_csp      = cfg_csp;
+    shared_s.pattern_au8p = pattern_au8p;
+
+    buffer_array_ctx_init(&ctx_s, desc_as, mem_au8, cfg_csp->buffer_count, cfg_csp->buffer_size);
+    bench_pin(0u);
+
+    is_ready = buffer_umem_init(&shared_s.umem_s, &ctx_s, fill_as, cfg_csp->ring_size, comp_as, cfg_csp->ring_size);
+    if ((true == is_ready) && (BENCH_ENGINE_PIPE == cfg_csp->engine_e))
+    {
+        is_ready = ((0 == pipe(pipe_ai))                                                    &&
+                    (0 == fcntl(pipe_ai[0], F_SETFL, fcntl(pipe_ai[0], F_GETFL) | O_NONBLOCK)) &&
+                    (0 == fcntl(pipe_ai[1], F_SETFL, fcntl(pipe_ai[1], F_GETFL) | O_NONBLOCK)) &&
+                    (true == buffer_umem_fd_engine_init(&shared_s.engine_s, &fd_s, pipe_ai[0])));
+        shared_s.write_fd = pipe_ai[1];
+    }
+    else
+    {
+        synth_s.pattern_au8p       = pattern_au8p;
+        synth_s.length             = cfg_csp->length;
+        synth_s.offset_u64         = 0u;
+        shared_s.engine_s.rx_fn    = bench_synth_rx;
+        shared_s.engine_s.engine_p = &synth_s;
+    }
+
+    /* Prime the fill ring before the engine starts. */
+    if (true == is_ready)
+    {
+        (void)buffer_umem_fill(&shared_s.umem_s, cfg_csp->ring_size);
+        is_ready = (0 == pthread_create(&engine, NULL, bench_engine, &shared_s));
+    }
+    if ((true == is_ready) && (BENCH_ENGINE_PIPE == cfg_csp->engine_e))
+    {
+        has_writer = (0 == pthread_create(&writer, NULL, bench_writer, &shared_s));
+        if (false == has_writer)
+        {
+            __atomic_store_n(&shared_s.stop_flag, 1, __ATOMIC_RELAXED);
+            (void)pthread_join(engine, NULL);
+            is_ready = false;
+        }
+    }
+
+    if (false == is_ready)
+    {
+        fprintf(stderr, "bench: umem, pipe or engine thread setup failed\n");
+        if (0 <= pipe_ai[0])
+        {
+            (void)close(pipe_ai[0]);
+            (void)close(pipe_ai[1]);
+        }
+        free(desc_as);
+        free(mem_au8);
+        free(fill_as);
+        free(comp_as);
+        return false;
+    }
+
+    start_ns = bench_now_ns();
+    while ((bench_now_ns() - start_ns) < cfg_csp->duration_ns)
+    {
+        count = buffer_umem_complete(&shared_s.umem_s, frame_as, batch);
+        if (0u == count)
+        {
+            sched_yield();
+            continue;
+        }
+
+        result_sp->completions++;
+        result_sp->errors += bench_consume(&ctx_s, pattern_au8p, frame_as, count, &offset_u64, &result_sp->bytes);
+        result_sp->frames += count;
+
+        /* Refill with as many frames as were just returned, in one submit. */
+        (void)buffer_umem_fill(&shared_s.umem_s, count);
+    }
+    result_sp->elapsed_ns = bench_now_ns() - start_ns;
+
+    __atomic_store_n(&shared_s.stop_flag, 1, __ATOMIC_RELAXED);
+    (void)pthread_join(engine, NULL);
+    if (true == has_writer)
+    {
+        (void)pthread_join(writer, NULL);
+    }
+
+    /* Completions the application did not get to, then the round trip. */
+    while (0u != (count = buffer_umem_complete(&shared_s.umem_s, frame_as, BUFFER_UMEM_MAX_BATCH)))
+    {
+        uint64_t drained_bytes = 0u;
+
+        result_sp->errors += bench_consume(&ctx_s, pattern_au8p, frame_as, count, &offset_u64, &drained_bytes);
+    }
+    result_sp->errors += bench_check_round_trip(&shared_s, desc_as, cfg_csp->buffer_count);
+
+    result_sp->batch       = batch;
+    result_sp->engine_idle = shared_s.engine_idle;
+
+    if (0 <= pipe_ai[0])
+    {
+        (void)close(pipe_ai[0]);
+        (void)close(pipe_ai[1]);
+    }
+    free(desc_as);
+    free(mem_au8);
+    free(fill_as);
+    free(comp_as);
+
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Reporting                                                                  */
+/* -------------------------------------------------------------------------- */
+
+static char const *bench_engine_name(bench_engine_et engine_e)
+{
+    return (BENCH_ENGINE_PIPE == engine_e) ? "pipe" : "synthetic";
+}
+
+static void bench_report_begin(bench_cfg_st const *cfg_csp)
+{
+    switch (cfg_csp->format_e)
+    {
+        case BENCH_FORMAT_CSV:
+            fprintf(cfg_csp->out_fp,
+                    "engine,ring_size,batch,frames,frames_per_s,ns_per_frame,mb_per_s,mean_batch,"
+                    "engine_idle,errors\n");
+            break;
+
+        case BENCH_FORMAT_JSON:
+            fprintf(cfg_csp->out_fp,
+                    "{\n  \"context\": {\"engine\": \"%s\", \"ring_size\": %u, \"buffer_count\": %zu, "
+                    "\"buffer_size\": %zu, \"length\": %u, \"duration_ns\": %llu},\n  \"benchmarks\": [",
+                    bench_engine_name(cfg_csp->engine_e), cfg_csp->ring_size, cfg_csp->buffer_count,
+                    cfg_csp->buffer_size, cfg_csp->length, (unsigned long long)cfg_csp->duration_ns);
+            break;
+
+        default:
+            fprintf(cfg_csp->out_fp, "%9s %6s %6s %12s %12s %10s %10s %10s %12s %7s\n",
+                    "engine", "ring", "batch", "frames", "frames/s", "ns/frame", "MB/s", "mean batch",
+                    "engine idle", "errors");
+            break;
+    }
+}
+
+static void bench_report_row(bench_cfg_st const *cfg_csp, bench_result_st const *result_csp, bool first)
+{
+    double frames     = (double)result_csp->frames;
+    double elapsed_s  = (double)result_csp->elapsed_ns / 1e9;
+    double per_s      = (0u == result_csp->elapsed_ns) ? 0.0 : frames / elapsed_s;
+    double ns_per     = (0u == result_csp->frames) ? 0.0 : (double)result_csp->elapsed_ns / frames;
+    double mb_per_s   = (0u == result_csp->elapsed_ns) ? 0.0 : ((double)result_csp->bytes / 1e6) / elapsed_s;
+    double mean_batch = (0u == result_csp->completions) ? 0.0 : frames / (double)result_csp->completions;
+
+    switch (cfg_csp->format_e)
+    {
+        case BENCH_FORMAT_CSV:
+            fprintf(cfg_csp->out_fp, "%s,%u,%u,%llu,%.0f,%.2f,%.1f,%.2f,%llu,%llu\n",
+                    bench_engine_name(cfg_csp->engine_e), cfg_csp->ring_size, result_csp->batch,
+                    (unsigned long long)result_csp->frames, per_s, ns_per, mb_per_s, mean_batch,
+                    (unsigned long long)result_csp->engine_idle, (unsigned long long)result_csp->errors);
+            break;
+
+        case BENCH_FORMAT_JSON:
+            fprintf(cfg_csp->out_fp,
+                    "%s\n    {\"engine\": \"%s\", \"ring_size\": %u, \"batch\": %u, \"frames\": %llu, "
+                    "\"frames_per_s\": %.0f, \"ns_per_frame\": %.2f, \"mb_per_s\": %.1f, "
+                    "\"mean_batch\": %.2f, \"engine_idle\": %llu, \"errors\": %llu}",
+                    first ? "" : ",",
+                    bench_engine_name(cfg_csp->engine_e), cfg_csp->ring_size, result_csp->batch,
+                    (unsigned long long)result_csp->frames, per_s, ns_per, mb_per_s, mean_batch,
+                    (unsigned long long)result_csp->engine_idle, (unsigned long long)result_csp->errors);
+            break;
+
+        default:
+            fprintf(cfg_csp->out_fp, "%9s %6u %6u %12llu %12.0f %10.1f %10.1f %10.2f %12llu %7llu\n",
+                    bench_engine_name(cfg_csp->engine_e), cfg_csp->ring_size, result_csp->batch,
+                    (unsigned long long)result_csp->frames, per_s, ns_per, mb_per_s, mean_batch,
+                    (unsigned long long)result_csp->engine_idle, (unsigned long long)result_csp->errors);
+            break;
+    }
+
+    fflush(cfg_csp->out_fp);
+}
+
+static void bench_report_end(bench_cfg_st const *cfg_csp)
+{
+    if (BENCH_FORMAT_JSON == cfg_csp->format_e)
+    {
+        fprintf(cfg_csp->out_fp, "\n  ]\n}\n");
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Main                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static void bench_usage(char const *prog_cp)
+{
+    fprintf(stderr,
+            "usage: %s [--format=console|csv|json] [--out=FILE] [--duration-ms=N]\n"
+            "          [--engine=synthetic|pipe] [--ring-size=N] [--buffer-count=N]\n"
+            "          [--buffer-size=N] [--length=N]\n",
+            prog_cp);
+}
+
+static bool bench_parse_args(int argc, char **argv, bench_cfg_st *cfg_sp)
+{
+    int index;
+
+    cfg_sp->format_e     = BENCH_FORMAT_CONSOLE;
+    cfg_sp->out_fp       = stdout;
+    cfg_sp->engine_e     = BENCH_ENGINE_SYNTHETIC;
+    cfg_sp->ring_size    = 256u;
+    cfg_sp->buffer_count = 1024u;
+    cfg_sp->buffer_size  = 2048u;
+    cfg_sp->length       = 1500u;
+    cfg_sp->duration_ns  = UINT64_C(200000000);
+
+    for (index = 1; index < argc; ++index)
+    {
+        char const *value_cp;
+
+        if (true == bench_match_option(argv[index], "--format", &value_cp))
+        {
+            if (false == bench_parse_format(value_cp, &cfg_sp->format_e))
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--out", &value_cp))
+        {
+            cfg_sp->out_fp = fopen(value_cp, "w");
+            if (NULL == cfg_sp->out_fp)
+            {
+                perror(value_cp);
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--engine", &value_cp))
+        {
+            if (0 == strcmp(value_cp, "synthetic"))
+            {
+                cfg_sp->engine_e = BENCH_ENGINE_SYNTHETIC;
+            }
+            else if (0 == strcmp(value_cp, "pipe"))
+            {
+                cfg_sp->engine_e = BENCH_ENGINE_PIPE;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--duration-ms", &value_cp))
+        {
+            cfg_sp->duration_ns = strtoull(value_cp, NULL, 10) * UINT64_C(1000000);
+        }
+        else if (true == bench_match_option(argv[index], "--ring-size", &value_cp))
+        {
+            cfg_sp->ring_size = (uint32_t)strtoul(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--buffer-count", &value_cp))
+        {
+            cfg_sp->buffer_count = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--buffer-size", &value_cp))
+        {
+            cfg_sp->buffer_size = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (true == bench_match_option(argv[index], "--length", &value_cp))
+        {
+            cfg_sp->length = (uint32_t)strtoul(value_cp, NULL, 10);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    /* The fill ring must fit in the pool, with room for frames being consumed. */
+    return ((0u != cfg_sp->ring_size) && (0u == (cfg_sp->ring_size & (cfg_sp->ring_size - 1u))) &&
+            (cfg_sp->buffer_count > cfg_sp->ring_size) &&
+            (0u != cfg_sp->length) && (cfg_sp->length <= cfg_sp->buffer_size) &&
+            (cfg_sp->buffer_size <= UINT32_MAX));
+}
+
+int main(int argc, char **argv)
+{
+    bench_cfg_st  cfg_s;
+    uint8_t      *pattern_au8;
+    bool          first  = true;
+    uint64_t      errors = 0u;
+    size_t        batch;
+    size_t        index;
+
+    if (false == bench_parse_args(argc, argv, &cfg_s))
+    {
+        bench_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Any stream offset modulo the period starts a run of buffer_size pattern bytes. */
+    pattern_au8 = bench_calloc(BENCH_UMEM_PATTERN_PERIOD + cfg_s.buffer_size, sizeof(uint8_t));
+    for (index = 0u; index < (BENCH_UMEM_PATTERN_PERIOD + cfg_s.buffer_size); ++index)
+    {
+        pattern_au8[index] = (uint8_t)(index % BENCH_UMEM_PATTERN_PERIOD);
+    }
+
+    bench_report_begin(&cfg_s);
+
+    for (batch = 0u; batch < (sizeof(bench_batches_au) / sizeof(bench_batches_au[0])); ++batch)
+    {
+        bench_result_st result_s;
+
+        if (true == bench_run(&cfg_s, pattern_au8, bench_batches_au[batch], &result_s))
+        {
+            bench_report_row(&cfg_s, &result_s, first);
+            first   = false;
+            errors += result_s.errors;
+        }
+    }
+
+    bench_report_end(&cfg_s);
+
+    if (stdout != cfg_s.out_fp)
+    {
+        fclose(cfg_s.out_fp);
+    }
+
+    free(pattern_au8);
+    return (0u == errors) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file bench_util.c
+ * @brief Shared helpers for the buffer-pool benchmarks.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_util.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+uint64_t bench_now_ns(void)
+{
+    struct timespec ts_s;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts_s);
+
+    return ((uint64_t)ts_s.tv_sec * 1000000000u) + (uint64_t)ts_s.tv_nsec;
+}
+
+double bench_ticks_per_ns(void)
+{
+    static double ticks_per_ns;
+
+    if (0.0 == ticks_per_ns)
+    {
+        uint64_t start_ns    = bench_now_ns();
+        uint64_t start_ticks = bench_ticks();
+        uint64_t end_ns;
+
+        do
+        {
+            end_ns = bench_now_ns();
+        } while ((end_ns - start_ns) < UINT64_C(50000000));
+
+        ticks_per_ns = (double)(bench_ticks() - start_ticks) / (double)(end_ns - start_ns);
+    }
+
+    return ticks_per_ns;
+}
+
+void bench_hist_reset(bench_hist_st *hist_sp)
+{
+    memset(hist_sp, 0, sizeof(*hist_sp));
+}
+
+void bench_hist_merge(bench_hist_st *dst_sp, bench_hist_st const *src_csp)
+{
+    unsigned bucket;
+
+    for (bucket = 0u; bucket < BENCH_HIST_BUCKETS; ++bucket)
+    {
+        dst_sp->count_au64[bucket] += src_csp->count_au64[bucket];
+    }
+
+    dst_sp->total_count += src_csp->total_count;
+    if (src_csp->max_value > dst_sp->max_value)
+    {
+        dst_sp->max_value = src_csp->max_value;
+    }
+}
+
+uint64_t bench_hist_percentile(bench_hist_st const *hist_csp, double pct)
+{
+    uint64_t rank;
+    uint64_t seen = 0u;
+    unsigned bucket;
+
+    if (0u == hist_csp->total_count)
+    {
+        return 0u;
+    }
+
+    rank = (uint64_t)(((double)hist_csp->total_count * pct) / 100.0);
+    if (rank >= hist_csp->total_count)
+    {
+        rank = hist_csp->total_count - 1u;
+    }
+
+    for (bucket = 0u; bucket < BENCH_HIST_BUCKETS; ++bucket)
+    {
+        seen += hist_csp->count_au64[bucket];
+        if (seen > rank)
+        {
+            uint64_t upper;
+
+            if (bucket < (1u << (BENCH_HIST_SUB_BITS + 1u)))
+            {
+                upper = bucket;
+            }
+            else
+            {
+                unsigned msb = (bucket >> BENCH_HIST_SUB_BITS) + BENCH_HIST_SUB_BITS - 1u;
+                unsigned sub = bucket & ((1u << BENCH_HIST_SUB_BITS) - 1u);
+                upper = (UINT64_C(1) << msb) + ((uint64_t)(sub + 1u) << (msb - BENCH_HIST_SUB_BITS)) - 1u;
+            }
+
+            return (upper < hist_csp->max_value) ? upper : hist_csp->max_value;
+        }
+    }
+
+    return hist_csp->max_value;
+}
+
+uint64_t bench_rng_next(uint64_t *state_u64p)
+{
+    uint64_t x = *state_u64p;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state_u64p = x;
+
+    return x * UINT64_C(0x2545F4914F6CDD1D);
+}
+
+void *bench_calloc(size_t count, size_t size)
+{
+    void *mem_p = calloc(count, size);
+
+    if (NULL == mem_p)
+    {
+        fprintf(stderr, "bench: out of memory (%zu x %zu bytes)\n", count, size);
+        exit(EXIT_FAILURE);
+    }
+
+    return mem_p;
+}
+
+bool bench_parse_format(char const *name_cp, bench_format_et *format_ep)
+{
+    if (0 == strcmp(name_cp, "console"))
+    {
+        *format_ep = BENCH_FORMAT_CONSOLE;
+    }
+    else if (0 == strcmp(name_cp, "csv"))
+    {
+        *format_ep = BENCH_FORMAT_CSV;
+    }
+    else if (0 == strcmp(name_cp, "json"))
+    {
+        *format_ep = BENCH_FORMAT_JSON;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool bench_match_option(char const *arg_cp, char const *name_cp, char const **value_cpp)
+{
+    size_t name_len = strlen(name_cp);
+
+    if ((0 != strncmp(arg_cp, name_cp, name_len)) || ('=' != arg_cp[name_len]))
+    {
+        return false;
+    }
+
+    *value_cpp = &arg_cp[name_len + 1u];
+    return true;
+}
+
+/**
+ * @brief Stable merge sort of trace records by timestamp.
+ */
+static void bench_trace_sort(buffer_trace_record_st *records_as,
+                             buffer_trace_record_st *scratch_as,
+                             size_t count)
+{
+    size_t half;
+    size_t left;
+    size_t right;
+    size_t out;
+
+    if (count < 2u)
+    {
+        return;
+    }
+
+    half = count / 2u;
+    bench_trace_sort(records_as, scratch_as, half);
+    bench_trace_sort(&records_as[half], scratch_as, count - half);
+
+    if (records_as[half - 1u].tsc <= records_as[half].tsc)
+    {
+        return;
+    }
+
+    memcpy(scratch_as, records_as, half * sizeof(*records_as));
+    left  = 0u;
+    right = half;
+    out   = 0u;
+
+    while ((left < half) && (right < count))
+    {
+        if (records_as[right].tsc < scratch_as[left].tsc)
+        {
+            records_as[out++] = records_as[right++];
+        }
+        else
+        {
+            records_as[out++] = scratch_as[left++];
+        }
+    }
+
+    while (left < half)
+    {
+        records_as[out++] = scratch_as[left++];
+    }
+}
+
+bool bench_trace_load(char const *path_cp, bench_trace_st *trace_sp)
+{
+    FILE                   *file_fp = fopen(path_cp, "rb");
+    buffer_trace_record_st *scratch_as;
+    long                    file_len;
+    size_t                  index;
+
+    memset(trace_sp, 0, sizeof(*trace_sp));
+
+    if (NULL == file_fp)
+    {
+        perror(path_cp);
+        return false;
+    }
+
+    if ((1u != fread(&trace_sp->header_s, sizeof(trace_sp->header_s), 1u, file_fp)) ||
+        (false == buffer_trace_header_is_valid(&trace_sp->header_s)))
+    {
+        fprintf(stderr, "%s: not a buffer-pool trace (or incompatible version)\n", path_cp);
+        fclose(file_fp);
+        return false;
+    }
+
+    (void)fseek(file_fp, 0, SEEK_END);
+    file_len = ftell(file_fp);
+    (void)fseek(file_fp, (long)sizeof(trace_sp->header_s), SEEK_SET);
+
+    trace_sp->record_count = ((size_t)file_len - sizeof(trace_sp->header_s)) / sizeof(buffer_trace_record_st);
+    trace_sp->records_as   = bench_calloc(trace_sp->record_count + 1u, sizeof(buffer_trace_record_st));
+
+    if (trace_sp->record_count != fread(trace_sp->records_as, sizeof(buffer_trace_record_st),
+                                        trace_sp->record_count, file_fp))
+    {
+        fprintf(stderr, "%s: short read\n", path_cp);
+        fclose(file_fp);
+        bench_trace_free(trace_sp);
+        return false;
+    }
+
+    fclose(file_fp);
+
+    scratch_as = bench_calloc((trace_sp->record_count / 2u) + 1u, sizeof(buffer_trace_record_st));
+    bench_trace_sort(trace_sp->records_as, scratch_as, trace_sp->record_count);
+    free(scratch_as);
+
+    for (index = 0u; index < trace_sp->record_count; ++index)
+    {
+        uint32_t buffer_index = trace_sp->records_as[index].index;
+
+        if ((BUFFER_TRACE_INDEX_NONE != buffer_index) && (buffer_index >= trace_sp->max_index))
+        {
+            trace_sp->max_index = buffer_index + 1u;
+        }
+    }
+
+    return true;
+}
+
+void bench_trace_free(bench_trace_st *trace_sp)
+{
+    free(trace_sp->records_as);
+    trace_sp->records_as   = NULL;
+    trace_sp->record_count = 0u;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file bench_util.h
+ * @brief Shared helpers for the buffer-pool benchmarks.
+ *
+ * Benchmarks are hosted (POSIX) programs. They are not part of the library
+ * and may use dynamic allocation and stdio freely.
+ */
+
+#ifndef BENCH_UTIL_H_
+#define BENCH_UTIL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "buffer_trace.h"
+
+/**
+ * @brief Output format of a benchmark report.
+ */
+typedef enum
+{
+    BENCH_FORMAT_CONSOLE = 0,        /**< Human-readable aligned table. */
+    BENCH_FORMAT_CSV,                /**< Comma-separated values with a header row. */
+    BENCH_FORMAT_JSON                /**< JSON document with a "benchmarks" array. */
+} bench_format_et;
+
+/** Number of buckets in a @ref bench_hist_st (covers the full uint64_t range). */
+#define BENCH_HIST_SUB_BITS      (3u)
+#define BENCH_HIST_BUCKETS       (((64u - BENCH_HIST_SUB_BITS) << BENCH_HIST_SUB_BITS) + (1u << (BENCH_HIST_SUB_BITS + 1u)))
+
+/**
+ * @brief Log-linear latency histogram.
+ *
+ * Values below 16 get exact buckets; above that each power of two is split
+ * into 8 linear sub-buckets, so the relative error is at most 12.5%.
+ */
+typedef struct
+{
+    uint64_t count_au64[BENCH_HIST_BUCKETS];
+    uint64_t total_count;
+    uint64_t max_value;
+} bench_hist_st;
+
+/**
+ * @brief Read a monotonic clock.
+ *
+ * @return Current monotonic time in nanoseconds.
+ */
+uint64_t bench_now_ns(void);
+
+/**
+ * @brief Read the cheapest available cycle counter.
+ *
+ * Uses RDTSC on x86 and CNTVCT_EL0 on AArch64, and falls back to
+ * @ref bench_now_ns elsewhere. Convert with @ref bench_ticks_per_ns.
+ *
+ * @return Current tick count.
+ */
+static inline uint64_t bench_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo_u32;
+    uint32_t hi_u32;
+    __asm__ __volatile__("rdtsc" : "=a"(lo_u32), "=d"(hi_u32));
+    return ((uint64_t)hi_u32 << 32) | lo_u32;
+#elif defined(__aarch64__)
+    uint64_t value_u64;
+    __asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(value_u64));
+    return value_u64;
+#else
+    return bench_now_ns();
+#endif
+}
+
+/**
+ * @brief Calibrate @ref bench_ticks against the monotonic clock.
+ *
+ * The first call spins for about 50 ms; later calls return the cached value.
+ *
+ * @return Ticks per nanosecond.
+ */
+double bench_ticks_per_ns(void);
+
+/**
+ * @brief Reset a histogram to empty.
+ */
+void bench_hist_reset(bench_hist_st *hist_sp);
+
+/**
+ * @brief Record one value in a histogram.
+ */
+static inline void bench_hist_record(bench_hist_st *hist_sp, uint64_t value_u64)
+{
+    unsigned bucket;
+
+    if (value_u64 < (UINT64_C(1) << (BENCH_HIST_SUB_BITS + 1u)))
+    {
+        bucket = (unsigned)value_u64;
+    }
+    else
+    {
+        unsigned msb = 63u - (unsigned)__builtin_clzll(value_u64);
+        unsigned sub = (unsigned)(value_u64 >> (msb - BENCH_HIST_SUB_BITS)) & ((1u << BENCH_HIST_SUB_BITS) - 1u);
+        bucket = ((msb - BENCH_HIST_SUB_BITS) << BENCH_HIST_SUB_BITS) + (1u << BENCH_HIST_SUB_BITS) + sub;
+    }
+
+    hist_sp->count_au64[bucket]++;
+    hist_sp->total_count++;
+    if (value_u64 > hist_sp->max_value)
+    {
+        hist_sp->max_value = value_u64;
+    }
+}
+
+/**
+ * @brief Add all samples of @p src_csp into @p dst_sp.
+ */
+void bench_hist_merge(bench_hist_st *dst_sp, bench_hist_st const *src_csp);
+
+/**
+ * @brief Get the value at a percentile.
+ *
+ * @param[in] hist_csp  Histogram.
+ * @param[in] pct       Percentile in [0, 100].
+ *
+ * @return Upper bound of the bucket holding the percentile (clamped to the
+ *         maximum recorded value), or 0 for an empty histogram.
+ */
+uint64_t bench_hist_percentile(bench_hist_st const *hist_csp, double pct);
+
+/**
+ * @brief Advance a xorshift64* generator.
+ *
+ * @param[in,out] state_u64p  Generator state, must be non-zero.
+ *
+ * @return Next pseudo-random value.
+ */
+uint64_t bench_rng_next(uint64_t *state_u64p);
+
+/**
+ * @brief Allocate zeroed memory or abort the benchmark.
+ *
+ * @param[in] count  Number of elements.
+ * @param[in] size   Size of one element in bytes.
+ *
+ * @return Pointer to the allocated memory, never NULL.
+ */
+void *bench_calloc(size_t count, size_t size);
+
+/**
+ * @brief Parse a format name ("console", "csv" or "json").
+ *
+ * @param[in]  name_cp     Format name.
+ * @param[out] format_ep   Parsed format.
+ *
+ * @return true if @p name_cp names a known format.
+ */
+bool bench_parse_format(char const *name_cp, bench_format_et *format_ep);
+
+/**
+ * @brief Match a "--name=value" command line option.
+ *
+ * @param[in]  arg_cp     Command line argument.
+ * @param[in]  name_cp    Option name including the leading dashes.
+ * @param[out] value_cpp  Set to the value part on match.
+ *
+ * @return true if @p arg_cp is the option @p name_cp.
+ */
+bool bench_match_option(char const *arg_cp, char const *name_cp, char const **value_cpp);
+
+/**
+ * @brief Trace file loaded into memory.
+ */
+typedef struct
+{
+    buffer_trace_header_st  header_s;
+    buffer_trace_record_st *records_as;      /**< Records sorted by timestamp (stable). */
+    size_t                  record_count;
+    uint32_t                max_index;       /**< Largest buffer index in the trace + 1. */
+} bench_trace_st;
+
+/**
+ * @brief Load and sort a binary trace file.
+ *
+ * @param[in]  path_cp   Trace file path.
+ * @param[out] trace_sp  Loaded trace; free with @ref bench_trace_free.
+ *
+ * @return true on success; on failure a message is printed to stderr.
+ */
+bool bench_trace_load(char const *path_cp, bench_trace_st *trace_sp);
+
+/**
+ * @brief Release the memory of a loaded trace.
+ */
+void bench_trace_free(bench_trace_st *trace_sp);
+
+#endif /* BENCH_UTIL_H_ */
@@ -4,6 +4,94 @@
  */
 
 #include "buffer.h"
+#include "buffer_port.h"
+
+#include <string.h>
+
+#if (0 != BUFFER_CFG_TRACE)
+#include "buffer_trace.h"
+
+/** Record an operation if @p pool_csp is the pool being traced. */
+#define BUFFER_TRACE_RECORD(pool_csp, op_e, index)                                  \
+    do                                                                              \
+    {                                                                               \
+        if (BUFFER_PORT_UNLIKELY((pool_csp) == BUFFER_PORT_LOAD_RELAXED(&buffer_trace_pool_csp))) \
+        {                                                                           \
+            buffer_trace_emit((op_e), (uint32_t)(index));                           \
+        }                                                                           \
+    } while (0)
+#else
+#define BUFFER_TRACE_RECORD(pool_csp, op_e, index) do { } while (0)
+#endif
+
+#if (0 != BUFFER_CFG_FLIGHT)
+#include "buffer_flight.h"
+
+/** Append an operation to the calling thread's flight recorder ring. */
+#define BUFFER_FLIGHT_RECORD(pool_csp, op_e, index)                                 \
+    buffer_flight_emit((NULL != (pool_csp)) ? (pool_csp)->flight_id_u32 : 0u, (op_e), (uint32_t)(index))
+#else
+#define BUFFER_FLIGHT_RECORD(pool_csp, op_e, index) do { } while (0)
+#endif
+
+/** Hook for every pool operation: trace recorder and flight recorder. */
+#define BUFFER_TRACE(pool_csp, op_e, index)                                         \
+    do                                                                              \
+    {                                                                               \
+        BUFFER_TRACE_RECORD(pool_csp, op_e, index);                                 \
+        BUFFER_FLIGHT_RECORD(pool_csp, op_e, index);                                \
+    } while (0)
+
+#if (0 != BUFFER_CFG_STATS)
+static uint32_t                           buffer_stats_next_shard_u32;  /**< Round-robin shard assignment. */
+static BUFFER_PORT_THREAD_LOCAL uint32_t  buffer_stats_shard_u32;       /**< Shard of this thread plus one, 0 if unassigned. */
+
+/** Add @p n to one counter of the calling thread's shard, if stats are attached. */
+#define BUFFER_STATS_ADD(pool_csp, field, n)                                        \
+    do                                                                              \
+    {                                                                               \
+        buffer_pool_stats_st *stats_sp_ = buffer_pool_stats_of(pool_csp);           \
+        if (NULL != stats_sp_)                                                      \
+        {                                                                           \
+            buffer_pool_stats_shard_st *shard_sp_ = buffer_stats_shard(stats_sp_);  \
+            BUFFER_PORT_STORE_RELAXED(&shard_sp_->field,                            \
+                                      shard_sp_->field + (uint64_t)(n));            \
+        }                                                                           \
+    } while (0)
+#else
+#define BUFFER_STATS_ADD(pool_csp, field, n) do { } while (0)
+#endif
+
+#if (0 != BUFFER_CFG_USDT)
+#include "buffer_sdt.h"
+
+/** Fire USDT probe @p name with the pool, a buffer index and the free count. */
+#define BUFFER_SDT(name, pool_csp, index) \
+    BUFFER_SDT_PROBE3(buffer_pool, name, (uintptr_t)(pool_csp), (index), buffer_sdt_free_count(pool_csp))
+#else
+#define BUFFER_SDT(name, pool_csp, index) do { } while (0)
+#endif
+
+#if (0 != BUFFER_CFG_HOLD_TIME)
+#define BUFFER_HOLD_TAG_SHIFT    (56u)
+#define BUFFER_HOLD_VALID        (UINT64_C(1) << 55)       /**< Stamp holds an acquire time. */
+#define BUFFER_HOLD_TICKS_MASK   (BUFFER_HOLD_VALID - 1u)  /**< Ticks kept in a stamp (wrap-safe). */
+#define BUFFER_HOLD_SUB_COUNT    (1u << BUFFER_HOLD_SUB_BITS)
+#endif
+
+#if (0 != BUFFER_CFG_FIND_SIMD) && defined(__GNUC__) && defined(__x86_64__)
+#define BUFFER_FIND_X86          (1)
+#include <immintrin.h>
+#else
+#define BUFFER_FIND_X86          (0)
+#endif
+
+#if (0 != BUFFER_CFG_FIND_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#define BUFFER_FIND_NEON         (1)
+#include <arm_neon.h>
+#else
+#define BUFFER_FIND_NEON         (0)
+#endif
 
 /* -------------------------------------------------------------------------- */
 /* Static Functions                                                           */
@@ -18,183 +106,1890 @@
  */
 static bool buffer_is_valid(buffer_st const *buffer_csp)
 {
-    return ((NULL != buffer_csp) && (true == buffer_csp->is_initialized));
+    return ((NULL != buffer_csp) && (true == buffer_csp->is_initialized));
+}
+
+/**
+ * @brief Check if a pool is not NULL, initialized, and has a descriptor array.
+ *
+ * @param[in] pool_csp  Pointer to pool object (could be NULL).
+ *
+ * @return true if @p pool_csp and its array are valid and initialized.
+ */
+static bool buffer_pool_is_valid(buffer_pool_st const *pool_csp)
+{
+    return ((NULL != pool_csp)                  &&
+            (true == pool_csp->is_initialized)  &&
+            (NULL != pool_csp->buffer_array_sa) &&
+            (0u   < pool_csp->buffer_count));
+}
+
+/**
+ * @brief Check if the buffer at @p index of a pool is free.
+ *
+ * With epoch stamps attached, a buffer last stamped before the current
+ * epoch was freed by a bulk reset, whatever its flag says.
+ */
+static bool buffer_pool_slot_is_free(buffer_pool_st const *pool_csp, size_t index)
+{
+#if (0 != BUFFER_CFG_EPOCH_RESET)
+    if ((NULL != pool_csp->epoch_au32) && (pool_csp->epoch_au32[index] != pool_csp->epoch_u32))
+    {
+        return true;
+    }
+#endif
+    return pool_csp->buffer_array_sa[index].is_available;
+}
+
+/**
+ * @brief Set the state of the buffer at @p index and stamp it with the
+ *        current epoch.
+ */
+static void buffer_pool_slot_set(buffer_pool_st *pool_sp, size_t index, bool is_free)
+{
+    pool_sp->buffer_array_sa[index].is_available = is_free;
+#if (0 != BUFFER_CFG_EPOCH_RESET)
+    if (NULL != pool_sp->epoch_au32)
+    {
+        pool_sp->epoch_au32[index] = pool_sp->epoch_u32;
+    }
+#endif
+}
+
+#if (0 != BUFFER_CFG_EPOCH_RESET)
+
+/**
+ * @brief Write the epoch state back to the flags and stamp every buffer
+ *        with @p epoch_u32.
+ */
+static void buffer_epoch_sync(buffer_pool_st *pool_sp, uint32_t epoch_u32)
+{
+    size_t index;
+
+    for (index = 0u; index < pool_sp->buffer_count; ++index)
+    {
+        if (true == buffer_is_valid(&pool_sp->buffer_array_sa[index]))
+        {
+            pool_sp->buffer_array_sa[index].is_available = buffer_pool_slot_is_free(pool_sp, index);
+        }
+        pool_sp->epoch_au32[index] = epoch_u32;
+    }
+}
+
+#endif /* BUFFER_CFG_EPOCH_RESET */
+
+#if (0 != BUFFER_CFG_STATS)
+
+/**
+ * @brief Get the statistics attached to a pool.
+ *
+ * @param[in] pool_csp  Pointer to pool object (could be NULL).
+ *
+ * @return Attached statistics, or NULL.
+ */
+static buffer_pool_stats_st *buffer_pool_stats_of(buffer_pool_st const *pool_csp)
+{
+    return (NULL != pool_csp) ? pool_csp->stats_sp : NULL;
+}
+
+/**
+ * @brief Get the counter shard of the calling thread.
+ *
+ * Two threads only share a shard when more than @c BUFFER_CFG_STATS_SHARDS
+ * threads use the library; counters are then approximate.
+ */
+static buffer_pool_stats_shard_st *buffer_stats_shard(buffer_pool_stats_st *stats_sp)
+{
+#if defined(BUFFER_CFG_STATS_SHARD_ID)
+    return &stats_sp->shard_as[(uint32_t)BUFFER_CFG_STATS_SHARD_ID() % BUFFER_CFG_STATS_SHARDS];
+#else
+    uint32_t shard = buffer_stats_shard_u32;
+
+    if (BUFFER_PORT_UNLIKELY(0u == shard))
+    {
+        shard = (BUFFER_PORT_FETCH_ADD(&buffer_stats_next_shard_u32, 1u) % BUFFER_CFG_STATS_SHARDS) + 1u;
+        buffer_stats_shard_u32 = shard;
+    }
+
+    return &stats_sp->shard_as[shard - 1u];
+#endif
+}
+
+/**
+ * @brief Publish new occupancy values (seqlock write side).
+ *
+ * Called under the pool's single-writer rule.
+ */
+static void buffer_stats_occupancy_set(buffer_pool_stats_st *stats_sp, size_t in_use, size_t high_water)
+{
+    uint32_t seq = stats_sp->seq_u32;
+
+    BUFFER_PORT_STORE_RELAXED(&stats_sp->seq_u32, seq + 1u);
+    BUFFER_PORT_FENCE_RELEASE();
+    BUFFER_PORT_STORE_RELAXED(&stats_sp->in_use, in_use);
+    BUFFER_PORT_STORE_RELAXED(&stats_sp->high_water, high_water);
+    BUFFER_PORT_STORE_RELEASE(&stats_sp->seq_u32, seq + 2u);
+}
+
+/**
+ * @brief Read the occupancy values consistently (seqlock read side).
+ *
+ * @param[out] seq_u32p  Sequence number the values belong to.
+ *
+ * @return false, with both values 0, if no attempt out of
+ *         @c BUFFER_CFG_STATS_READ_RETRIES saw a completed update.
+ */
+static bool buffer_stats_occupancy_get(buffer_pool_stats_st const *stats_csp,
+                                       size_t *in_use_p,
+                                       size_t *high_water_p,
+                                       uint32_t *seq_u32p)
+{
+    uint32_t attempt;
+
+    for (attempt = 0u; attempt < BUFFER_CFG_STATS_READ_RETRIES; ++attempt)
+    {
+        uint32_t seq = BUFFER_PORT_LOAD_ACQUIRE(&stats_csp->seq_u32);
+
+        if (0u == (seq & 1u))
+        {
+            *in_use_p     = BUFFER_PORT_LOAD_RELAXED(&stats_csp->in_use);
+            *high_water_p = BUFFER_PORT_LOAD_RELAXED(&stats_csp->high_water);
+            BUFFER_PORT_FENCE_ACQUIRE();
+
+            if (seq == BUFFER_PORT_LOAD_RELAXED(&stats_csp->seq_u32))
+            {
+                *seq_u32p = seq;
+                return true;
+            }
+        }
+    }
+
+    /* Writer gone (or stalled) mid-update: report rather than spin. */
+    *in_use_p     = 0u;
+    *high_water_p = 0u;
+    *seq_u32p     = 0u;
+    return false;
+}
+
+/**
+ * @brief Account for one buffer leaving or returning to the free set.
+ *
+ * Called under the pool's single-writer rule.
+ */
+static void buffer_stats_in_use_add(buffer_pool_st const *pool_csp, bool is_acquire)
+{
+    buffer_pool_stats_st *stats_sp = buffer_pool_stats_of(pool_csp);
+    size_t                in_use;
+    size_t                high_water;
+
+    if (NULL == stats_sp)
+    {
+        return;
+    }
+
+    in_use     = stats_sp->in_use;
+    high_water = stats_sp->high_water;
+    if (true == is_acquire)
+    {
+        ++in_use;
+        if (in_use > high_water)
+        {
+            high_water = in_use;
+        }
+    }
+    else if (0u < in_use)
+    {
+        --in_use;
+    }
+    else
+    {
+        /* Buffer was marked in use outside the pool API. */
+    }
+
+    buffer_stats_occupancy_set(stats_sp, in_use, high_water);
+}
+
+#endif /* BUFFER_CFG_STATS */
+
+#if (0 != BUFFER_CFG_USDT)
+
+/**
+ * @brief Free buffer count passed to the USDT probes.
+ *
+ * @return Free count from the attached statistics, or -1 without them.
+ */
+static inline int64_t buffer_sdt_free_count(buffer_pool_st const *pool_csp)
+{
+#if (0 != BUFFER_CFG_STATS)
+    if ((NULL != pool_csp) && (NULL != pool_csp->stats_sp))
+    {
+        return (int64_t)pool_csp->buffer_count - (int64_t)pool_csp->stats_sp->in_use;
+    }
+#else
+    (void)pool_csp;
+#endif
+    return -1;
+}
+
+#endif /* BUFFER_CFG_USDT */
+
+#if (0 != BUFFER_CFG_HOLD_TIME)
+
+/**
+ * @brief Histogram bucket of a hold time.
+ */
+static uint32_t buffer_hold_bucket(uint64_t ticks)
+{
+    uint32_t msb;
+
+    if (ticks < BUFFER_HOLD_SUB_COUNT)
+    {
+        return (uint32_t)ticks;
+    }
+
+    msb = buffer_port_msb64(ticks);
+    return ((msb - (BUFFER_HOLD_SUB_BITS - 1u)) << BUFFER_HOLD_SUB_BITS) +
+           (uint32_t)((ticks >> (msb - BUFFER_HOLD_SUB_BITS)) & (BUFFER_HOLD_SUB_COUNT - 1u));
+}
+
+/**
+ * @brief Largest hold time that falls in a bucket.
+ */
+static uint64_t buffer_hold_bucket_upper(uint32_t bucket)
+{
+    uint32_t group = bucket >> BUFFER_HOLD_SUB_BITS;
+    uint64_t sub   = bucket & (BUFFER_HOLD_SUB_COUNT - 1u);
+
+    if (0u == group)
+    {
+        return sub;
+    }
+
+    return ((BUFFER_HOLD_SUB_COUNT + sub + 1u) << (group - 1u)) - 1u;
+}
+
+/**
+ * @brief Stamp a buffer with the acquire time and tag.
+ *
+ * Called under the pool's single-writer rule.
+ */
+static void buffer_hold_start(buffer_pool_st const *pool_csp, size_t index, uint32_t tag)
+{
+    buffer_pool_hold_st *hold_sp = pool_csp->hold_sp;
+
+    if (NULL == hold_sp)
+    {
+        return;
+    }
+
+    if (tag >= hold_sp->tag_count)
+    {
+        tag = 0u;
+    }
+
+    hold_sp->stamp_au64[index] = ((uint64_t)tag << BUFFER_HOLD_TAG_SHIFT) |
+                                 BUFFER_HOLD_VALID                        |
+                                 (buffer_port_ticks() & BUFFER_HOLD_TICKS_MASK);
+}
+
+/**
+ * @brief Record the hold time of a buffer being released.
+ *
+ * Called under the pool's single-writer rule.
+ */
+static void buffer_hold_stop(buffer_pool_st const *pool_csp, size_t index)
+{
+    buffer_pool_hold_st *hold_sp = pool_csp->hold_sp;
+    buffer_hold_hist_st *hist_sp;
+    uint64_t             stamp;
+    uint64_t             ticks;
+    uint32_t             bucket;
+
+    if (NULL == hold_sp)
+    {
+        return;
+    }
+
+    stamp = hold_sp->stamp_au64[index];
+    if (0u == (stamp & BUFFER_HOLD_VALID))
+    {
+        return;
+    }
+    hold_sp->stamp_au64[index] = 0u;
+
+    ticks   = (buffer_port_ticks() - stamp) & BUFFER_HOLD_TICKS_MASK;
+    hist_sp = &hold_sp->hist_as[stamp >> BUFFER_HOLD_TAG_SHIFT];
+    bucket  = buffer_hold_bucket(ticks);
+
+    BUFFER_PORT_STORE_RELAXED(&hist_sp->count_au64[bucket], hist_sp->count_au64[bucket] + 1u);
+    BUFFER_PORT_STORE_RELAXED(&hist_sp->sum_ticks, hist_sp->sum_ticks + ticks);
+    if (ticks > hist_sp->max_ticks)
+    {
+        BUFFER_PORT_STORE_RELAXED(&hist_sp->max_ticks, ticks);
+    }
+    BUFFER_PORT_STORE_RELAXED(&hist_sp->total_count, hist_sp->total_count + 1u);
+}
+
+#endif /* BUFFER_CFG_HOLD_TIME */
+
+#if (0 != BUFFER_CFG_PROFILE)
+
+/**
+ * @brief Record the owner of a newly acquired buffer, one acquire in period.
+ *
+ * Called under the pool's single-writer rule. Only sampled acquires touch
+ * the sample table; the others just clear the descriptor's flag, on the
+ * line acquire has already written, so a sample left behind by an earlier
+ * owner is never attributed to the current one.
+ */
+static void buffer_profile_sample(buffer_pool_st const *pool_csp, buffer_st *buffer_sp, size_t index, uintptr_t site)
+{
+    buffer_pool_profile_st *profile_sp = pool_csp->profile_sp;
+
+    if (NULL == profile_sp)
+    {
+        return;
+    }
+
+    if (0u != --profile_sp->countdown)
+    {
+        BUFFER_PORT_STORE_RELAXED(&buffer_sp->is_sampled, false);
+        return;
+    }
+
+    profile_sp->countdown = profile_sp->period;
+
+    BUFFER_PORT_STORE_RELAXED(&profile_sp->sample_as[index].ticks, buffer_port_ticks());
+    BUFFER_PORT_STORE_RELAXED(&profile_sp->sample_as[index].site, site);
+    BUFFER_PORT_STORE_RELEASE(&buffer_sp->is_sampled, true);
+}
+
+#endif /* BUFFER_CFG_PROFILE */
+
+#if (0 != BUFFER_CFG_POLICY)
+
+#define BUFFER_POLICY_NONE       (SIZE_MAX)  /**< No free buffer. */
+
+/**
+ * @brief Mark a buffer free in the LOWEST bitmap.
+ *
+ * A word that was empty becomes non-empty, so its bit is set one level up.
+ */
+static void buffer_policy_bit_set(buffer_pool_policy_st *policy_sp, size_t index)
+{
+    uint32_t level;
+    size_t   bit = index;
+
+    for (level = 0u; level < policy_sp->level_count_u32; ++level)
+    {
+        uint64_t *word_u64p = &policy_sp->bitmap_au64[policy_sp->level_start_au32[level] + (bit >> 6)];
+        bool      was_empty = (0u == *word_u64p);
+
+        *word_u64p |= (UINT64_C(1) << (bit & 63u));
+        if (false == was_empty)
+        {
+            break;
+        }
+        bit >>= 6;
+    }
+}
+
+/**
+ * @brief Mark a buffer in use in the LOWEST bitmap.
+ */
+static void buffer_policy_bit_clear(buffer_pool_policy_st *policy_sp, size_t index)
+{
+    uint32_t level;
+    size_t   bit = index;
+
+    for (level = 0u; level < policy_sp->level_count_u32; ++level)
+    {
+        uint64_t *word_u64p = &policy_sp->bitmap_au64[policy_sp->level_start_au32[level] + (bit >> 6)];
+
+        *word_u64p &= ~(UINT64_C(1) << (bit & 63u));
+        if (0u != *word_u64p)
+        {
+            break;
+        }
+        bit >>= 6;
+    }
+}
+
+/**
+ * @brief Lowest free index in the LOWEST bitmap: one word per level.
+ */
+static size_t buffer_policy_bit_lowest(buffer_pool_policy_st const *policy_csp)
+{
+    uint32_t level = policy_csp->level_count_u32;
+    size_t   bit   = 0u;
+
+    if (0u == policy_csp->bitmap_au64[policy_csp->level_start_au32[level - 1u]])
+    {
+        return BUFFER_POLICY_NONE;
+    }
+
+    while (0u < level)
+    {
+        --level;
+        bit = (bit << 6) | buffer_port_lsb64(policy_csp->bitmap_au64[policy_csp->level_start_au32[level] + bit]);
+    }
+
+    return bit;
+}
+
+/**
+ * @brief Index the next acquire will take, without taking it.
+ */
+static size_t buffer_policy_peek(buffer_pool_policy_st const *policy_csp)
+{
+    if (0u == policy_csp->free_count)
+    {
+        return BUFFER_POLICY_NONE;
+    }
+
+    switch (policy_csp->policy_e)
+    {
+        case BUFFER_POLICY_LIFO:
+            return policy_csp->index_au32[policy_csp->free_count - 1u];
+
+        case BUFFER_POLICY_FIFO:
+            return policy_csp->index_au32[policy_csp->head];
+
+        case BUFFER_POLICY_LOWEST:
+            return buffer_policy_bit_lowest(policy_csp);
+
+        default:
+            return BUFFER_POLICY_NONE;
+    }
+}
+
+/**
+ * @brief Take the next free index out of the policy.
+ */
+static size_t buffer_policy_take(buffer_pool_policy_st *policy_sp, size_t buffer_count)
+{
+    size_t index = buffer_policy_peek(policy_sp);
+
+    if (BUFFER_POLICY_NONE == index)
+    {
+        return BUFFER_POLICY_NONE;
+    }
+
+    if (BUFFER_POLICY_FIFO == policy_sp->policy_e)
+    {
+        policy_sp->head++;
+        if (policy_sp->head == buffer_count)
+        {
+            policy_sp->head = 0u;
+        }
+    }
+    else if (BUFFER_POLICY_LOWEST == policy_sp->policy_e)
+    {
+        buffer_policy_bit_clear(policy_sp, index);
+    }
+    else
+    {
+        /* LIFO: dropping the count pops the stack. */
+    }
+
+    policy_sp->free_count--;
+    return index;
+}
+
+/**
+ * @brief Hand a released index back to the policy.
+ *
+ * LIFO and FIFO may then hold an index twice, if it was marked in use
+ * while queued; take drops the copy that is no longer free.
+ */
+static void buffer_policy_put(buffer_pool_policy_st *policy_sp, size_t buffer_count, size_t index)
+{
+    size_t slot;
+
+    switch (policy_sp->policy_e)
+    {
+        case BUFFER_POLICY_LIFO:
+            policy_sp->index_au32[policy_sp->free_count] = (uint32_t)index;
+            break;
+
+        case BUFFER_POLICY_FIFO:
+            slot = policy_sp->head + policy_sp->free_count;
+            if (slot >= buffer_count)
+            {
+                slot -= buffer_count;
+            }
+            policy_sp->index_au32[slot] = (uint32_t)index;
+            break;
+
+        case BUFFER_POLICY_LOWEST:
+            /* Already queued: the bitmap cannot hold it twice. */
+            if (0u != (policy_sp->bitmap_au64[policy_sp->level_start_au32[0] + (index >> 6)] &
+                       (UINT64_C(1) << (index & 63u))))
+            {
+                return;
+            }
+            buffer_policy_bit_set(policy_sp, index);
+            break;
+
+        default:
+            return;
+    }
+
+    policy_sp->free_count++;
+}
+
+/**
+ * @brief Reload the policy from the descriptors' free flags.
+ */
+static void buffer_policy_rebuild(buffer_pool_st const *pool_csp)
+{
+    buffer_pool_policy_st *policy_sp = pool_csp->policy_sp;
+    size_t                 index;
+
+    policy_sp->head       = 0u;
+    policy_sp->free_count = 0u;
+
+    if (BUFFER_POLICY_LOWEST == policy_sp->policy_e)
+    {
+        memset(policy_sp->bitmap_au64, 0,
+               buffer_pool_policy_work_bytes(BUFFER_POLICY_LOWEST, pool_csp->buffer_count));
+    }
+
+    /* LIFO pops the last push, so push from the top to hand out index 0 first. */
+    for (index = pool_csp->buffer_count; index > 0u; --index)
+    {
+        size_t     current = (BUFFER_POLICY_LIFO == policy_sp->policy_e) ? (index - 1u)
+                                                                          : (pool_csp->buffer_count - index);
+        buffer_st *current_sp = &pool_csp->buffer_array_sa[current];
+
+        if ((true == buffer_is_valid(current_sp)) && (true == buffer_pool_slot_is_free(pool_csp, current)))
+        {
+            buffer_policy_put(policy_sp, pool_csp->buffer_count, current);
+        }
+    }
+}
+
+/**
+ * @brief Queue a buffer that just became free.
+ *
+ * Copies left behind by marking queued buffers in use could fill the
+ * stack or ring; then rebuild it from the free flags instead.
+ */
+static void buffer_policy_return(buffer_pool_st const *pool_csp, size_t index)
+{
+    if (pool_csp->policy_sp->free_count >= pool_csp->buffer_count)
+    {
+        buffer_policy_rebuild(pool_csp);
+    }
+    else
+    {
+        buffer_policy_put(pool_csp->policy_sp, pool_csp->buffer_count, index);
+    }
+}
+
+#endif /* BUFFER_CFG_POLICY */
+
+#if (0 != BUFFER_CFG_FIND_SIMD)
+
+/**
+ * @brief Scalar search of the attached pointer array.
+ *
+ * @return First index in [@p index, @p count) holding @p target, or @p count.
+ */
+static size_t buffer_find_addr_scalar(uintptr_t const *addr_au, size_t index, size_t count, uintptr_t target)
+{
+    for (; index < count; ++index)
+    {
+        if (addr_au[index] == target)
+        {
+            break;
+        }
+    }
+
+    return index;
+}
+
+/**
+ * @brief Scalar search of the descriptors' data pointers (the original loop).
+ */
+static size_t buffer_find_desc_scalar(buffer_st const *array_csa, size_t index, size_t count, uintptr_t target)
+{
+    for (; index < count; ++index)
+    {
+        if ((uintptr_t)array_csa[index].data_u8p == target)
+        {
+            break;
+        }
+    }
+
+    return index;
+}
+
+#if (0 != BUFFER_FIND_X86)
+
+/* The gather addresses descriptors in 8-byte units. */
+typedef char buffer_find_stride_check[(0u == (sizeof(buffer_st) % sizeof(uint64_t))) ? 1 : -1];
+
+/** 0 = unknown, 1 = SSE2, 2 = AVX2. */
+static int buffer_find_level;
+
+static int buffer_find_level_get(void)
+{
+    int level = BUFFER_PORT_LOAD_RELAXED(&buffer_find_level);
+
+    if (0 == level)
+    {
+        __builtin_cpu_init();
+        level = (0 != __builtin_cpu_supports("avx2")) ? 2 : 1;
+        BUFFER_PORT_STORE_RELAXED(&buffer_find_level, level);
+    }
+
+    return level;
+}
+
+/**
+ * @brief SSE2: 4 pointers per step.
+ *
+ * SSE2 has no 64-bit compare; a lane matches when both of its 32-bit
+ * halves do.
+ */
+static size_t buffer_find_addr_sse2(uintptr_t const *addr_au, size_t index, size_t count, uintptr_t target)
+{
+    __m128i const key_v = _mm_set1_epi64x((long long)target);
+
+    for (; (index + 4u) <= count; index += 4u)
+    {
+        __m128i lo_v = _mm_cmpeq_epi32(_mm_loadu_si128((__m128i const *)(void const *)&addr_au[index]), key_v);
+        __m128i hi_v = _mm_cmpeq_epi32(_mm_loadu_si128((__m128i const *)(void const *)&addr_au[index + 2u]), key_v);
+        int     mask;
+
+        lo_v = _mm_and_si128(lo_v, _mm_shuffle_epi32(lo_v, _MM_SHUFFLE(2, 3, 0, 1)));
+        hi_v = _mm_and_si128(hi_v, _mm_shuffle_epi32(hi_v, _MM_SHUFFLE(2, 3, 0, 1)));
+        mask = _mm_movemask_pd(_mm_castsi128_pd(lo_v)) | (_mm_movemask_pd(_mm_castsi128_pd(hi_v)) << 2);
+
+        if (0 != mask)
+        {
+            return index + buffer_port_lsb64((uint64_t)mask);
+        }
+    }
+
+    return buffer_find_addr_scalar(addr_au, index, count, target);
+}
+
+/**
+ * @brief AVX2: 8 pointers per step.
+ */
+__attribute__((target("avx2")))
+static size_t buffer_find_addr_avx2(uintptr_t const *addr_au, size_t index, size_t count, uintptr_t target)
+{
+    __m256i const key_v = _mm256_set1_epi64x((long long)target);
+
+    for (; (index + 8u) <= count; index += 8u)
+    {
+        __m256i lo_v = _mm256_loadu_si256((__m256i const *)(void const *)&addr_au[index]);
+        __m256i hi_v = _mm256_loadu_si256((__m256i const *)(void const *)&addr_au[index + 4u]);
+        int     mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lo_v, key_v))) |
+                       (_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(hi_v, key_v))) << 4);
+
+        if (0 != mask)
+        {
+            return index + buffer_port_lsb64((uint64_t)mask);
+        }
+    }
+
+    return buffer_find_addr_scalar(addr_au, index, count, target);
+}
+
+/**
+ * @brief AVX2 without a pointer array: gather 8 data pointers per step
+ *        straight from the descriptors.
+ */
+__attribute__((target("avx2")))
+static size_t buffer_find_desc_avx2(buffer_st const *array_csa, size_t index, size_t count, uintptr_t target)
+{
+    long long const stride  = (long long)(sizeof(buffer_st) / sizeof(uint64_t));
+    __m256i const   key_v   = _mm256_set1_epi64x((long long)target);
+    __m256i const   vidx_v  = _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+
+    for (; (index + 8u) <= count; index += 8u)
+    {
+        __m256i lo_v = _mm256_i64gather_epi64((long long const *)(void const *)&array_csa[index].data_u8p, vidx_v, 8);
+        __m256i hi_v = _mm256_i64gather_epi64((long long const *)(void const *)&array_csa[index + 4u].data_u8p, vidx_v, 8);
+        int     mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lo_v, key_v))) |
+                       (_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(hi_v, key_v))) << 4);
+
+        if (0 != mask)
+        {
+            return index + buffer_port_lsb64((uint64_t)mask);
+        }
+    }
+
+    return buffer_find_desc_scalar(array_csa, index, count, target);
+}
+
+#endif /* BUFFER_FIND_X86 */
+
+#if (0 != BUFFER_FIND_NEON)
+
+/**
+ * @brief NEON: 4 pointers per step.
+ */
+static size_t buffer_find_addr_neon(uintptr_t const *addr_au, size_t index, size_t count, uintptr_t target)
+{
+    uint64x2_t const key_v = vdupq_n_u64((uint64_t)target);
+
+    for (; (index + 4u) <= count; index += 4u)
+    {
+        uint64_t const *lane_u64p = (uint64_t const *)(void const *)&addr_au[index];
+        uint64x2_t      any_v     = vorrq_u64(vceqq_u64(vld1q_u64(lane_u64p), key_v),
+                                              vceqq_u64(vld1q_u64(&lane_u64p[2]), key_v));
+
+        if (0u != (vgetq_lane_u64(any_v, 0) | vgetq_lane_u64(any_v, 1)))
+        {
+            break;
+        }
+    }
+
+    return buffer_find_addr_scalar(addr_au, index, count, target);
+}
+
+#endif /* BUFFER_FIND_NEON */
+
+/**
+ * @brief Next candidate index for @ref buffer_pool_find.
+ *
+ * @return First index in [@p index, @c buffer_count) whose data pointer is
+ *         @p target, or @c buffer_count. The caller checks the descriptor.
+ */
+static size_t buffer_find_next(buffer_pool_st const *pool_csp, size_t index, uintptr_t target)
+{
+    uintptr_t const *addr_au = pool_csp->find_addr_au;
+    size_t const     count   = pool_csp->buffer_count;
+
+    if (NULL != addr_au)
+    {
+#if (0 != BUFFER_FIND_X86)
+        return (2 == buffer_find_level_get()) ? buffer_find_addr_avx2(addr_au, index, count, target)
+                                              : buffer_find_addr_sse2(addr_au, index, count, target);
+#elif (0 != BUFFER_FIND_NEON)
+        return buffer_find_addr_neon(addr_au, index, count, target);
+#else
+        return buffer_find_addr_scalar(addr_au, index, count, target);
+#endif
+    }
+
+#if (0 != BUFFER_FIND_X86)
+    if (2 == buffer_find_level_get())
+    {
+        return buffer_find_desc_avx2(pool_csp->buffer_array_sa, index, count, target);
+    }
+#endif
+
+    return buffer_find_desc_scalar(pool_csp->buffer_array_sa, index, count, target);
+}
+
+#endif /* BUFFER_CFG_FIND_SIMD */
+
+#if (0 != BUFFER_CFG_PREFETCH_LINES)
+
+/**
+ * @brief Prefetch the first data lines of a buffer whose descriptor is
+ *        already in cache, so that reading its pointer and capacity does
+ *        not stall.
+ */
+static void buffer_pool_prefetch_data(buffer_st const *buffer_csp)
+{
+    size_t line;
+
+    for (line = 0u; (line < BUFFER_CFG_PREFETCH_LINES) &&
+                    ((line * BUFFER_CFG_CACHE_LINE) < buffer_csp->capacity_bytes); ++line)
+    {
+        BUFFER_PORT_PREFETCH_WRITE(&buffer_csp->data_u8p[line * BUFFER_CFG_CACHE_LINE]);
+    }
+}
+
+/**
+ * @brief Prefetch the buffer the next acquire will return.
+ *
+ * With a reuse policy the next buffer is known exactly, but its descriptor
+ * has not been touched, so only the descriptor is prefetched. Otherwise
+ * acquire hands out the lowest free buffer, so unless a lower one is
+ * released in between, the next acquire returns the first free buffer
+ * after @p index; only a short window is examined so that acquire stays
+ * cheap when the free buffers are far away. The scan reads each visited
+ * descriptor anyway, so the data lines of the one it stops at are
+ * prefetched as well. A buffer found free through a stale epoch stamp was
+ * not read and gets the descriptor prefetch only.
+ */
+static void buffer_pool_prefetch_next(buffer_pool_st const *pool_csp, size_t index)
+{
+#if (0 != BUFFER_CFG_POLICY)
+    if (NULL != pool_csp->policy_sp)
+    {
+        size_t next = buffer_policy_peek(pool_csp->policy_sp);
+
+        if (next < pool_csp->buffer_count)
+        {
+            BUFFER_PORT_PREFETCH_WRITE(&pool_csp->buffer_array_sa[next]);
+        }
+    }
+    else
+#endif
+    {
+        size_t end = index + 1u + BUFFER_CFG_PREFETCH_LOOKAHEAD;
+        size_t candidate;
+
+        if (end > pool_csp->buffer_count)
+        {
+            end = pool_csp->buffer_count;
+        }
+
+        for (candidate = index + 1u; candidate < end; ++candidate)
+        {
+            buffer_st const *candidate_csp = &pool_csp->buffer_array_sa[candidate];
+
+#if (0 != BUFFER_CFG_EPOCH_RESET)
+            if ((NULL != pool_csp->epoch_au32) &&
+                (pool_csp->epoch_au32[candidate] != pool_csp->epoch_u32))
+            {
+                BUFFER_PORT_PREFETCH_WRITE(candidate_csp);
+                break;
+            }
+#endif
+            if (true == candidate_csp->is_available)
+            {
+                buffer_pool_prefetch_data(candidate_csp);
+                break;
+            }
+        }
+    }
+}
+
+#endif /* BUFFER_CFG_PREFETCH_LINES */
+
+/**
+ * @brief Hand out the free buffer at @p index and run the acquire hooks.
+ *
+ * @param[in] steps  Descriptors visited to find it (statistics only).
+ */
+static buffer_st *buffer_pool_acquire_at(buffer_pool_st *pool_sp,
+                                         size_t index,
+                                         size_t steps,
+                                         uint32_t tag,
+                                         uintptr_t site)
+{
+    buffer_st *buffer_sp = &pool_sp->buffer_array_sa[index];
+
+    (void)steps;
+    (void)tag;
+    (void)site;
+
+    buffer_pool_slot_set(pool_sp, index, false);
+    BUFFER_STATS_ADD(pool_sp, acquires, 1u);
+    BUFFER_STATS_ADD(pool_sp, scan_steps, steps);
+#if (0 != BUFFER_CFG_STATS)
+    buffer_stats_in_use_add(pool_sp, true);
+#endif
+#if (0 != BUFFER_CFG_HOLD_TIME)
+    buffer_hold_start(pool_sp, index, tag);
+#endif
+#if (0 != BUFFER_CFG_PROFILE)
+    buffer_profile_sample(pool_sp, buffer_sp, index, site);
+#endif
+#if (0 != BUFFER_CFG_PREFETCH_LINES)
+    buffer_pool_prefetch_next(pool_sp, index);
+#endif
+    BUFFER_TRACE(pool_sp, BUFFER_TRACE_OP_ACQUIRE, index);
+    BUFFER_SDT(acquire, pool_sp, index);
+#if (0 != BUFFER_CFG_USDT) && (0 != BUFFER_CFG_STATS)
+    if (0 == buffer_sdt_free_count(pool_sp))
+    {
+        BUFFER_SDT(pool_exhausted, pool_sp, index);
+    }
+#endif
+    return buffer_sp;
+}
+
+/**
+ * @brief Acquire the next free buffer of a pool, in the order of its policy.
+ *
+ * @param[in,out] pool_sp  Pointer to pool object (could be NULL).
+ * @param[in]     tag      Hold-time tag (ignored without BUFFER_CFG_HOLD_TIME).
+ * @param[in]     site     Owner recorded by the profiler (ignored without BUFFER_CFG_PROFILE).
+ */
+static buffer_st *buffer_pool_acquire_first(buffer_pool_st *pool_sp, uint32_t tag, uintptr_t site)
+{
+    size_t index;
+
+    if (false == buffer_pool_is_valid(pool_sp))
+    {
+        return NULL;
+    }
+
+#if (0 != BUFFER_CFG_POLICY)
+    if (NULL != pool_sp->policy_sp)
+    {
+        size_t steps = 0u;
+
+        /* Drop entries marked in use behind the policy's back. */
+        while (BUFFER_POLICY_NONE != (index = buffer_policy_take(pool_sp->policy_sp, pool_sp->buffer_count)))
+        {
+            ++steps;
+            if ((true == buffer_is_valid(&pool_sp->buffer_array_sa[index])) &&
+                (true == buffer_pool_slot_is_free(pool_sp, index)))
+            {
+                return buffer_pool_acquire_at(pool_sp, index, steps, tag, site);
+            }
+        }
+    }
+    else
+#endif
+    {
+        for (index = 0u; index < pool_sp->buffer_count; ++index)
+        {
+            buffer_st *current_sp = &pool_sp->buffer_array_sa[index];
+
+            if ((true == buffer_is_valid(current_sp)) &&
+                (true == buffer_pool_slot_is_free(pool_sp, index)))
+            {
+                return buffer_pool_acquire_at(pool_sp, index, index + 1u, tag, site);
+            }
+        }
+    }
+
+    BUFFER_STATS_ADD(pool_sp, failed_acquires, 1u);
+    BUFFER_STATS_ADD(pool_sp, scan_steps, pool_sp->buffer_count);
+    BUFFER_TRACE(pool_sp, BUFFER_TRACE_OP_ACQUIRE_FAIL, BUFFER_TRACE_INDEX_NONE);
+    BUFFER_SDT(acquire_fail, pool_sp, -1);
+    return NULL;
+}
+
+/**
+ * @brief Release path shared by the release functions, once the descriptor
+ *        is known to belong to the pool.
+ */
+static void buffer_pool_release_found(buffer_pool_st *pool_sp, buffer_st *buffer_sp)
+{
+    size_t const index    = (size_t)(buffer_sp - pool_sp->buffer_array_sa);
+    bool const   was_free = buffer_pool_slot_is_free(pool_sp, index);
+
+    (void)was_free;   /* Only used by the optional hooks. */
+
+#if (0 != BUFFER_CFG_STATS)
+    if (true == was_free)
+    {
+        BUFFER_STATS_ADD(pool_sp, invalid_releases, 1u);
+    }
+    else
+    {
+        BUFFER_STATS_ADD(pool_sp, releases, 1u);
+        buffer_stats_in_use_add(pool_sp, false);
+    }
+#endif
+#if (0 != BUFFER_CFG_HOLD_TIME)
+    /* Stamps of buffers freed by an epoch reset are stale: skip them. */
+    if (false == was_free)
+    {
+        buffer_hold_stop(pool_sp, index);
+    }
+#endif
+
+    buffer_pool_slot_set(pool_sp, index, true);
+#if (0 != BUFFER_CFG_POLICY)
+    /* A second release of a free buffer must not queue it twice. */
+    if ((NULL != pool_sp->policy_sp) && (false == was_free))
+    {
+        buffer_policy_return(pool_sp, index);
+    }
+#endif
+    BUFFER_TRACE(pool_sp, BUFFER_TRACE_OP_RELEASE, index);
+    BUFFER_SDT(release, pool_sp, index);
+}
+
+/**
+ * @brief Descriptor of a context buffer found from its offset in the block.
+ *
+ * @return Descriptor whose data pointer is @p memory_u8p, or NULL if the
+ *         pointer is not the start of a buffer at its initial place.
+ */
+static buffer_st *buffer_array_slot_of(buffer_array_ctx_st *ctx_sp, uint8_t const *memory_u8p)
+{
+    uintptr_t  offset = (uintptr_t)memory_u8p - (uintptr_t)ctx_sp->memory_block_u8p;
+    buffer_st *buffer_sp;
+
+    if ((NULL == memory_u8p) || ((uintptr_t)memory_u8p < (uintptr_t)ctx_sp->memory_block_u8p) ||
+        (0u != (offset % ctx_sp->buffer_size)) || ((offset / ctx_sp->buffer_size) >= ctx_sp->buffer_count))
+    {
+        return NULL;
+    }
+
+    buffer_sp = &ctx_sp->buffer_array_sa[offset / ctx_sp->buffer_size];
+    return ((true == buffer_is_valid(buffer_sp)) && (memory_u8p == buffer_sp->data_u8p)) ? buffer_sp : NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Single buffer API                                                          */
+/* -------------------------------------------------------------------------- */
+
+void buffer_init(buffer_st *buffer_sp, uint8_t *memory_u8p, size_t capacity_bytes)
+{
+    if (NULL == buffer_sp)
+    {
+        return;
+    }
+
+    buffer_sp->data_u8p       = memory_u8p;
+    buffer_sp->capacity_bytes = capacity_bytes;
+    buffer_sp->is_initialized = true;
+#if (0 != BUFFER_CFG_PROFILE)
+    buffer_sp->is_sampled     = false;
+#endif
+
+    if ((NULL != memory_u8p) && (0u != capacity_bytes))
+    {
+        buffer_sp->is_available = true;
+    }
+    else
+    {
+        buffer_sp->is_available = false;
+    }
+}
+
+uint8_t *buffer_data(buffer_st const *buffer_csp, size_t *capacity_bytes_out_p)
+{
+    if (NULL != capacity_bytes_out_p)
+    {
+        if (true == buffer_is_valid(buffer_csp))
+        {
+            *capacity_bytes_out_p = buffer_csp->capacity_bytes;
+        }
+        else
+        {
+            *capacity_bytes_out_p = 0u;
+        }
+    }
+
+    if (true == buffer_is_valid(buffer_csp))
+    {
+        return buffer_csp->data_u8p;
+    }
+
+    return NULL;
+}
+
+void buffer_mark_free(buffer_st *buffer_sp)
+{
+    if (true == buffer_is_valid(buffer_sp))
+    {
+        buffer_sp->is_available = true;
+    }
+}
+
+void buffer_mark_in_use(buffer_st *buffer_sp)
+{
+    if (true == buffer_is_valid(buffer_sp))
+    {
+        buffer_sp->is_available = false;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Pool API                                                                   */
+/* -------------------------------------------------------------------------- */
+
+void buffer_pool_init(buffer_pool_st *pool_sp, buffer_st *buffer_array_sa, size_t buffer_count)
+{
+    if ((NULL == pool_sp) || (NULL == buffer_array_sa) || (0u == buffer_count))
+    {
+        return;
+    }
+
+    pool_sp->buffer_array_sa = buffer_array_sa;
+    pool_sp->buffer_count    = buffer_count;
+    pool_sp->is_initialized  = true;
+
+#if (0 != BUFFER_CFG_STATS)
+    pool_sp->stats_sp        = NULL;
+#endif
+#if (0 != BUFFER_CFG_HOLD_TIME)
+    pool_sp->hold_sp         = NULL;
+#endif
+#if (0 != BUFFER_CFG_PROFILE)
+    pool_sp->profile_sp      = NULL;
+#endif
+#if (0 != BUFFER_CFG_POLICY)
+    pool_sp->policy_sp       = NULL;
+#endif
+#if (0 != BUFFER_CFG_FIND_SIMD)
+    pool_sp->find_addr_au    = NULL;
+#endif
+#if (0 != BUFFER_CFG_EPOCH_RESET)
+    pool_sp->epoch_au32      = NULL;
+    pool_sp->epoch_u32       = 0u;
+#endif
+#if (0 != BUFFER_CFG_FLIGHT)
+    pool_sp->flight_id_u32   = buffer_flight_pool_register(pool_sp);
+#endif
+}
+
+buffer_st *buffer_pool_acquire(buffer_pool_st *pool_sp)
+{
+    return buffer_pool_acquire_first(pool_sp, 0u, BUFFER_PORT_RETURN_ADDRESS());
+}
+
+buffer_st *buffer_pool_find(buffer_pool_st *pool_sp, uint8_t *memory_u8p)
+{
+    size_t index;
+
+    if ((false == buffer_pool_is_valid(pool_sp)) || (NULL == memory_u8p))
+    {
+        return NULL;
+    }
+
+#if (0 != BUFFER_CFG_FIND_SIMD)
+    for (index = buffer_find_next(pool_sp, 0u, (uintptr_t)memory_u8p);
+         index < pool_sp->buffer_count;
+         index = buffer_find_next(pool_sp, index + 1u, (uintptr_t)memory_u8p))
+    {
+        buffer_st *current_sp = &pool_sp->buffer_array_sa[index];
+
+        /* The hit may come from a stale address copy: confirm it. */
+        if ((true == buffer_is_valid(current_sp)) &&
+            (current_sp->data_u8p == memory_u8p))
+        {
+            BUFFER_STATS_ADD(pool_sp, scan_steps, index + 1u);
+            return current_sp;
+        }
+    }
+#else
+    for (index = 0u; index < pool_sp->buffer_count; ++index)
+    {
+        buffer_st *current_sp = &pool_sp->buffer_array_sa[index];
+
+        if ((true == buffer_is_valid(current_sp)) &&
+            (current_sp->data_u8p == memory_u8p))
+        {
+            BUFFER_STATS_ADD(pool_sp, scan_steps, index + 1u);
+            return current_sp;
+        }
+    }
+#endif
+
+    BUFFER_STATS_ADD(pool_sp, scan_steps, pool_sp->buffer_count);
+    return NULL;
+}
+
+bool buffer_pool_release_by_ptr(buffer_pool_st *pool_sp, uint8_t *memory_u8p)
+{
+    buffer_st *buffer_sp = buffer_pool_find(pool_sp, memory_u8p);
+
+    if (NULL == buffer_sp)
+    {
+        if (NULL == memory_u8p)
+        {
+            BUFFER_STATS_ADD(pool_sp, invalid_releases, 1u);
+        }
+        else
+        {
+            BUFFER_STATS_ADD(pool_sp, foreign_releases, 1u);
+            BUFFER_SDT(foreign_release, pool_sp, -1);
+        }
+        BUFFER_TRACE(pool_sp, BUFFER_TRACE_OP_RELEASE_INVALID, BUFFER_TRACE_INDEX_NONE);
+        return false;
+    }
+
+    buffer_pool_release_found(pool_sp, buffer_sp);
+    return true;
+}
+
+bool buffer_pool_release(buffer_pool_st *pool_sp, buffer_st *buffer_sp)
+{
+    if ((false == buffer_pool_is_valid(pool_sp))                                         ||
+        (NULL == buffer_sp)                                                              ||
+        (buffer_sp < pool_sp->buffer_array_sa)                                           ||
+        ((size_t)(buffer_sp - pool_sp->buffer_array_sa) >= pool_sp->buffer_count)         ||
+        (false == buffer_is_valid(buffer_sp)))
+    {
+        return false;
+    }
+
+    buffer_pool_release_found(pool_sp, buffer_sp);
+    return true;
+}
+
+void buffer_pool_mark_all_free(buffer_pool_st *pool_sp)
+{
+    size_t index;
+
+    if (false == buffer_pool_is_valid(pool_sp))
+    {
+        return;
+    }
+
+#if (0 != BUFFER_CFG_EPOCH_RESET)
+    /* Every stamp is now older than the epoch. Only when the epoch wraps
+     * could an old stamp match again: then fall through to the flags. */
+    if ((NULL != pool_sp->epoch_au32) && (BUFFER_PORT_LIKELY(UINT32_MAX != pool_sp->epoch_u32)))
+    {
+        pool_sp->epoch_u32++;
+    }
+    else
+#endif
+    {
+        for (index = 0u; index < pool_sp->buffer_count; ++index)
+        {
+            buffer_st *current_sp = &pool_sp->buffer_array_sa[index];
+
+            if (true == buffer_is_valid(current_sp))
+            {
+                current_sp->is_available = true;
+            }
+        }
+
+#if (0 != BUFFER_CFG_EPOCH_RESET)
+        if (NULL != pool_sp->epoch_au32)
+        {
+            pool_sp->epoch_u32 = 0u;
+            memset(pool_sp->epoch_au32, 0, pool_sp->buffer_count * sizeof(uint32_t));
+        }
+#endif
+
+#if (0 != BUFFER_CFG_HOLD_TIME)
+        /* Buffers freed in bulk have no meaningful hold time. */
+        if (NULL != pool_sp->hold_sp)
+        {
+            memset(pool_sp->hold_sp->stamp_au64, 0, pool_sp->buffer_count * sizeof(uint64_t));
+        }
+#endif
+
+#if (0 != BUFFER_CFG_PROFILE)
+        if (NULL != pool_sp->profile_sp)
+        {
+            memset(pool_sp->profile_sp->sample_as, 0, pool_sp->buffer_count * sizeof(buffer_pool_sample_st));
+        }
+#endif
+    }
+
+#if (0 != BUFFER_CFG_STATS)
+    if (NULL != pool_sp->stats_sp)
+    {
+        buffer_stats_occupancy_set(pool_sp->stats_sp, 0u, pool_sp->stats_sp->high_water);
+    }
+#endif
+
+#if (0 != BUFFER_CFG_POLICY)
+    if (NULL != pool_sp->policy_sp)
+    {
+        buffer_policy_rebuild(pool_sp);
+    }
+#endif
+
+    BUFFER_TRACE(pool_sp, BUFFER_TRACE_OP_MARK_ALL_FREE, BUFFER_TRACE_INDEX_NONE);
+}
+
+/**
+ * @brief Set the state of one buffer of the pool through the epoch-aware
+ *        slot helper.
+ */
+static void buffer_pool_mark(buffer_pool_st *pool_sp, buffer_st *buffer_sp, bool is_free)
+{
+    size_t index;
+    bool   was_free;
+
+    if ((false == buffer_pool_is_valid(pool_sp))                                        ||
+        (NULL == buffer_sp)                                                             ||
+        (buffer_sp < pool_sp->buffer_array_sa)                                          ||
+        ((size_t)(buffer_sp - pool_sp->buffer_array_sa) >= pool_sp->buffer_count)        ||
+        (false == buffer_is_valid(buffer_sp)))
+    {
+        return;
+    }
+
+    index    = (size_t)(buffer_sp - pool_sp->buffer_array_sa);
+    was_free = buffer_pool_slot_is_free(pool_sp, index);
+    (void)was_free;   /* Only used with a reuse policy. */
+
+    buffer_pool_slot_set(pool_sp, index, is_free);
+#if (0 != BUFFER_CFG_POLICY)
+    /* A buffer marked in use stays queued until acquire drops it. */
+    if ((NULL != pool_sp->policy_sp) && (true == is_free) && (false == was_free))
+    {
+        buffer_policy_return(pool_sp, index);
+    }
+#endif
+}
+
+void buffer_pool_mark_free(buffer_pool_st *pool_sp, buffer_st *buffer_sp)
+{
+    buffer_pool_mark(pool_sp, buffer_sp, true);
+}
+
+void buffer_pool_mark_in_use(buffer_pool_st *pool_sp, buffer_st *buffer_sp)
+{
+    buffer_pool_mark(pool_sp, buffer_sp, false);
+}
+
+#if (0 != BUFFER_CFG_STATS)
+
+/* -------------------------------------------------------------------------- */
+/* Pool statistics API                                                        */
+/* -------------------------------------------------------------------------- */
+
+void buffer_pool_stats_attach(buffer_pool_st *pool_sp, buffer_pool_stats_st *stats_sp)
+{
+    size_t index;
+
+    if (false == buffer_pool_is_valid(pool_sp))
+    {
+        return;
+    }
+
+    if (NULL != stats_sp)
+    {
+        memset(stats_sp, 0, sizeof(*stats_sp));
+
+        /* Start from the buffers already in use. */
+        for (index = 0u; index < pool_sp->buffer_count; ++index)
+        {
+            buffer_st const *current_csp = &pool_sp->buffer_array_sa[index];
+
+            if ((true == buffer_is_valid(current_csp)) &&
+                (false == buffer_pool_slot_is_free(pool_sp, index)))
+            {
+                ++stats_sp->in_use;
+            }
+        }
+        stats_sp->high_water = stats_sp->in_use;
+    }
+
+    BUFFER_PORT_STORE_RELEASE(&pool_sp->stats_sp, stats_sp);
+}
+
+bool buffer_pool_stats_sum(buffer_pool_stats_st const *stats_csp, buffer_pool_counters_st *counters_sp)
+{
+    uint32_t shard;
+    uint32_t seq;
+
+    if ((NULL == stats_csp) || (NULL == counters_sp))
+    {
+        return false;
+    }
+
+    memset(counters_sp, 0, sizeof(*counters_sp));
+
+    for (shard = 0u; shard < BUFFER_CFG_STATS_SHARDS; ++shard)
+    {
+        buffer_pool_stats_shard_st const *shard_csp = &stats_csp->shard_as[shard];
+
+        counters_sp->acquires         += BUFFER_PORT_LOAD_RELAXED(&shard_csp->acquires);
+        counters_sp->failed_acquires  += BUFFER_PORT_LOAD_RELAXED(&shard_csp->failed_acquires);
+        counters_sp->releases         += BUFFER_PORT_LOAD_RELAXED(&shard_csp->releases);
+        counters_sp->invalid_releases += BUFFER_PORT_LOAD_RELAXED(&shard_csp->invalid_releases);
+        counters_sp->foreign_releases += BUFFER_PORT_LOAD_RELAXED(&shard_csp->foreign_releases);
+        counters_sp->scan_steps       += BUFFER_PORT_LOAD_RELAXED(&shard_csp->scan_steps);
+    }
+
+    counters_sp->occupancy_valid = buffer_stats_occupancy_get(stats_csp, &counters_sp->in_use,
+                                                              &counters_sp->high_water, &seq);
+    return counters_sp->occupancy_valid;
+}
+
+bool buffer_pool_stats_read(buffer_pool_st const *pool_csp, buffer_pool_counters_st *counters_sp)
+{
+    buffer_pool_stats_st *stats_sp;
+
+    if ((false == buffer_pool_is_valid(pool_csp)) || (NULL == counters_sp))
+    {
+        return false;
+    }
+
+    stats_sp = BUFFER_PORT_LOAD_ACQUIRE(&pool_csp->stats_sp);
+    if (NULL == stats_sp)
+    {
+        return false;
+    }
+
+    (void)buffer_pool_stats_sum(stats_sp, counters_sp);
+    return true;
 }
 
-/**
- * @brief Check if a pool is not NULL, initialized, and has a descriptor array.
- *
- * @param[in] pool_csp  Pointer to pool object (could be NULL).
- *
- * @return true if @p pool_csp and its array are valid and initialized.
- */
-static bool buffer_pool_is_valid(buffer_pool_st const *pool_csp)
+bool buffer_pool_snapshot(buffer_pool_st const *pool_csp, buffer_pool_snapshot_st *snapshot_sp)
 {
-    return ((NULL != pool_csp)                  &&
-            (true == pool_csp->is_initialized)  &&
-            (NULL != pool_csp->buffer_array_sa) &&
-            (0u   < pool_csp->buffer_count));
+    buffer_pool_stats_st *stats_sp;
+
+    if ((false == buffer_pool_is_valid(pool_csp)) || (NULL == snapshot_sp))
+    {
+        return false;
+    }
+
+    stats_sp = BUFFER_PORT_LOAD_ACQUIRE(&pool_csp->stats_sp);
+    if (NULL == stats_sp)
+    {
+        return false;
+    }
+
+    if (false == buffer_stats_occupancy_get(stats_sp, &snapshot_sp->in_use,
+                                            &snapshot_sp->high_water, &snapshot_sp->seq_u32))
+    {
+        return false;
+    }
+
+    snapshot_sp->buffer_count = pool_csp->buffer_count;
+    snapshot_sp->free_count   = (snapshot_sp->in_use < pool_csp->buffer_count) ?
+                                (pool_csp->buffer_count - snapshot_sp->in_use) : 0u;
+
+    return true;
 }
 
+#endif /* BUFFER_CFG_STATS */
+
+#if (0 != BUFFER_CFG_HOLD_TIME)
+
 /* -------------------------------------------------------------------------- */
-/* Single buffer API                                                          */
+/* Hold time API                                                              */
 /* -------------------------------------------------------------------------- */
 
-void buffer_init(buffer_st *buffer_sp, uint8_t *memory_u8p, size_t capacity_bytes)
+bool buffer_pool_hold_attach(buffer_pool_st *pool_sp,
+                             buffer_pool_hold_st *hold_sp,
+                             uint64_t *stamp_au64,
+                             buffer_hold_hist_st *hist_as,
+                             uint32_t tag_count)
 {
-    if (NULL == buffer_sp)
+    if (false == buffer_pool_is_valid(pool_sp))
     {
-        return;
+        return false;
     }
 
-    buffer_sp->data_u8p       = memory_u8p;
-    buffer_sp->capacity_bytes = capacity_bytes;
-    buffer_sp->is_initialized = true;
-
-    if ((NULL != memory_u8p) && (0u != capacity_bytes))
+    if (NULL == hold_sp)
     {
-        buffer_sp->is_available = true;
+        pool_sp->hold_sp = NULL;
+        return true;
     }
-    else
+
+    if ((NULL == stamp_au64) || (NULL == hist_as) ||
+        (0u == tag_count) || (BUFFER_HOLD_MAX_TAGS < tag_count))
     {
-        buffer_sp->is_available = false;
+        return false;
     }
+
+    memset(stamp_au64, 0, pool_sp->buffer_count * sizeof(uint64_t));
+    memset(hist_as, 0, tag_count * sizeof(buffer_hold_hist_st));
+
+    hold_sp->stamp_au64 = stamp_au64;
+    hold_sp->hist_as    = hist_as;
+    hold_sp->tag_count  = tag_count;
+
+    BUFFER_PORT_STORE_RELEASE(&pool_sp->hold_sp, hold_sp);
+    return true;
 }
 
-uint8_t *buffer_data(buffer_st const *buffer_csp, size_t *capacity_bytes_out_p)
+buffer_st *buffer_pool_acquire_tagged(buffer_pool_st *pool_sp, uint32_t tag)
 {
-    if (NULL != capacity_bytes_out_p)
+    return buffer_pool_acquire_first(pool_sp, tag, BUFFER_PORT_RETURN_ADDRESS());
+}
+
+bool buffer_pool_hold_read(buffer_pool_st const *pool_csp, uint32_t tag, buffer_pool_hold_summary_st *summary_sp)
+{
+    static double const  pct_ad[4] = { 0.50, 0.90, 0.99, 0.999 };
+    uint64_t            *out_apu64[4];
+    buffer_pool_hold_st *hold_sp;
+    uint64_t             counts_au64[BUFFER_HOLD_BUCKETS];
+    uint64_t             sum = 0u;
+    uint64_t             seen;
+    uint32_t             first;
+    uint32_t             last;
+    uint32_t             bucket;
+    uint32_t             pct;
+
+    if ((false == buffer_pool_is_valid(pool_csp)) || (NULL == summary_sp))
     {
-        if (true == buffer_is_valid(buffer_csp))
+        return false;
+    }
+
+    hold_sp = BUFFER_PORT_LOAD_ACQUIRE(&pool_csp->hold_sp);
+    if ((NULL == hold_sp) || ((BUFFER_HOLD_ALL_TAGS != tag) && (tag >= hold_sp->tag_count)))
+    {
+        return false;
+    }
+
+    first = (BUFFER_HOLD_ALL_TAGS == tag) ? 0u : tag;
+    last  = (BUFFER_HOLD_ALL_TAGS == tag) ? (hold_sp->tag_count - 1u) : tag;
+
+    memset(summary_sp, 0, sizeof(*summary_sp));
+    memset(counts_au64, 0, sizeof(counts_au64));
+
+    /* Merge the selected histograms; the count is taken from the buckets. */
+    for (; first <= last; ++first)
+    {
+        buffer_hold_hist_st const *hist_csp = &hold_sp->hist_as[first];
+        uint64_t                   max_ticks = BUFFER_PORT_LOAD_RELAXED(&hist_csp->max_ticks);
+
+        for (bucket = 0u; bucket < BUFFER_HOLD_BUCKETS; ++bucket)
         {
-            *capacity_bytes_out_p = buffer_csp->capacity_bytes;
+            uint64_t count = BUFFER_PORT_LOAD_RELAXED(&hist_csp->count_au64[bucket]);
+
+            counts_au64[bucket] += count;
+            summary_sp->count   += count;
         }
-        else
+
+        sum += BUFFER_PORT_LOAD_RELAXED(&hist_csp->sum_ticks);
+        if (max_ticks > summary_sp->max_ticks)
         {
-            *capacity_bytes_out_p = 0u;
+            summary_sp->max_ticks = max_ticks;
         }
     }
 
-    if (true == buffer_is_valid(buffer_csp))
+    if (0u == summary_sp->count)
     {
-        return buffer_csp->data_u8p;
+        return true;
     }
 
-    return NULL;
+    summary_sp->mean_ticks = sum / summary_sp->count;
+
+    out_apu64[0] = &summary_sp->p50_ticks;
+    out_apu64[1] = &summary_sp->p90_ticks;
+    out_apu64[2] = &summary_sp->p99_ticks;
+    out_apu64[3] = &summary_sp->p999_ticks;
+
+    seen   = 0u;
+    bucket = 0u;
+    for (pct = 0u; pct < 4u; ++pct)
+    {
+        uint64_t rank = (uint64_t)(pct_ad[pct] * (double)summary_sp->count);
+
+        if (rank >= summary_sp->count)
+        {
+            rank = summary_sp->count - 1u;
+        }
+
+        while ((seen + counts_au64[bucket]) <= rank)
+        {
+            seen += counts_au64[bucket];
+            ++bucket;
+        }
+
+        *out_apu64[pct] = buffer_hold_bucket_upper(bucket);
+        if (*out_apu64[pct] > summary_sp->max_ticks)
+        {
+            *out_apu64[pct] = summary_sp->max_ticks;
+        }
+    }
+
+    return true;
 }
 
-void buffer_mark_free(buffer_st *buffer_sp)
+#endif /* BUFFER_CFG_HOLD_TIME */
+
+#if (0 != BUFFER_CFG_PROFILE)
+
+/* -------------------------------------------------------------------------- */
+/* Ownership profiler API                                                     */
+/* -------------------------------------------------------------------------- */
+
+bool buffer_pool_profile_attach(buffer_pool_st *pool_sp,
+                                buffer_pool_profile_st *profile_sp,
+                                buffer_pool_sample_st *sample_as,
+                                uint32_t period)
 {
-    if (true == buffer_is_valid(buffer_sp))
+    if (false == buffer_pool_is_valid(pool_sp))
     {
-        buffer_sp->is_available = true;
+        return false;
+    }
+
+    if (NULL == profile_sp)
+    {
+        pool_sp->profile_sp = NULL;
+        return true;
+    }
+
+    if ((NULL == sample_as) || (0u == period))
+    {
+        return false;
     }
+
+    memset(sample_as, 0, pool_sp->buffer_count * sizeof(buffer_pool_sample_st));
+
+    profile_sp->sample_as = sample_as;
+    profile_sp->period    = period;
+    profile_sp->countdown = period;
+
+    BUFFER_PORT_STORE_RELEASE(&pool_sp->profile_sp, profile_sp);
+    return true;
 }
 
-void buffer_mark_in_use(buffer_st *buffer_sp)
+buffer_st *buffer_pool_acquire_site(buffer_pool_st *pool_sp, uintptr_t site)
 {
-    if (true == buffer_is_valid(buffer_sp))
+    return buffer_pool_acquire_first(pool_sp, 0u, site);
+}
+
+size_t buffer_pool_dump_outstanding(buffer_pool_st const *pool_csp,
+                                    buffer_pool_site_st *sites_as,
+                                    size_t max_sites)
+{
+    buffer_pool_profile_st *profile_sp;
+    uint64_t                now;
+    size_t                  site_count = 0u;
+    size_t                  index;
+    size_t                  slot;
+
+    if ((false == buffer_pool_is_valid(pool_csp)) || (NULL == sites_as) || (0u == max_sites))
     {
-        buffer_sp->is_available = false;
+        return 0u;
+    }
+
+    profile_sp = BUFFER_PORT_LOAD_ACQUIRE(&pool_csp->profile_sp);
+    if (NULL == profile_sp)
+    {
+        return 0u;
+    }
+
+    now = buffer_port_ticks();
+
+    for (index = 0u; index < pool_csp->buffer_count; ++index)
+    {
+        buffer_pool_sample_st const *sample_csp = &profile_sp->sample_as[index];
+        uintptr_t                    site;
+        uint64_t                     age;
+
+        /* A free buffer or one whose current owner was not sampled may
+         * still carry the sample of an earlier owner. */
+        if ((true == buffer_pool_slot_is_free(pool_csp, index)) ||
+            (false == BUFFER_PORT_LOAD_ACQUIRE(&pool_csp->buffer_array_sa[index].is_sampled)))
+        {
+            continue;
+        }
+
+        site = BUFFER_PORT_LOAD_RELAXED(&sample_csp->site);
+        if (0u == site)
+        {
+            continue;
+        }
+
+        age = now - BUFFER_PORT_LOAD_RELAXED(&sample_csp->ticks);
+
+        for (slot = 0u; (slot < site_count) && (sites_as[slot].site != site); ++slot)
+        {
+        }
+
+        if (slot == site_count)
+        {
+            if (site_count == max_sites)
+            {
+                continue;
+            }
+
+            memset(&sites_as[slot], 0, sizeof(sites_as[slot]));
+            sites_as[slot].site = site;
+            ++site_count;
+        }
+
+        sites_as[slot].sampled        += 1u;
+        sites_as[slot].mean_age_ticks += age;  /* Sum until the final pass. */
+        if (age > sites_as[slot].max_age_ticks)
+        {
+            sites_as[slot].max_age_ticks = age;
+        }
+    }
+
+    /* Insertion sort, most buffers first. */
+    for (slot = 0u; slot < site_count; ++slot)
+    {
+        buffer_pool_site_st site_s = sites_as[slot];
+        size_t              pos    = slot;
+
+        site_s.estimated       = site_s.sampled * profile_sp->period;
+        site_s.mean_age_ticks /= site_s.sampled;
+
+        while ((0u < pos) && (sites_as[pos - 1u].sampled < site_s.sampled))
+        {
+            sites_as[pos] = sites_as[pos - 1u];
+            --pos;
+        }
+        sites_as[pos] = site_s;
     }
+
+    return site_count;
 }
 
+#endif /* BUFFER_CFG_PROFILE */
+
+#if (0 != BUFFER_CFG_POLICY)
+
 /* -------------------------------------------------------------------------- */
-/* Pool API                                                                   */
+/* Reuse policy API                                                           */
 /* -------------------------------------------------------------------------- */
 
-void buffer_pool_init(buffer_pool_st *pool_sp, buffer_st *buffer_array_sa, size_t buffer_count)
+size_t buffer_pool_policy_work_bytes(buffer_policy_et policy_e, size_t buffer_count)
 {
-    if ((NULL == pool_sp) || (NULL == buffer_array_sa) || (0u == buffer_count))
+    size_t   words = 0u;
+    size_t   level_words;
+    uint32_t level;
+
+    if ((0u == buffer_count) || (buffer_count >= UINT32_MAX))
     {
-        return;
+        return 0u;
     }
 
-    pool_sp->buffer_array_sa = buffer_array_sa;
-    pool_sp->buffer_count    = buffer_count;
-    pool_sp->is_initialized  = true;
+    switch (policy_e)
+    {
+        case BUFFER_POLICY_LIFO:
+        case BUFFER_POLICY_FIFO:
+            return buffer_count * sizeof(uint32_t);
+
+        case BUFFER_POLICY_LOWEST:
+            level_words = buffer_count;
+            for (level = 0u; level < BUFFER_POLICY_LEVELS; ++level)
+            {
+                level_words = (level_words + 63u) / 64u;
+                words      += level_words;
+                if (1u == level_words)
+                {
+                    return words * sizeof(uint64_t);
+                }
+            }
+            return 0u;   /* More than 64^BUFFER_POLICY_LEVELS buffers. */
+
+        default:
+            return 0u;
+    }
 }
 
-buffer_st *buffer_pool_acquire(buffer_pool_st *pool_sp)
+bool buffer_pool_policy_attach(buffer_pool_st *pool_sp,
+                               buffer_pool_policy_st *policy_sp,
+                               buffer_policy_et policy_e,
+                               void *work_p)
 {
-    size_t index;
+    size_t   level_words;
+    uint32_t start = 0u;
 
     if (false == buffer_pool_is_valid(pool_sp))
     {
-        return NULL;
+        return false;
     }
 
-    for (index = 0u; index < pool_sp->buffer_count; ++index)
+    /* SCAN needs no state: detach. */
+    if ((NULL == policy_sp) || (BUFFER_POLICY_SCAN == policy_e))
     {
-        buffer_st *current_sp = &pool_sp->buffer_array_sa[index];
+        pool_sp->policy_sp = NULL;
+        return true;
+    }
 
-        if ((true == buffer_is_valid(current_sp)) &&
-            (true == current_sp->is_available))
+    if ((NULL == work_p) || (0u != ((uintptr_t)work_p % sizeof(uint64_t))) ||
+        (0u == buffer_pool_policy_work_bytes(policy_e, pool_sp->buffer_count)))
+    {
+        return false;
+    }
+
+    memset(policy_sp, 0, sizeof(*policy_sp));
+    policy_sp->policy_e = policy_e;
+
+    if (BUFFER_POLICY_LOWEST == policy_e)
+    {
+        policy_sp->bitmap_au64 = (uint64_t *)work_p;
+        level_words            = pool_sp->buffer_count;
+        do
         {
-            current_sp->is_available = false;
-            return current_sp;
-        }
+            level_words = (level_words + 63u) / 64u;
+            policy_sp->level_start_au32[policy_sp->level_count_u32] = start;
+            policy_sp->level_count_u32++;
+            start += (uint32_t)level_words;
+        } while (1u < level_words);
+    }
+    else
+    {
+        policy_sp->index_au32 = (uint32_t *)work_p;
     }
 
-    return NULL;
+    pool_sp->policy_sp = policy_sp;
+    buffer_policy_rebuild(pool_sp);
+    return true;
 }
 
-buffer_st *buffer_pool_find(buffer_pool_st *pool_sp, uint8_t *memory_u8p)
+#endif /* BUFFER_CFG_POLICY */
+
+#if (0 != BUFFER_CFG_FIND_SIMD)
+
+/* -------------------------------------------------------------------------- */
+/* Vectorized find API                                                        */
+/* -------------------------------------------------------------------------- */
+
+bool buffer_pool_find_index_attach(buffer_pool_st *pool_sp, uintptr_t *addr_au)
 {
     size_t index;
 
-    if ((false == buffer_pool_is_valid(pool_sp)) || (NULL == memory_u8p))
+    if (false == buffer_pool_is_valid(pool_sp))
     {
-        return NULL;
+        return false;
     }
 
-    for (index = 0u; index < pool_sp->buffer_count; ++index)
+    if (NULL != addr_au)
     {
-        buffer_st *current_sp = &pool_sp->buffer_array_sa[index];
-
-        if ((true == buffer_is_valid(current_sp)) &&
-            (current_sp->data_u8p == memory_u8p))
+        /* Uninitialized descriptors get 0, which find never searches for. */
+        for (index = 0u; index < pool_sp->buffer_count; ++index)
         {
-            return current_sp;
+            buffer_st const *current_csp = &pool_sp->buffer_array_sa[index];
+
+            addr_au[index] = (true == buffer_is_valid(current_csp)) ? (uintptr_t)current_csp->data_u8p : 0u;
         }
     }
 
-    return NULL;
+    pool_sp->find_addr_au = addr_au;
+    return true;
 }
 
-bool buffer_pool_release_by_ptr(buffer_pool_st *pool_sp, uint8_t *memory_u8p)
-{
-    buffer_st *buffer_sp = buffer_pool_find(pool_sp, memory_u8p);
+#endif /* BUFFER_CFG_FIND_SIMD */
 
-    if (NULL == buffer_sp)
-    {
-        return false;
-    }
+#if (0 != BUFFER_CFG_EPOCH_RESET)
 
-    buffer_mark_free(buffer_sp);
-    return true;
-}
+/* -------------------------------------------------------------------------- */
+/* Epoch reset API                                                            */
+/* -------------------------------------------------------------------------- */
 
-void buffer_pool_mark_all_free(buffer_pool_st *pool_sp)
+bool buffer_pool_epoch_attach(buffer_pool_st *pool_sp, uint32_t *epoch_au32)
 {
     size_t index;
 
     if (false == buffer_pool_is_valid(pool_sp))
     {
-        return;
+        return false;
     }
 
-    for (index = 0u; index < pool_sp->buffer_count; ++index)
+    /* Leave the flags telling the truth for the code that reads them. */
+    if (NULL != pool_sp->epoch_au32)
     {
-        buffer_st *current_sp = &pool_sp->buffer_array_sa[index];
+        buffer_epoch_sync(pool_sp, pool_sp->epoch_u32);
+    }
 
-        if (true == buffer_is_valid(current_sp))
+    pool_sp->epoch_au32 = epoch_au32;
+    pool_sp->epoch_u32  = 0u;
+
+    if (NULL != epoch_au32)
+    {
+        for (index = 0u; index < pool_sp->buffer_count; ++index)
         {
-            current_sp->is_available = true;
+            epoch_au32[index] = 0u;
         }
     }
+
+    return true;
+}
+
+bool buffer_pool_is_free(buffer_pool_st const *pool_csp, buffer_st const *buffer_csp)
+{
+    if ((false == buffer_pool_is_valid(pool_csp))                                         ||
+        (NULL == buffer_csp)                                                              ||
+        (buffer_csp < pool_csp->buffer_array_sa)                                          ||
+        ((size_t)(buffer_csp - pool_csp->buffer_array_sa) >= pool_csp->buffer_count)       ||
+        (false == buffer_is_valid(buffer_csp)))
+    {
+        return false;
+    }
+
+    return buffer_pool_slot_is_free(pool_csp, (size_t)(buffer_csp - pool_csp->buffer_array_sa));
 }
 
+#endif /* BUFFER_CFG_EPOCH_RESET */
+
 /* -------------------------------------------------------------------------- */
 /* Buffer array context API                                                   */
 /* -------------------------------------------------------------------------- */
@@ -239,25 +2034,45 @@ buffer_st *buffer_array_acquire(buffer_array_ctx_st *ctx_sp)
         return NULL;
     }
 
-    return buffer_pool_acquire(&ctx_sp->pool_s);
+    return buffer_pool_acquire_first(&ctx_sp->pool_s, 0u, BUFFER_PORT_RETURN_ADDRESS());
 }
 
 buffer_st *buffer_array_find_by_ptr(buffer_array_ctx_st *ctx_sp, uint8_t *memory_u8p)
 {
+    buffer_st *buffer_sp;
+
     if ((NULL == ctx_sp) || (false == ctx_sp->is_initialized))
     {
         return NULL;
     }
 
+    buffer_sp = buffer_array_slot_of(ctx_sp, memory_u8p);
+    if (NULL != buffer_sp)
+    {
+        BUFFER_STATS_ADD(&ctx_sp->pool_s, scan_steps, 1u);
+        return buffer_sp;
+    }
+
+    /* Not at its place in the block: descriptor re-pointed by the caller, or foreign. */
     return buffer_pool_find(&ctx_sp->pool_s, memory_u8p);
 }
 
 bool buffer_array_release_by_ptr(buffer_array_ctx_st *ctx_sp, uint8_t *memory_u8p)
 {
+    buffer_st *buffer_sp;
+
     if ((NULL == ctx_sp) || (false == ctx_sp->is_initialized))
     {
         return false;
     }
 
+    buffer_sp = buffer_array_slot_of(ctx_sp, memory_u8p);
+    if (NULL != buffer_sp)
+    {
+        BUFFER_STATS_ADD(&ctx_sp->pool_s, scan_steps, 1u);
+        buffer_pool_release_found(&ctx_sp->pool_s, buffer_sp);
+        return true;
+    }
+
     return buffer_pool_release_by_ptr(&ctx_sp->pool_s, memory_u8p);
 }
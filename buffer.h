@@ -20,6 +20,156 @@
 extern "C" {
 #endif
 
+/* -------------------------------------------------------------------------- */
+/* Configuration                                                              */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Optional features are selected at compile time. Each defaults to 0 and
+ * costs nothing when disabled; override with -D on the compiler command line
+ * (the same value must be used for every translation unit).
+ */
+
+/**
+ * @brief Compile in operation tracing (see buffer_trace.h).
+ *
+ * Requires linking buffer_trace.c (POSIX threads and stdio).
+ */
+#ifndef BUFFER_CFG_TRACE
+#define BUFFER_CFG_TRACE         (0)
+#endif
+
+/**
+ * @brief Compile in the always-on flight recorder (see buffer_flight.h).
+ *
+ * Requires linking buffer_flight.c (POSIX threads).
+ */
+#ifndef BUFFER_CFG_FLIGHT
+#define BUFFER_CFG_FLIGHT        (0)
+#endif
+
+/**
+ * @brief Compile in per-pool statistics counters (@ref buffer_pool_stats_st).
+ */
+#ifndef BUFFER_CFG_STATS
+#define BUFFER_CFG_STATS         (0)
+#endif
+
+/**
+ * @brief Number of counter shards per @ref buffer_pool_stats_st.
+ *
+ * Each thread updates its own shard (assigned round-robin on first use, or
+ * chosen by @c BUFFER_CFG_STATS_SHARD_ID() if defined, e.g. the CPU number).
+ * Use at least the number of threads that touch the pool.
+ */
+#ifndef BUFFER_CFG_STATS_SHARDS
+#define BUFFER_CFG_STATS_SHARDS  (8u)
+#endif
+
+/**
+ * @brief Attempts a reader makes to read the occupancy fields consistently.
+ *
+ * A reader only fails all of them if the writer stopped in the middle of
+ * an update, e.g. a service that died while its statistics stay mapped
+ * (see buffer_shm.h). The read then reports the occupancy as unavailable
+ * instead of spinning forever.
+ */
+#ifndef BUFFER_CFG_STATS_READ_RETRIES
+#define BUFFER_CFG_STATS_READ_RETRIES  (1024u)
+#endif
+
+/**
+ * @brief Compile in buffer hold-time histograms (@ref buffer_pool_hold_st).
+ */
+#ifndef BUFFER_CFG_HOLD_TIME
+#define BUFFER_CFG_HOLD_TIME     (0)
+#endif
+
+/**
+ * @brief Compile in the sampled ownership profiler (@ref buffer_pool_profile_st).
+ */
+#ifndef BUFFER_CFG_PROFILE
+#define BUFFER_CFG_PROFILE       (0)
+#endif
+
+/**
+ * @brief Compile in USDT probes (provider @c buffer_pool) for perf, bpftrace
+ *        and gdb: acquire, acquire_fail, release, foreign_release and
+ *        pool_exhausted.
+ *
+ * Arguments: pool address, buffer index (-1 if none) and free buffer count
+ * (-1 unless statistics are attached, see @c BUFFER_CFG_STATS).
+ * pool_exhausted fires when an acquire takes the last free buffer and so
+ * also needs attached statistics. Each probe is a single nop while no
+ * tracer is attached. x86-64 and AArch64 ELF targets only.
+ */
+#ifndef BUFFER_CFG_USDT
+#define BUFFER_CFG_USDT          (0)
+#endif
+
+/**
+ * @brief Compile in per-pool reuse policies (@ref buffer_pool_policy_st).
+ */
+#ifndef BUFFER_CFG_POLICY
+#define BUFFER_CFG_POLICY        (0)
+#endif
+
+/**
+ * @brief Vectorize @ref buffer_pool_find on 64-bit x86 and AArch64.
+ *
+ * Compares 4 to 8 data pointers per step: AVX2 gathers from the descriptor
+ * array (chosen at run time), or SSE2, AVX2 and NEON loads from an optional
+ * pointer array (see @ref buffer_pool_find_index_attach). Other targets
+ * keep the scalar loop.
+ */
+#ifndef BUFFER_CFG_FIND_SIMD
+#define BUFFER_CFG_FIND_SIMD     (0)
+#endif
+
+/**
+ * @brief Compile in O(1) bulk reset through epoch stamps
+ *        (@ref buffer_pool_epoch_attach).
+ */
+#ifndef BUFFER_CFG_EPOCH_RESET
+#define BUFFER_CFG_EPOCH_RESET   (0)
+#endif
+
+/**
+ * @brief Cache lines of the next free buffer to prefetch for write on acquire.
+ *
+ * After handing out a buffer, acquire looks up to
+ * @c BUFFER_CFG_PREFETCH_LOOKAHEAD descriptors further for the buffer the
+ * next acquire will return and prefetches the first
+ * @c BUFFER_CFG_PREFETCH_LINES cache lines of its data, so that the
+ * caller's first writes to it hit the cache. Data lines are only
+ * prefetched through a descriptor the scan has already read; when the
+ * next buffer comes from a reuse policy or a stale epoch stamp, only its
+ * descriptor is prefetched. 0 disables the lookahead.
+ */
+#ifndef BUFFER_CFG_PREFETCH_LINES
+#define BUFFER_CFG_PREFETCH_LINES      (0u)
+#endif
+
+/**
+ * @brief Descriptors examined for the prefetch (see @c BUFFER_CFG_PREFETCH_LINES).
+ */
+#ifndef BUFFER_CFG_PREFETCH_LOOKAHEAD
+#define BUFFER_CFG_PREFETCH_LOOKAHEAD  (8u)
+#endif
+
+/**
+ * @brief Cache line size used to keep shards apart.
+ */
+#ifndef BUFFER_CFG_CACHE_LINE
+#define BUFFER_CFG_CACHE_LINE    (64u)
+#endif
+
+#if defined(__GNUC__)
+#define BUFFER_CACHE_ALIGNED     __attribute__((aligned(BUFFER_CFG_CACHE_LINE)))
+#else
+#define BUFFER_CACHE_ALIGNED
+#endif
+
 /**
  * @brief Single fixed-size buffer descriptor.
  *
@@ -33,8 +183,206 @@ typedef struct
 
     volatile bool  is_available;     /**< True when buffer is free for reuse. */
     bool           is_initialized;   /**< True after @ref buffer_init was called. */
+#if (0 != BUFFER_CFG_PROFILE)
+    bool           is_sampled;       /**< Owner recorded by the profiler at the last acquire. */
+#endif
 } buffer_st;
 
+#if (0 != BUFFER_CFG_STATS)
+
+/**
+ * @brief One shard of pool event counters, on its own cache line.
+ */
+typedef struct
+{
+    uint64_t acquires;               /**< Successful acquires. */
+    uint64_t failed_acquires;        /**< Acquires that found no free buffer. */
+    uint64_t releases;               /**< Releases of in-use buffers. */
+    uint64_t invalid_releases;       /**< Releases of NULL or already free buffers. */
+    uint64_t foreign_releases;       /**< Releases of pointers not owned by the pool. */
+    uint64_t scan_steps;             /**< Descriptors visited by acquire and find. */
+    uint8_t  pad_au8[BUFFER_CFG_CACHE_LINE - (6u * sizeof(uint64_t))];
+} BUFFER_CACHE_ALIGNED buffer_pool_stats_shard_st;
+
+/**
+ * @brief Statistics storage for one pool.
+ *
+ * Provided by the caller and attached with @ref buffer_pool_stats_attach.
+ * Event counters are sharded per thread so that concurrent callers never
+ * write the same cache line. The occupancy fields are written only under
+ * the pool's usual single-writer rule, sit on their own cache line and are
+ * published through a sequence counter so that readers see them together
+ * (see @ref buffer_pool_snapshot).
+ */
+typedef struct
+{
+    buffer_pool_stats_shard_st shard_as[BUFFER_CFG_STATS_SHARDS];
+
+    uint32_t seq_u32;                /**< Odd while the occupancy fields are being updated. */
+    size_t   in_use;                 /**< Buffers currently acquired through the pool API. */
+    size_t   high_water;             /**< Highest @ref in_use since attach. */
+} BUFFER_CACHE_ALIGNED buffer_pool_stats_st;
+
+/**
+ * @brief Aggregated pool statistics, as returned by @ref buffer_pool_stats_read.
+ */
+typedef struct
+{
+    uint64_t acquires;
+    uint64_t failed_acquires;
+    uint64_t releases;
+    uint64_t invalid_releases;
+    uint64_t foreign_releases;
+    uint64_t scan_steps;
+    size_t   in_use;                 /**< 0 unless @ref occupancy_valid. */
+    size_t   high_water;             /**< 0 unless @ref occupancy_valid. */
+    bool     occupancy_valid;        /**< false if the occupancy could not be read (torn update). */
+} buffer_pool_counters_st;
+
+/**
+ * @brief Consistent occupancy summary, as returned by @ref buffer_pool_snapshot.
+ *
+ * A pool holds a single buffer size, so there is one class per pool.
+ */
+typedef struct
+{
+    size_t   buffer_count;           /**< Buffers in the pool. */
+    size_t   free_count;             /**< buffer_count - in_use. */
+    size_t   in_use;                 /**< Buffers acquired through the pool API. */
+    size_t   high_water;             /**< Highest @ref in_use since attach. */
+    uint32_t seq_u32;                /**< Sequence number; changes whenever occupancy changes. */
+} buffer_pool_snapshot_st;
+
+#endif /* BUFFER_CFG_STATS */
+
+#if (0 != BUFFER_CFG_HOLD_TIME)
+
+#define BUFFER_HOLD_SUB_BITS     (3u)        /**< Linear sub-buckets per power of two (log2). */
+#define BUFFER_HOLD_BUCKETS      (496u)      /**< Buckets covering all 64-bit values. */
+#define BUFFER_HOLD_MAX_TAGS     (256u)      /**< Tags fit in the top 8 bits of a stamp. */
+#define BUFFER_HOLD_ALL_TAGS     (0xFFFFFFFFu) /**< Tag argument that merges all tags. */
+
+/**
+ * @brief Log-linear histogram of hold times, in timestamp ticks.
+ *
+ * Relative bucket width is at most 1/8 (12.5 %).
+ */
+typedef struct
+{
+    uint64_t count_au64[BUFFER_HOLD_BUCKETS];
+    uint64_t total_count;            /**< Releases recorded. */
+    uint64_t sum_ticks;              /**< Sum of recorded hold times. */
+    uint64_t max_ticks;              /**< Longest recorded hold time. */
+} buffer_hold_hist_st;
+
+/**
+ * @brief Hold-time tracking storage for one pool.
+ *
+ * Filled by @ref buffer_pool_hold_attach. Both arrays are provided by the
+ * caller: one stamp per buffer (acquire time and tag) and one histogram
+ * per tag.
+ */
+typedef struct
+{
+    uint64_t            *stamp_au64;     /**< Per-buffer acquire stamp, 0 if not held. */
+    buffer_hold_hist_st *hist_as;        /**< Histogram per tag. */
+    uint32_t             tag_count;      /**< Elements in @ref hist_as. */
+} buffer_pool_hold_st;
+
+/**
+ * @brief Hold-time summary, as returned by @ref buffer_pool_hold_read.
+ *
+ * Percentiles are the upper bound of the bucket they fall in.
+ */
+typedef struct
+{
+    uint64_t count;                  /**< Releases recorded. */
+    uint64_t mean_ticks;
+    uint64_t p50_ticks;
+    uint64_t p90_ticks;
+    uint64_t p99_ticks;
+    uint64_t p999_ticks;
+    uint64_t max_ticks;
+} buffer_pool_hold_summary_st;
+
+#endif /* BUFFER_CFG_HOLD_TIME */
+
+#if (0 != BUFFER_CFG_PROFILE)
+
+/**
+ * @brief Owner of one sampled buffer.
+ */
+typedef struct
+{
+    uintptr_t site;                  /**< Return address or caller tag, 0 if not sampled. */
+    uint64_t  ticks;                 /**< Timestamp of the acquire. */
+} buffer_pool_sample_st;
+
+/**
+ * @brief Ownership profiler storage for one pool.
+ *
+ * Filled by @ref buffer_pool_profile_attach; @ref sample_as has one entry
+ * per buffer and is provided by the caller.
+ */
+typedef struct
+{
+    buffer_pool_sample_st *sample_as;    /**< Per-buffer owner, valid while the buffer is held. */
+    uint32_t               period;       /**< One acquire in @ref period is sampled. */
+    uint32_t               countdown;    /**< Acquires until the next sample. */
+} buffer_pool_profile_st;
+
+/**
+ * @brief Outstanding buffers of one call site, as returned by
+ *        @ref buffer_pool_dump_outstanding.
+ */
+typedef struct
+{
+    uintptr_t site;                  /**< Return address or caller tag. */
+    size_t    sampled;               /**< Sampled buffers this site still holds. */
+    size_t    estimated;             /**< @ref sampled scaled by the sampling period. */
+    uint64_t  mean_age_ticks;        /**< Mean time the sampled buffers have been held. */
+    uint64_t  max_age_ticks;         /**< Longest time one of them has been held. */
+} buffer_pool_site_st;
+
+#endif /* BUFFER_CFG_PROFILE */
+
+#if (0 != BUFFER_CFG_POLICY)
+
+#define BUFFER_POLICY_LEVELS     (4u)        /**< Bitmap levels: up to 64^4 buffers with LOWEST. */
+
+/**
+ * @brief Order in which free buffers are handed out again.
+ */
+typedef enum
+{
+    BUFFER_POLICY_SCAN   = 0,        /**< First free by index, found by scanning (default). */
+    BUFFER_POLICY_LIFO   = 1,        /**< Most recently released first: reuses cache-warm buffers. */
+    BUFFER_POLICY_FIFO   = 2,        /**< Least recently released first: spreads reuse evenly. */
+    BUFFER_POLICY_LOWEST = 3         /**< Lowest free index, via a bitmap: compacts the working set. */
+} buffer_policy_et;
+
+/**
+ * @brief Reuse policy state of one pool.
+ *
+ * The free buffers are kept in caller-provided work storage (see
+ * @ref buffer_pool_policy_work_bytes): a stack (LIFO) or ring (FIFO) of
+ * indices, or a hierarchical bitmap of 64-bit words (LOWEST) in which each
+ * bit of a level says whether the matching word below has a free buffer.
+ * Acquire and release are O(1) for every policy except SCAN.
+ */
+typedef struct
+{
+    buffer_policy_et policy_e;
+    uint32_t        *index_au32;                             /**< LIFO stack or FIFO ring. */
+    uint64_t        *bitmap_au64;                            /**< LOWEST: all levels, leaves first. */
+    uint32_t         level_start_au32[BUFFER_POLICY_LEVELS]; /**< First word of each bitmap level. */
+    uint32_t         level_count_u32;                        /**< Bitmap levels in use. */
+    size_t           head;                                   /**< FIFO: next index to take. */
+    size_t           free_count;                             /**< Free buffers held by the policy. */
+} buffer_pool_policy_st;
+
+#endif /* BUFFER_CFG_POLICY */
+
 /**
  * @brief Small pool of buffer descriptors.
  *
@@ -47,6 +395,35 @@ typedef struct
     size_t     buffer_count;         /**< Number of elements in @ref buffer_array_sa. */
 
     bool       is_initialized;       /**< True after @ref buffer_pool_init was called. */
+
+#if (0 != BUFFER_CFG_STATS)
+    buffer_pool_stats_st *stats_sp;  /**< Attached statistics, or NULL. */
+#endif
+
+#if (0 != BUFFER_CFG_HOLD_TIME)
+    buffer_pool_hold_st  *hold_sp;   /**< Attached hold-time tracking, or NULL. */
+#endif
+
+#if (0 != BUFFER_CFG_PROFILE)
+    buffer_pool_profile_st *profile_sp; /**< Attached ownership profiler, or NULL. */
+#endif
+
+#if (0 != BUFFER_CFG_POLICY)
+    buffer_pool_policy_st  *policy_sp;  /**< Attached reuse policy, or NULL for SCAN. */
+#endif
+
+#if (0 != BUFFER_CFG_FIND_SIMD)
+    uintptr_t const        *find_addr_au; /**< Attached copy of the data pointers, or NULL. */
+#endif
+
+#if (0 != BUFFER_CFG_EPOCH_RESET)
+    uint32_t               *epoch_au32;   /**< Attached per-buffer epoch stamps, or NULL. */
+    uint32_t                epoch_u32;    /**< Current epoch, advanced by @ref buffer_pool_mark_all_free. */
+#endif
+
+#if (0 != BUFFER_CFG_FLIGHT)
+    uint32_t                flight_id_u32; /**< Pool id in flight recorder records. */
+#endif
 } buffer_pool_st;
 
 /**
@@ -110,6 +487,8 @@ uint8_t *buffer_data(buffer_st const *buffer_csp, size_t *capacity_bytes_out_p);
  * @param[in,out] buffer_sp  Pointer to buffer descriptor.
  *
  * If @p buffer_sp is NULL or not initialized, the function does nothing.
+ * Only the flag is written: on a pool with epoch stamps attached the
+ * buffer's state may not change. Use @ref buffer_pool_mark_free there.
  */
 void buffer_mark_free(buffer_st *buffer_sp);
 
@@ -119,6 +498,8 @@ void buffer_mark_free(buffer_st *buffer_sp);
  * @param[in,out] buffer_sp  Pointer to buffer descriptor.
  *
  * If @p buffer_sp is NULL or not initialized, the function does nothing.
+ * Only the flag is written: on a pool with epoch stamps attached the
+ * buffer's state may not change. Use @ref buffer_pool_mark_in_use there.
  */
 void buffer_mark_in_use(buffer_st *buffer_sp);
 
@@ -170,15 +551,337 @@ buffer_st *buffer_pool_find(buffer_pool_st *pool_sp, uint8_t *memory_u8p);
  */
 bool buffer_pool_release_by_ptr(buffer_pool_st *pool_sp, uint8_t *memory_u8p);
 
+/**
+ * @brief Release a buffer whose descriptor is already known.
+ *
+ * @param[in,out] pool_sp    Pointer to an initialized pool.
+ * @param[in]     buffer_sp  Descriptor from the pool's array.
+ *
+ * @return true  if @p buffer_sp belongs to the pool and was marked free.
+ * @return false if it does not belong to the pool or inputs are invalid.
+ *
+ * Same effect as @ref buffer_pool_release_by_ptr without the search.
+ */
+bool buffer_pool_release(buffer_pool_st *pool_sp, buffer_st *buffer_sp);
+
 /**
  * @brief Mark all buffers in the pool as free.
  *
  * @param[in,out] pool_sp  Pointer to an initialized pool.
  *
  * Buffers that were never initialized via @ref buffer_init are left untouched.
+ * O(buffer_count), or O(1) with epoch stamps attached (see
+ * @ref buffer_pool_epoch_attach).
  */
 void buffer_pool_mark_all_free(buffer_pool_st *pool_sp);
 
+/**
+ * @brief Mark one buffer of the pool as free, stamping the current epoch.
+ *
+ * @param[in,out] pool_sp    Pointer to an initialized pool.
+ * @param[in,out] buffer_sp  Descriptor from the pool's array.
+ *
+ * Like @ref buffer_mark_free, but also correct with epoch stamps attached,
+ * and a held buffer marked free is queued to an attached reuse policy.
+ * Statistics are bypassed, as with the plain form. Does nothing if
+ * @p buffer_sp is not an initialized buffer of the pool.
+ */
+void buffer_pool_mark_free(buffer_pool_st *pool_sp, buffer_st *buffer_sp);
+
+/**
+ * @brief Mark one buffer of the pool as in use, stamping the current epoch.
+ *
+ * @param[in,out] pool_sp    Pointer to an initialized pool.
+ * @param[in,out] buffer_sp  Descriptor from the pool's array.
+ *
+ * Counterpart of @ref buffer_pool_mark_free. A free buffer queued in a
+ * reuse policy stays queued; acquire skips and drops it, so it is never
+ * handed out while held.
+ */
+void buffer_pool_mark_in_use(buffer_pool_st *pool_sp, buffer_st *buffer_sp);
+
+#if (0 != BUFFER_CFG_STATS)
+
+/* -------------------------------------------------------------------------- */
+/* Pool statistics API (BUFFER_CFG_STATS=1)                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Attach statistics storage to a pool and zero it.
+ *
+ * @param[in,out] pool_sp   Pointer to an initialized pool.
+ * @param[out]    stats_sp  Storage to attach, or NULL to detach.
+ *
+ * Counters only see operations made through the pool API; direct calls to
+ * @ref buffer_mark_free / @ref buffer_mark_in_use are not counted.
+ * @ref buffer_pool_init detaches any previous storage.
+ */
+void buffer_pool_stats_attach(buffer_pool_st *pool_sp, buffer_pool_stats_st *stats_sp);
+
+/**
+ * @brief Read and aggregate the statistics of a pool.
+ *
+ * @param[in]  pool_csp      Pointer to an initialized pool.
+ * @param[out] counters_sp   Aggregated counters.
+ *
+ * @return true if statistics are attached and @p counters_sp was filled.
+ *
+ * Safe to call from any thread; each counter is read atomically but the
+ * set is not a consistent snapshot while the pool is in use. The occupancy
+ * pair (@c in_use, @c high_water) is consistent, or flagged as unavailable
+ * in @c occupancy_valid (see @c BUFFER_CFG_STATS_READ_RETRIES).
+ */
+bool buffer_pool_stats_read(buffer_pool_st const *pool_csp, buffer_pool_counters_st *counters_sp);
+
+/**
+ * @brief Aggregate a statistics block that is not reached through a pool.
+ *
+ * @param[in]  stats_csp    Statistics block, e.g. mapped from another process.
+ * @param[out] counters_sp  Aggregated counters.
+ *
+ * Same guarantees as @ref buffer_pool_stats_read; only loads are performed,
+ * so @p stats_csp may live in read-only memory. Never blocks, even if the
+ * writing process died in the middle of an update.
+ *
+ * @return false if the occupancy could not be read (@c occupancy_valid).
+ */
+bool buffer_pool_stats_sum(buffer_pool_stats_st const *stats_csp, buffer_pool_counters_st *counters_sp);
+
+/**
+ * @brief Read a consistent occupancy summary in O(1).
+ *
+ * @param[in]  pool_csp     Pointer to an initialized pool with attached statistics.
+ * @param[out] snapshot_sp  Summary.
+ *
+ * @return true if statistics are attached and @p snapshot_sp was filled,
+ *         false also if no consistent read succeeded within
+ *         @c BUFFER_CFG_STATS_READ_RETRIES attempts.
+ *
+ * Takes no lock and never touches the descriptor array, so it can be called
+ * from a monitoring thread while workers use the pool. The reader retries
+ * if a worker updates the occupancy during the read; workers never wait.
+ */
+bool buffer_pool_snapshot(buffer_pool_st const *pool_csp, buffer_pool_snapshot_st *snapshot_sp);
+
+#endif /* BUFFER_CFG_STATS */
+
+#if (0 != BUFFER_CFG_HOLD_TIME)
+
+/* -------------------------------------------------------------------------- */
+/* Hold time API (BUFFER_CFG_HOLD_TIME=1)                                     */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Attach hold-time tracking to a pool and zero it.
+ *
+ * @param[in,out] pool_sp     Pointer to an initialized pool.
+ * @param[out]    hold_sp     Tracking object to fill and attach, or NULL to detach.
+ * @param[in]     stamp_au64  Array of @c buffer_count stamps (one per buffer).
+ * @param[in]     hist_as     Array of @p tag_count histograms.
+ * @param[in]     tag_count   Number of tags, 1 to @ref BUFFER_HOLD_MAX_TAGS.
+ *
+ * @return true if attached (or detached, for a NULL @p hold_sp).
+ *
+ * Each acquire stores the current timestamp and the acquire tag in the
+ * buffer's stamp; the matching release records the elapsed ticks in the
+ * tag's histogram. Buffers already in use when attaching are not timed.
+ * Timestamps come from the CPU cycle counter (or @c BUFFER_CFG_TICKS()).
+ */
+bool buffer_pool_hold_attach(buffer_pool_st *pool_sp,
+                             buffer_pool_hold_st *hold_sp,
+                             uint64_t *stamp_au64,
+                             buffer_hold_hist_st *hist_as,
+                             uint32_t tag_count);
+
+/**
+ * @brief Acquire a free buffer on behalf of a call-site tag.
+ *
+ * @param[in,out] pool_sp  Pointer to an initialized pool.
+ * @param[in]     tag      Call-site tag; out-of-range tags are recorded as 0.
+ *
+ * @return Same as @ref buffer_pool_acquire, which uses tag 0.
+ */
+buffer_st *buffer_pool_acquire_tagged(buffer_pool_st *pool_sp, uint32_t tag);
+
+/**
+ * @brief Summarize the hold times recorded for one tag or all tags.
+ *
+ * @param[in]  pool_csp    Pointer to a pool with hold-time tracking attached.
+ * @param[in]  tag         Tag to read, or @ref BUFFER_HOLD_ALL_TAGS.
+ * @param[out] summary_sp  Summary, in timestamp ticks.
+ *
+ * @return true if tracking is attached, @p tag is valid and @p summary_sp was filled.
+ *
+ * Safe to call from any thread; the histogram may be updated while it is
+ * read, so the percentiles are approximate in that case.
+ */
+bool buffer_pool_hold_read(buffer_pool_st const *pool_csp, uint32_t tag, buffer_pool_hold_summary_st *summary_sp);
+
+#endif /* BUFFER_CFG_HOLD_TIME */
+
+#if (0 != BUFFER_CFG_PROFILE)
+
+/* -------------------------------------------------------------------------- */
+/* Ownership profiler API (BUFFER_CFG_PROFILE=1)                              */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Attach the ownership profiler to a pool.
+ *
+ * @param[in,out] pool_sp     Pointer to an initialized pool.
+ * @param[out]    profile_sp  Profiler object to fill and attach, or NULL to detach.
+ * @param[out]    sample_as   Array of @c buffer_count samples (one per buffer).
+ * @param[in]     period      Sample one acquire in @p period (1 samples all).
+ *
+ * @return true if attached (or detached, for a NULL @p profile_sp).
+ *
+ * A sampled acquire records the caller's return address (or the site given
+ * to @ref buffer_pool_acquire_site) and the timestamp in the buffer's
+ * sample and flags the descriptor. Other acquires decrement a counter and
+ * clear the flag; releases and epoch resets leave the table alone, since
+ * the dump ignores free buffers and unflagged samples.
+ */
+bool buffer_pool_profile_attach(buffer_pool_st *pool_sp,
+                                buffer_pool_profile_st *profile_sp,
+                                buffer_pool_sample_st *sample_as,
+                                uint32_t period);
+
+/**
+ * @brief Acquire a free buffer on behalf of an explicit call site.
+ *
+ * @param[in,out] pool_sp  Pointer to an initialized pool.
+ * @param[in]     site     Non-zero caller tag recorded if this acquire is sampled.
+ *
+ * @return Same as @ref buffer_pool_acquire, which records its return address.
+ */
+buffer_st *buffer_pool_acquire_site(buffer_pool_st *pool_sp, uintptr_t site);
+
+/**
+ * @brief Report which call sites hold the sampled outstanding buffers.
+ *
+ * @param[in]  pool_csp   Pointer to a pool with the profiler attached.
+ * @param[out] sites_as   Array receiving one entry per site, most buffers first.
+ * @param[in]  max_sites  Capacity of @p sites_as.
+ *
+ * @return Number of entries written. Sites beyond @p max_sites are dropped.
+ *
+ * Walks the sample array, so it is O(buffer_count * max_sites). It may run
+ * while the pool is in use; the report is then approximate. Ages are in
+ * timestamp ticks. Return addresses can be resolved with addr2line.
+ */
+size_t buffer_pool_dump_outstanding(buffer_pool_st const *pool_csp,
+                                    buffer_pool_site_st *sites_as,
+                                    size_t max_sites);
+
+#endif /* BUFFER_CFG_PROFILE */
+
+#if (0 != BUFFER_CFG_POLICY)
+
+/* -------------------------------------------------------------------------- */
+/* Reuse policy API (BUFFER_CFG_POLICY=1)                                     */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Bytes of work storage a policy needs for a pool size.
+ *
+ * @param[in] policy_e      Policy.
+ * @param[in] buffer_count  Buffers in the pool.
+ *
+ * @return Bytes (8-byte aligned storage), 0 for SCAN or an unsupported size.
+ */
+size_t buffer_pool_policy_work_bytes(buffer_policy_et policy_e, size_t buffer_count);
+
+/**
+ * @brief Attach a reuse policy to a pool.
+ *
+ * @param[in,out] pool_sp    Pointer to an initialized pool.
+ * @param[out]    policy_sp  Policy object to fill and attach, or NULL to detach (SCAN).
+ * @param[in]     policy_e   Policy.
+ * @param[out]    work_p     Storage of @ref buffer_pool_policy_work_bytes bytes,
+ *                           8-byte aligned; may be NULL for SCAN.
+ *
+ * @return true if attached (or detached, for a NULL @p policy_sp).
+ *
+ * The policy starts from the buffers free at the time of the call, lowest
+ * index first. Acquire only hands out queued buffers that are still free,
+ * so marking a queued buffer in use is safe. A held buffer marked free
+ * with @ref buffer_mark_free is not queued, though, and is not handed out
+ * until the next attach or bulk reset: use @ref buffer_pool_mark_free.
+ */
+bool buffer_pool_policy_attach(buffer_pool_st *pool_sp,
+                               buffer_pool_policy_st *policy_sp,
+                               buffer_policy_et policy_e,
+                               void *work_p);
+
+#endif /* BUFFER_CFG_POLICY */
+
+#if (0 != BUFFER_CFG_FIND_SIMD)
+
+/* -------------------------------------------------------------------------- */
+/* Vectorized find API (BUFFER_CFG_FIND_SIMD=1)                               */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Attach a contiguous copy of the pool's data pointers for find.
+ *
+ * @param[in,out] pool_sp  Pointer to an initialized pool.
+ * @param[out]    addr_au  Array of @c buffer_count entries, filled from the
+ *                         descriptors, or NULL to detach.
+ *
+ * @return true if attached (or detached, for a NULL @p addr_au).
+ *
+ * @ref buffer_pool_find then compares whole vectors of pointers loaded from
+ * @p addr_au instead of picking them out of 24-byte descriptors. The copy
+ * is taken at attach time: attach again after @ref buffer_init changes a
+ * descriptor of the pool. Each hit is confirmed against the descriptor,
+ * so a stale copy can miss a buffer but never returns the wrong one.
+ */
+bool buffer_pool_find_index_attach(buffer_pool_st *pool_sp, uintptr_t *addr_au);
+
+#endif /* BUFFER_CFG_FIND_SIMD */
+
+#if (0 != BUFFER_CFG_EPOCH_RESET)
+
+/* -------------------------------------------------------------------------- */
+/* Epoch reset API (BUFFER_CFG_EPOCH_RESET=1)                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Attach per-buffer epoch stamps to make bulk reset O(1).
+ *
+ * @param[in,out] pool_sp     Pointer to an initialized pool.
+ * @param[out]    epoch_au32  Array of @c buffer_count stamps, or NULL to detach.
+ *
+ * @return true if attached (or detached, for a NULL @p epoch_au32).
+ *
+ * Acquire and release stamp the buffer with the pool's current epoch.
+ * @ref buffer_pool_mark_all_free then only advances the epoch: a buffer
+ * stamped with an older epoch counts as free, whatever its
+ * @c is_available flag says, until the pool hands it out again. Detaching
+ * writes the flags back (O(buffer_count)), as does one reset in 2^32 when
+ * the epoch wraps.
+ *
+ * While attached, @c is_available is only current for buffers acquired or
+ * released since the last reset: use @ref buffer_pool_is_free, and
+ * @ref buffer_pool_mark_free / @ref buffer_pool_mark_in_use rather than
+ * the plain forms, which leave the stamp alone. The profiler and
+ * hold-time tracking follow the epoch; a reuse policy still rebuilds its
+ * free list on reset in O(buffer_count).
+ */
+bool buffer_pool_epoch_attach(buffer_pool_st *pool_sp, uint32_t *epoch_au32);
+
+/**
+ * @brief Whether a buffer of the pool is free, taking the epoch into account.
+ *
+ * @param[in] pool_csp    Pointer to an initialized pool.
+ * @param[in] buffer_csp  Descriptor from the pool's array.
+ *
+ * @return true if the buffer is free, false if in use or not in the pool.
+ */
+bool buffer_pool_is_free(buffer_pool_st const *pool_csp, buffer_st const *buffer_csp);
+
+#endif /* BUFFER_CFG_EPOCH_RESET */
+
 /* -------------------------------------------------------------------------- */
 /* Buffer array context API                                                   */
 /* -------------------------------------------------------------------------- */
@@ -221,6 +924,10 @@ buffer_st *buffer_array_acquire(buffer_array_ctx_st *ctx_sp);
  * @param[in]     memory_u8p  Backing memory pointer.
  *
  * @return Pointer to matching buffer descriptor, or NULL if not found.
+ *
+ * O(1): the index follows from the pointer's offset in the memory block.
+ * Only pointers that are not where @ref buffer_array_ctx_init placed a
+ * buffer fall back to the pool's linear search.
  */
 buffer_st *buffer_array_find_by_ptr(buffer_array_ctx_st *ctx_sp, uint8_t *memory_u8p);
 
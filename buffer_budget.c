@@ -0,0 +1,319 @@
+/**
+ * @file buffer_budget.c
+ * @brief Process-wide memory budget shared by many segmented pools.
+ */
+
+#include "buffer_budget.h"
+
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+static void buffer_budget_lock(buffer_budget_st const *budget_csp)
+{
+    if (NULL != budget_csp->lock_fn)
+    {
+        budget_csp->lock_fn(budget_csp->user_p);
+    }
+}
+
+static void buffer_budget_unlock(buffer_budget_st const *budget_csp)
+{
+    if (NULL != budget_csp->unlock_fn)
+    {
+        budget_csp->unlock_fn(budget_csp->user_p);
+    }
+}
+
+/**
+ * @brief Segment lock callbacks: the provider's user pointer is the client,
+ *        so forward to the pool's own lock with its own user pointer.
+ */
+static void buffer_budget_client_lock(void *user_p)
+{
+    buffer_budget_client_st const *client_csp = (buffer_budget_client_st const *)user_p;
+
+    if (NULL != client_csp->lock_fn)
+    {
+        client_csp->lock_fn(client_csp->user_p);
+    }
+}
+
+static void buffer_budget_client_unlock(void *user_p)
+{
+    buffer_budget_client_st const *client_csp = (buffer_budget_client_st const *)user_p;
+
+    if (NULL != client_csp->unlock_fn)
+    {
+        client_csp->unlock_fn(client_csp->user_p);
+    }
+}
+
+/**
+ * @brief Segment provider callback: lend one slab to a client.
+ *
+ * Slabs that were never lent are handed out from the arena end without
+ * touching the rest of the arena, so untouched memory stays unmapped.
+ */
+static void *buffer_budget_slab_alloc(void *user_p, size_t size_bytes)
+{
+    buffer_budget_client_st *client_sp = (buffer_budget_client_st *)user_p;
+    buffer_budget_st        *budget_sp = client_sp->budget_sp;
+    void                    *slab_p    = NULL;
+
+    if (size_bytes > budget_sp->slab_bytes)
+    {
+        return NULL;
+    }
+
+    buffer_budget_lock(budget_sp);
+
+    if (budget_sp->lent_slabs < budget_sp->budget_slabs)
+    {
+        if (NULL != budget_sp->free_head_p)
+        {
+            slab_p = budget_sp->free_head_p;
+            memcpy(&budget_sp->free_head_p, slab_p, sizeof(void *));
+        }
+        else if (0u < budget_sp->never_used)
+        {
+            slab_p = &budget_sp->arena_u8p[(budget_sp->slab_count - budget_sp->never_used) * budget_sp->slab_bytes];
+            budget_sp->never_used--;
+        }
+        else
+        {
+            /* Arena exhausted. */
+        }
+    }
+
+    if (NULL != slab_p)
+    {
+        budget_sp->lent_slabs++;
+        client_sp->lent_slabs++;
+        if (budget_sp->lent_slabs > budget_sp->peak_slabs)
+        {
+            budget_sp->peak_slabs = budget_sp->lent_slabs;
+        }
+    }
+    else
+    {
+        client_sp->denied++;
+    }
+
+    buffer_budget_unlock(budget_sp);
+
+    return slab_p;
+}
+
+/**
+ * @brief Segment provider callback: take a slab back from a client.
+ */
+static void buffer_budget_slab_free(void *user_p, void *block_p, size_t size_bytes)
+{
+    buffer_budget_client_st *client_sp = (buffer_budget_client_st *)user_p;
+    buffer_budget_st        *budget_sp = client_sp->budget_sp;
+
+    (void)size_bytes;
+
+    buffer_budget_lock(budget_sp);
+
+    memcpy(block_p, &budget_sp->free_head_p, sizeof(void *));
+    budget_sp->free_head_p = block_p;
+    budget_sp->lent_slabs--;
+    client_sp->lent_slabs--;
+
+    buffer_budget_unlock(budget_sp);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Budget manager API                                                         */
+/* -------------------------------------------------------------------------- */
+
+bool buffer_budget_init(buffer_budget_st *budget_sp,
+                        uint8_t *arena_u8p,
+                        size_t arena_bytes,
+                        size_t slab_bytes,
+                        size_t budget_bytes,
+                        void (*lock_fn)(void *user_p),
+                        void (*unlock_fn)(void *user_p),
+                        void *user_p)
+{
+    if ((NULL == budget_sp)                                           ||
+        (NULL == arena_u8p)                                           ||
+        (0u   != ((uintptr_t)arena_u8p % BUFFER_CFG_CACHE_LINE))      ||
+        (0u   == slab_bytes)                                          ||
+        (0u   != (slab_bytes % BUFFER_CFG_CACHE_LINE))                ||
+        (arena_bytes < slab_bytes))
+    {
+        return false;
+    }
+
+    memset(budget_sp, 0, sizeof(*budget_sp));
+    budget_sp->arena_u8p    = arena_u8p;
+    budget_sp->slab_bytes   = slab_bytes;
+    budget_sp->slab_count   = arena_bytes / slab_bytes;
+    budget_sp->never_used   = budget_sp->slab_count;
+    budget_sp->budget_slabs = budget_bytes / slab_bytes;
+    budget_sp->lock_fn      = lock_fn;
+    budget_sp->unlock_fn    = unlock_fn;
+    budget_sp->user_p       = user_p;
+
+    if (budget_sp->budget_slabs > budget_sp->slab_count)
+    {
+        budget_sp->budget_slabs = budget_sp->slab_count;
+    }
+
+    budget_sp->is_initialized = true;
+    return true;
+}
+
+bool buffer_budget_register(buffer_budget_st *budget_sp,
+                            buffer_budget_client_st *client_sp,
+                            size_t buffer_size,
+                            size_t min_segments,
+                            void (*lock_fn)(void *user_p),
+                            void (*unlock_fn)(void *user_p),
+                            void *user_p)
+{
+    buffer_seg_provider_st provider_s;
+    size_t                 count;
+    size_t                 index;
+    bool                   is_registered;
+
+    if ((NULL == budget_sp) || (false == budget_sp->is_initialized) ||
+        (NULL == client_sp) || (0u == buffer_size)                   ||
+        (BUFFER_CFG_SEG_MAX < min_segments))
+    {
+        return false;
+    }
+
+    /* Largest segment that fits a slab. */
+    count = budget_sp->slab_bytes / (buffer_size + sizeof(buffer_st));
+    while ((0u < count) && (buffer_seg_block_bytes(count, buffer_size) > budget_sp->slab_bytes))
+    {
+        --count;
+    }
+
+    if (0u == count)
+    {
+        return false;
+    }
+
+    memset(client_sp, 0, sizeof(*client_sp));
+    client_sp->budget_sp       = budget_sp;
+    client_sp->segment_buffers = count;
+    client_sp->min_segments    = min_segments;
+    client_sp->lock_fn         = lock_fn;
+    client_sp->unlock_fn       = unlock_fn;
+    client_sp->user_p          = user_p;
+
+    provider_s.alloc_fn  = buffer_budget_slab_alloc;
+    provider_s.free_fn   = buffer_budget_slab_free;
+    provider_s.lock_fn   = buffer_budget_client_lock;
+    provider_s.unlock_fn = buffer_budget_client_unlock;
+    provider_s.user_p    = client_sp;
+    buffer_seg_init(&client_sp->seg_s, buffer_size, &provider_s);
+
+    /* Borrow the first slabs before publishing the client, so that a
+     * failed registration leaves nothing behind for rebalance to visit. */
+    is_registered = true;
+    for (index = 0u; (true == is_registered) && (index < min_segments); ++index)
+    {
+        is_registered = buffer_seg_add(&client_sp->seg_s, count);
+    }
+
+    if (true == is_registered)
+    {
+        buffer_budget_lock(budget_sp);
+        is_registered = (budget_sp->client_count < BUFFER_CFG_BUDGET_MAX_CLIENTS);
+        if (true == is_registered)
+        {
+            budget_sp->client_asp[budget_sp->client_count] = client_sp;
+            budget_sp->client_count++;
+        }
+        buffer_budget_unlock(budget_sp);
+    }
+
+    if (false == is_registered)
+    {
+        buffer_seg_deinit(&client_sp->seg_s);   /* Returns the slabs borrowed so far. */
+    }
+
+    return is_registered;
+}
+
+buffer_st *buffer_budget_acquire(buffer_budget_client_st *client_sp)
+{
+    buffer_st *buffer_sp;
+
+    if (NULL == client_sp)
+    {
+        return NULL;
+    }
+
+    buffer_sp = buffer_seg_acquire(&client_sp->seg_s);
+
+    /* A draining segment still holds its slab: reuse it before borrowing. */
+    if ((NULL == buffer_sp) &&
+        ((0u < buffer_seg_reactivate(&client_sp->seg_s)) ||
+         (true == buffer_seg_add(&client_sp->seg_s, client_sp->segment_buffers))))
+    {
+        buffer_sp = buffer_seg_acquire(&client_sp->seg_s);
+    }
+
+    return buffer_sp;
+}
+
+bool buffer_budget_release_by_ptr(buffer_budget_client_st *client_sp, uint8_t *memory_u8p)
+{
+    if (NULL == client_sp)
+    {
+        return false;
+    }
+
+    return buffer_seg_release_by_ptr(&client_sp->seg_s, memory_u8p);
+}
+
+size_t buffer_budget_rebalance(buffer_budget_st *budget_sp)
+{
+    buffer_budget_client_st *client_sp;
+    buffer_seg_sample_st     sample_s;
+    size_t                   client_count;
+    size_t                   index;
+    size_t                   keep;
+    size_t                   reclaimed = 0u;
+
+    if ((NULL == budget_sp) || (false == budget_sp->is_initialized))
+    {
+        return 0u;
+    }
+
+    buffer_budget_lock(budget_sp);
+    client_count = budget_sp->client_count;
+    buffer_budget_unlock(budget_sp);
+
+    /* Client locks are taken without the manager lock held. */
+    for (index = 0u; index < client_count; ++index)
+    {
+        client_sp = budget_sp->client_asp[index];
+        buffer_seg_sample(&client_sp->seg_s, &sample_s);
+
+        keep = client_sp->min_segments * client_sp->segment_buffers;
+        if (keep < sample_s.peak_in_use)
+        {
+            keep = sample_s.peak_in_use;
+        }
+
+        if ((sample_s.active_segments > client_sp->min_segments) &&
+            (sample_s.capacity >= (keep + client_sp->segment_buffers)))
+        {
+            (void)buffer_seg_drain(&client_sp->seg_s, keep);
+        }
+
+        reclaimed += buffer_seg_reclaim(&client_sp->seg_s);
+    }
+
+    return reclaimed;
+}
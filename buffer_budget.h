@@ -0,0 +1,158 @@
+/**
+ * @file buffer_budget.h
+ * @brief Process-wide memory budget shared by many segmented pools.
+ *
+ * A budget manager owns one arena, cut into equal slabs, and lends them to
+ * registered pools as segments (see buffer_seg.h). Each client pool starts
+ * with @c min_segments slabs and borrows another slab when an acquire finds
+ * no free buffer, as long as the total lent stays within the byte budget.
+ * @ref buffer_budget_rebalance, called periodically, drains one idle
+ * segment from every client whose peak use since the previous call left a
+ * whole segment unused; drained slabs go back to the arena once their
+ * buffers are released, and hot clients borrow them on their next miss.
+ * Memory in use therefore follows the peak of the summed demand rather
+ * than the sum of each pool's own peak.
+ *
+ * Locking: the manager's lock callbacks guard the slab free list; each
+ * client's lock callbacks guard its segmented context, exactly as in
+ * buffer_seg.h. The manager lock is only taken inside a client's lock or
+ * on its own, never the other way round.
+ */
+
+#ifndef BUFFER_BUDGET_H_
+#define BUFFER_BUDGET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "buffer.h"
+#include "buffer_seg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of pools registered with one manager. */
+#ifndef BUFFER_CFG_BUDGET_MAX_CLIENTS
+#define BUFFER_CFG_BUDGET_MAX_CLIENTS    (32u)
+#endif
+
+typedef struct buffer_budget_s buffer_budget_st;
+
+/**
+ * @brief One pool drawing memory from a budget manager.
+ */
+typedef struct
+{
+    buffer_seg_ctx_st  seg_s;                /**< The pool; use through the client API. */
+    buffer_budget_st  *budget_sp;            /**< Manager the pool is registered with. */
+    size_t             segment_buffers;      /**< Buffers per slab for this buffer size. */
+    size_t             min_segments;         /**< Segments never drained. */
+    size_t             lent_slabs;           /**< Slabs this pool holds now. */
+    uint64_t           denied;               /**< Slab requests refused by the budget. */
+    void             (*lock_fn)(void *user_p);     /**< Pool lock, or NULL. */
+    void             (*unlock_fn)(void *user_p);   /**< Pool unlock, or NULL. */
+    void              *user_p;                     /**< Passed to the pool lock callbacks. */
+} buffer_budget_client_st;
+
+/**
+ * @brief Budget manager.
+ */
+struct buffer_budget_s
+{
+    uint8_t                 *arena_u8p;      /**< Arena start. */
+    size_t                   slab_bytes;     /**< Bytes per slab. */
+    size_t                   slab_count;     /**< Slabs in the arena. */
+    size_t                   budget_slabs;   /**< Slabs that may be lent at once. */
+    size_t                   lent_slabs;     /**< Slabs lent now. */
+    size_t                   peak_slabs;     /**< Highest @ref lent_slabs since init. */
+    void                    *free_head_p;    /**< Free list, linked through the free slabs. */
+    size_t                   never_used;     /**< Slabs at the arena end never lent yet. */
+
+    buffer_budget_client_st *client_asp[BUFFER_CFG_BUDGET_MAX_CLIENTS];
+    size_t                   client_count;
+
+    void                   (*lock_fn)(void *user_p);     /**< Optional, may be NULL. */
+    void                   (*unlock_fn)(void *user_p);   /**< Optional, may be NULL. */
+    void                    *user_p;
+    bool                     is_initialized;
+};
+
+/**
+ * @brief Initialize a manager over a caller-provided arena.
+ *
+ * @param[out] budget_sp     Manager to initialize.
+ * @param[in]  arena_u8p     Arena, aligned to @c BUFFER_CFG_CACHE_LINE.
+ * @param[in]  arena_bytes   Arena size.
+ * @param[in]  slab_bytes    Slab size, a multiple of @c BUFFER_CFG_CACHE_LINE.
+ * @param[in]  budget_bytes  Bytes that may be lent at once (clamped to the arena).
+ * @param[in]  lock_fn       Lock of the slab free list, or NULL.
+ * @param[in]  unlock_fn     Matching unlock, or NULL.
+ * @param[in]  user_p        Passed to the lock callbacks.
+ *
+ * @return true if the arena holds at least one slab.
+ */
+bool buffer_budget_init(buffer_budget_st *budget_sp,
+                        uint8_t *arena_u8p,
+                        size_t arena_bytes,
+                        size_t slab_bytes,
+                        size_t budget_bytes,
+                        void (*lock_fn)(void *user_p),
+                        void (*unlock_fn)(void *user_p),
+                        void *user_p);
+
+/**
+ * @brief Register a pool and lend it its first segments.
+ *
+ * @param[in,out] budget_sp     Manager.
+ * @param[out]    client_sp     Client to initialize; must outlive the manager's use.
+ * @param[in]     buffer_size   Bytes per buffer of this pool.
+ * @param[in]     min_segments  Segments lent now and never drained.
+ * @param[in]     lock_fn       Lock of this pool, or NULL (see buffer_seg.h).
+ * @param[in]     unlock_fn     Matching unlock, or NULL.
+ * @param[in]     user_p        Passed to the pool's lock callbacks.
+ *
+ * @return false if a slab cannot hold one buffer, the client table is full,
+ *         or the budget cannot cover @p min_segments; the client is then
+ *         not registered and holds no slabs.
+ */
+bool buffer_budget_register(buffer_budget_st *budget_sp,
+                            buffer_budget_client_st *client_sp,
+                            size_t buffer_size,
+                            size_t min_segments,
+                            void (*lock_fn)(void *user_p),
+                            void (*unlock_fn)(void *user_p),
+                            void *user_p);
+
+/**
+ * @brief Acquire a buffer, growing the pool if it is full.
+ *
+ * A segment that rebalance set draining is put back into service first,
+ * since its slab is still lent to this client; only then is a new slab
+ * borrowed.
+ *
+ * @return Buffer, or NULL if the pool is full and the budget is exhausted.
+ */
+buffer_st *buffer_budget_acquire(buffer_budget_client_st *client_sp);
+
+/**
+ * @brief Release a buffer by its data pointer.
+ */
+bool buffer_budget_release_by_ptr(buffer_budget_client_st *client_sp, uint8_t *memory_u8p);
+
+/**
+ * @brief Drain idle segments of cold pools and return emptied slabs.
+ *
+ * @return Number of slabs returned to the arena by this call.
+ *
+ * Call periodically (e.g. once a second) from any thread. Uses
+ * @ref buffer_seg_sample, so a client must not also be driven by a tuner.
+ */
+size_t buffer_budget_rebalance(buffer_budget_st *budget_sp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_BUDGET_H_ */
@@ -0,0 +1,203 @@
+/**
+ * @file buffer_flight.c
+ * @brief Always-on flight recorder of recent pool events.
+ *
+ * Only needed when the library is built with BUFFER_CFG_FLIGHT=1. Uses
+ * POSIX threads to return a thread's ring when the thread exits.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "buffer_flight.h"
+#include "buffer_port.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define BUFFER_FLIGHT_RING_MASK  (BUFFER_CFG_FLIGHT_RECORDS - 1u)
+#define BUFFER_FLIGHT_RETRY_MASK (63u)       /**< A thread without a ring looks again every 64 events. */
+
+#if (0u != (BUFFER_CFG_FLIGHT_RECORDS & BUFFER_FLIGHT_RING_MASK))
+#error "BUFFER_CFG_FLIGHT_RECORDS must be a power of two"
+#endif
+
+buffer_flight_ring_st buffer_flight_rings_as[BUFFER_CFG_FLIGHT_THREADS];
+uint32_t              buffer_flight_ring_count_u32;
+uint64_t              buffer_flight_dropped_u64;
+uintptr_t             buffer_flight_pools_au[BUFFER_FLIGHT_POOLS];
+
+static uint32_t       buffer_flight_pool_count_u32;     /**< Pool ids handed out (may exceed the table). */
+static pthread_once_t buffer_flight_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  buffer_flight_key;
+static bool           buffer_flight_has_key;
+
+static BUFFER_PORT_THREAD_LOCAL buffer_flight_ring_st *buffer_flight_ring_sp;
+static BUFFER_PORT_THREAD_LOCAL uint32_t               buffer_flight_misses_u32;
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Give the exiting thread's ring back (pthread key destructor).
+ */
+static void buffer_flight_thread_exit(void *ring_p)
+{
+    buffer_flight_ring_st *ring_sp = (buffer_flight_ring_st *)ring_p;
+
+    /* Later hooks on this thread (other destructors) must not write to it. */
+    buffer_flight_ring_sp = NULL;
+    BUFFER_PORT_STORE_RELEASE(&ring_sp->owned_u32, 0u);
+}
+
+static void buffer_flight_key_create(void)
+{
+    buffer_flight_has_key = (0 == pthread_key_create(&buffer_flight_key, buffer_flight_thread_exit));
+}
+
+/**
+ * @brief Claim a free ring for the calling thread.
+ *
+ * @return The thread's ring, or NULL if all rings are owned.
+ */
+static buffer_flight_ring_st *buffer_flight_claim_ring(void)
+{
+    uint32_t slot;
+
+    (void)pthread_once(&buffer_flight_key_once, buffer_flight_key_create);
+
+    for (slot = 0u; slot < BUFFER_CFG_FLIGHT_THREADS; ++slot)
+    {
+        buffer_flight_ring_st *ring_sp = &buffer_flight_rings_as[slot];
+
+        if ((0u == BUFFER_PORT_LOAD_RELAXED(&ring_sp->owned_u32)) &&
+            (0u == BUFFER_PORT_EXCHANGE(&ring_sp->owned_u32, 1u)))
+        {
+            ring_sp->head_u32   = 0u;
+            ring_sp->thread_u32 = BUFFER_PORT_FETCH_ADD(&buffer_flight_ring_count_u32, 1u) + 1u;
+
+            /* Without a key the ring is never returned, as before. */
+            if (true == buffer_flight_has_key)
+            {
+                (void)pthread_setspecific(buffer_flight_key, ring_sp);
+            }
+
+            buffer_flight_ring_sp = ring_sp;
+            return ring_sp;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief write() all of a buffer, retrying short writes.
+ */
+static bool buffer_flight_write(int fd, void const *data_p, size_t size_bytes)
+{
+    uint8_t const *data_u8p = (uint8_t const *)data_p;
+
+    while (0u < size_bytes)
+    {
+        ssize_t written = write(fd, data_u8p, size_bytes);
+
+        if (0 >= written)
+        {
+            return false;
+        }
+
+        data_u8p   += written;
+        size_bytes -= (size_t)written;
+    }
+
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Recorder API                                                               */
+/* -------------------------------------------------------------------------- */
+
+uint32_t buffer_flight_pool_register(void const *pool_p)
+{
+    uint32_t count = BUFFER_PORT_LOAD_ACQUIRE(&buffer_flight_pool_count_u32);
+    uint32_t slot;
+
+    if (count > BUFFER_FLIGHT_POOLS)
+    {
+        count = BUFFER_FLIGHT_POOLS;
+    }
+
+    for (slot = 0u; slot < count; ++slot)
+    {
+        if ((uintptr_t)pool_p == BUFFER_PORT_LOAD_RELAXED(&buffer_flight_pools_au[slot]))
+        {
+            return slot + 1u;
+        }
+    }
+
+    slot = BUFFER_PORT_FETCH_ADD(&buffer_flight_pool_count_u32, 1u);
+    if (slot >= BUFFER_FLIGHT_POOLS)
+    {
+        return 0u;
+    }
+
+    BUFFER_PORT_STORE_RELEASE(&buffer_flight_pools_au[slot], (uintptr_t)pool_p);
+    return slot + 1u;
+}
+
+void buffer_flight_emit(uint32_t pool_id, buffer_trace_op_et op_e, uint32_t index)
+{
+    buffer_flight_ring_st *ring_sp = buffer_flight_ring_sp;
+    uint32_t               head;
+
+    if (BUFFER_PORT_UNLIKELY(NULL == ring_sp))
+    {
+        /* Rings come back as threads exit: look again now and then. */
+        if (0u == (buffer_flight_misses_u32++ & BUFFER_FLIGHT_RETRY_MASK))
+        {
+            ring_sp = buffer_flight_claim_ring();
+        }
+        if (NULL == ring_sp)
+        {
+            (void)BUFFER_PORT_FETCH_ADD(&buffer_flight_dropped_u64, 1u);
+            return;
+        }
+        buffer_flight_misses_u32 = 0u;
+    }
+
+    head = ring_sp->head_u32;
+    ring_sp->records_au64[head & BUFFER_FLIGHT_RING_MASK] =
+        BUFFER_FLIGHT_PACK(buffer_port_ticks(), op_e, pool_id, index);
+    BUFFER_PORT_STORE_RELEASE(&ring_sp->head_u32, head + 1u);
+}
+
+bool buffer_flight_dump(int fd)
+{
+    buffer_flight_header_st header_s;
+    uint64_t                pool_au64[BUFFER_FLIGHT_POOLS];
+    uint32_t                index;
+
+    /* memset/memcpy are not on the POSIX async-signal-safe list; fill by hand. */
+    for (index = 0u; index < sizeof(header_s.magic_ac); ++index)
+    {
+        header_s.magic_ac[index] = BUFFER_FLIGHT_MAGIC[index];
+    }
+    header_s.version       = BUFFER_FLIGHT_VERSION;
+    header_s.ring_count    = BUFFER_CFG_FLIGHT_THREADS;
+    header_s.ring_records  = BUFFER_CFG_FLIGHT_RECORDS;
+    header_s.ticks_shift   = BUFFER_FLIGHT_TICKS_SHIFT;
+    header_s.pool_count    = BUFFER_FLIGHT_POOLS;
+    header_s.reserved_u32  = 0u;
+    header_s.dropped_u64   = BUFFER_PORT_LOAD_RELAXED(&buffer_flight_dropped_u64);
+    header_s.now_ticks_u64 = buffer_port_ticks();
+
+    for (index = 0u; index < BUFFER_FLIGHT_POOLS; ++index)
+    {
+        pool_au64[index] = (uint64_t)BUFFER_PORT_LOAD_RELAXED(&buffer_flight_pools_au[index]);
+    }
+
+    /* All rings, used or not, so the size never depends on a racing claim. */
+    return (true == buffer_flight_write(fd, &header_s, sizeof(header_s)))   &&
+           (true == buffer_flight_write(fd, pool_au64, sizeof(pool_au64))) &&
+           (true == buffer_flight_write(fd, buffer_flight_rings_as, sizeof(buffer_flight_rings_as)));
+}
@@ -0,0 +1,163 @@
+/**
+ * @file buffer_flight.h
+ * @brief Always-on flight recorder of recent pool events.
+ *
+ * When the library is built with @c BUFFER_CFG_FLIGHT=1, every pool
+ * operation appends one packed 8-byte record to a fixed-size ring owned by
+ * the calling thread, overwriting the oldest record. Nothing is written
+ * out while the program runs; after an incident the rings hold the last
+ * @c BUFFER_CFG_FLIGHT_RECORDS events of each thread.
+ *
+ * The rings are the global @ref buffer_flight_rings_as, so a debugger can
+ * read them from a core file (e.g. @c "p buffer_flight_rings_as[0]" in
+ * gdb), and @ref buffer_flight_dump writes them to a file descriptor using
+ * only write(), so it may be called from a signal handler.
+ * tools/flight_decode.c prints a dump as one merged timeline.
+ *
+ * A thread claims a ring on its first operation and returns it when it
+ * exits, so up to @c BUFFER_CFG_FLIGHT_THREADS threads can record at the
+ * same time over any number of thread lifetimes. A reused ring starts
+ * empty under a new thread number. Events of threads that find no free
+ * ring are counted in @ref buffer_flight_dropped_u64.
+ *
+ * Record layout (@ref BUFFER_FLIGHT_PACK):
+ *  - bits 63..32: timestamp ticks >> @ref BUFFER_FLIGHT_TICKS_SHIFT (32 bits)
+ *  - bits 31..28: operation (@ref buffer_trace_op_et)
+ *  - bits 27..22: pool id (@ref buffer_flight_pool_register), 0 if none
+ *  - bits 21..0:  buffer index, @ref BUFFER_FLIGHT_INDEX_NONE if none
+ * The timestamp field wraps every 2^38 ticks (about 90 s at 3 GHz); the
+ * dump carries the time it was taken, so ages are exact for events younger
+ * than that.
+ */
+
+#ifndef BUFFER_FLIGHT_H_
+#define BUFFER_FLIGHT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "buffer.h"
+#include "buffer_trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Rings, i.e. threads that can record at the same time. */
+#ifndef BUFFER_CFG_FLIGHT_THREADS
+#define BUFFER_CFG_FLIGHT_THREADS    (32u)
+#endif
+
+/** Records per thread ring (power of two). */
+#ifndef BUFFER_CFG_FLIGHT_RECORDS
+#define BUFFER_CFG_FLIGHT_RECORDS    (1024u)
+#endif
+
+#define BUFFER_FLIGHT_MAGIC          "BUFLIGHT"      /**< Dump magic, 8 bytes without terminator. */
+#define BUFFER_FLIGHT_VERSION        (2u)
+#define BUFFER_FLIGHT_TICKS_SHIFT    (6u)            /**< Timestamp resolution is 64 ticks. */
+#define BUFFER_FLIGHT_INDEX_NONE     (0x3FFFFFu)     /**< Also the index of buffers beyond 4M - 2. */
+#define BUFFER_FLIGHT_POOLS          (63u)           /**< Pool ids 1..63; later pools record id 0. */
+
+/** Pack one record. */
+#define BUFFER_FLIGHT_PACK(ticks, op, pool, index)                                  \
+    ((((uint64_t)(ticks) >> BUFFER_FLIGHT_TICKS_SHIFT) << 32) |                     \
+     (((uint64_t)(op) & 0xFu) << 28)                         |                      \
+     (((uint64_t)(pool) & 0x3Fu) << 22)                      |                      \
+     ((uint64_t)(index) & 0x3FFFFFu))
+
+#define BUFFER_FLIGHT_STAMP(record)  ((uint32_t)((record) >> 32))
+#define BUFFER_FLIGHT_OP(record)     ((uint32_t)((record) >> 28) & 0xFu)
+#define BUFFER_FLIGHT_POOL(record)   ((uint32_t)((record) >> 22) & 0x3Fu)
+#define BUFFER_FLIGHT_INDEX(record)  ((uint32_t)(record) & 0x3FFFFFu)
+
+/** Ticks between a record and @p now_ticks (e.g. the dump time), modulo the stamp period. */
+#define BUFFER_FLIGHT_AGE(now_ticks, record)                                        \
+    ((uint64_t)(uint32_t)((uint32_t)((uint64_t)(now_ticks) >> BUFFER_FLIGHT_TICKS_SHIFT) - \
+                          BUFFER_FLIGHT_STAMP(record)) << BUFFER_FLIGHT_TICKS_SHIFT)
+
+/**
+ * @brief Ring of one thread.
+ *
+ * Record @c head_u32 - 1 is the newest; the ring holds
+ * min(head_u32, BUFFER_CFG_FLIGHT_RECORDS) valid records.
+ */
+typedef struct
+{
+    uint32_t head_u32;                       /**< Records written so far (wraps). */
+    uint32_t thread_u32;                     /**< Thread number from 1 in order of claim, 0 if never used. */
+    uint32_t owned_u32;                      /**< 1 while a live thread owns the ring. */
+    uint32_t reserved_u32;
+    uint64_t records_au64[BUFFER_CFG_FLIGHT_RECORDS];
+} buffer_flight_ring_st;
+
+/**
+ * @brief Dump file header.
+ *
+ * Followed by @ref pool_count pool addresses (@c uint64_t, entry N - 1 for
+ * pool id N, 0 if unused) and then @ref ring_count rings.
+ */
+typedef struct
+{
+    char     magic_ac[8];                    /**< @ref BUFFER_FLIGHT_MAGIC. */
+    uint32_t version;                        /**< @ref BUFFER_FLIGHT_VERSION. */
+    uint32_t ring_count;                     /**< Rings that follow, used or not. */
+    uint32_t ring_records;                   /**< @c BUFFER_CFG_FLIGHT_RECORDS. */
+    uint32_t ticks_shift;                    /**< @ref BUFFER_FLIGHT_TICKS_SHIFT. */
+    uint32_t pool_count;                     /**< @ref BUFFER_FLIGHT_POOLS. */
+    uint32_t reserved_u32;
+    uint64_t dropped_u64;                    /**< @ref buffer_flight_dropped_u64 at dump time. */
+    uint64_t now_ticks_u64;                  /**< Timestamp of the dump. */
+} buffer_flight_header_st;
+
+/** All rings; those with a non-zero @c thread_u32 have been used. */
+extern buffer_flight_ring_st buffer_flight_rings_as[BUFFER_CFG_FLIGHT_THREADS];
+
+/** Rings claimed so far, counting reuse (the last thread number handed out). */
+extern uint32_t buffer_flight_ring_count_u32;
+
+/** Events not recorded because their thread found no free ring. */
+extern uint64_t buffer_flight_dropped_u64;
+
+/** Address of the pool with id N at index N - 1, 0 if unused. */
+extern uintptr_t buffer_flight_pools_au[BUFFER_FLIGHT_POOLS];
+
+/**
+ * @brief Pool id recorded with the events of the pool at @p pool_p.
+ *
+ * Called by @ref buffer_pool_init. The same address always gets the same
+ * id, so re-initializing a pool does not use up ids.
+ *
+ * @return 1 .. @ref BUFFER_FLIGHT_POOLS, or 0 once all ids are taken.
+ */
+uint32_t buffer_flight_pool_register(void const *pool_p);
+
+/**
+ * @brief Append one record to the calling thread's ring.
+ *
+ * Called by the hooks in buffer.c.
+ *
+ * @param[in] pool_id  Id from @ref buffer_flight_pool_register.
+ * @param[in] op_e     Operation.
+ * @param[in] index    Buffer index, or @ref BUFFER_FLIGHT_INDEX_NONE.
+ */
+void buffer_flight_emit(uint32_t pool_id, buffer_trace_op_et op_e, uint32_t index);
+
+/**
+ * @brief Write all rings to a file descriptor.
+ *
+ * Async-signal-safe: uses only write() (and the clock for the dump time).
+ * Records written concurrently by other threads may be torn or missing.
+ *
+ * @param[in] fd  Open file descriptor.
+ *
+ * @return true if everything was written.
+ */
+bool buffer_flight_dump(int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_FLIGHT_H_ */
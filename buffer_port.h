@@ -0,0 +1,156 @@
+/**
+ * @file buffer_port.h
+ * @brief Internal porting layer: timestamps, thread-local storage, atomics
+ *        and compiler builtins.
+ *
+ * Only used by the library sources; not part of the public API.
+ *
+ * Timestamps come from the CPU cycle counter where one is known (x86 TSC,
+ * AArch64 CNTVCT). Other targets can provide their own free-running counter
+ * by defining @c BUFFER_CFG_TICKS() (e.g. a DWT cycle counter on Cortex-M);
+ * without one, @ref BUFFER_PORT_HAS_TICKS is 0 and timestamps read as zero.
+ */
+
+#ifndef BUFFER_PORT_H_
+#define BUFFER_PORT_H_
+
+#include <stdint.h>
+
+/* -------------------------------------------------------------------------- */
+/* Timestamps                                                                 */
+/* -------------------------------------------------------------------------- */
+
+#if defined(BUFFER_CFG_TICKS)
+#define BUFFER_PORT_HAS_TICKS    (1)
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__))
+#define BUFFER_PORT_HAS_TICKS    (1)
+#else
+#define BUFFER_PORT_HAS_TICKS    (0)
+#endif
+
+/**
+ * @brief Read the free-running timestamp counter.
+ *
+ * @return Counter value, or 0 when @ref BUFFER_PORT_HAS_TICKS is 0.
+ */
+static inline uint64_t buffer_port_ticks(void)
+{
+#if defined(BUFFER_CFG_TICKS)
+    return (uint64_t)BUFFER_CFG_TICKS();
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    uint32_t lo_u32;
+    uint32_t hi_u32;
+    __asm__ __volatile__("rdtsc" : "=a"(lo_u32), "=d"(hi_u32));
+    return ((uint64_t)hi_u32 << 32) | lo_u32;
+#elif defined(__GNUC__) && defined(__aarch64__)
+    uint64_t value_u64;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(value_u64));
+    return value_u64;
+#else
+    return 0u;
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+/* Bit operations                                                             */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Index of the most significant set bit.
+ *
+ * @param[in] value  Non-zero value.
+ */
+static inline uint32_t buffer_port_msb64(uint64_t value)
+{
+#if defined(__GNUC__)
+    return 63u - (uint32_t)__builtin_clzll(value);
+#else
+    uint32_t msb = 0u;
+
+    while (1u < value)
+    {
+        value >>= 1;
+        ++msb;
+    }
+    return msb;
+#endif
+}
+
+/**
+ * @brief Index of the lowest set bit.
+ *
+ * @param[in] value  Non-zero value.
+ */
+static inline uint32_t buffer_port_lsb64(uint64_t value)
+{
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_ctzll(value);
+#else
+    uint32_t lsb = 0u;
+
+    while (0u == (value & 1u))
+    {
+        value >>= 1;
+        ++lsb;
+    }
+    return lsb;
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+/* Thread-local storage                                                       */
+/* -------------------------------------------------------------------------- */
+
+#if defined(BUFFER_CFG_THREAD_LOCAL)
+#define BUFFER_PORT_THREAD_LOCAL BUFFER_CFG_THREAD_LOCAL
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_THREADS__)
+#define BUFFER_PORT_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define BUFFER_PORT_THREAD_LOCAL __thread
+#else
+#define BUFFER_PORT_THREAD_LOCAL /* single-threaded target */
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* Atomics and compiler builtins                                              */
+/* -------------------------------------------------------------------------- */
+
+#if defined(__GNUC__)
+#define BUFFER_PORT_LOAD_RELAXED(p)          __atomic_load_n((p), __ATOMIC_RELAXED)
+#define BUFFER_PORT_LOAD_ACQUIRE(p)          __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define BUFFER_PORT_STORE_RELAXED(p, v)      __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define BUFFER_PORT_STORE_RELEASE(p, v)      __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define BUFFER_PORT_FETCH_ADD(p, v)          __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#define BUFFER_PORT_EXCHANGE(p, v)           __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#define BUFFER_PORT_FENCE_ACQUIRE()          __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define BUFFER_PORT_FENCE_RELEASE()          __atomic_thread_fence(__ATOMIC_RELEASE)
+#define BUFFER_PORT_RETURN_ADDRESS()         ((uintptr_t)__builtin_return_address(0))
+#define BUFFER_PORT_LIKELY(x)                __builtin_expect(!!(x), 1)
+#define BUFFER_PORT_UNLIKELY(x)              __builtin_expect(!!(x), 0)
+#define BUFFER_PORT_PREFETCH_WRITE(p)        __builtin_prefetch((p), 1, 3)
+#else
+/* Single-core targets without GNU atomics: plain volatile accesses. */
+#define BUFFER_PORT_LOAD_RELAXED(p)          (*(p))
+#define BUFFER_PORT_LOAD_ACQUIRE(p)          (*(p))
+#define BUFFER_PORT_STORE_RELAXED(p, v)      (*(p) = (v))
+#define BUFFER_PORT_STORE_RELEASE(p, v)      (*(p) = (v))
+#define BUFFER_PORT_FETCH_ADD(p, v)          ((*(p) += (v)) - (v))
+#define BUFFER_PORT_EXCHANGE(p, v)           buffer_port_exchange_u32((p), (v))
+#define BUFFER_PORT_FENCE_ACQUIRE()          do { } while (0)
+#define BUFFER_PORT_FENCE_RELEASE()          do { } while (0)
+#define BUFFER_PORT_RETURN_ADDRESS()         ((uintptr_t)1u)    /* unknown caller */
+#define BUFFER_PORT_LIKELY(x)                (x)
+#define BUFFER_PORT_UNLIKELY(x)              (x)
+#define BUFFER_PORT_PREFETCH_WRITE(p)        ((void)(p))
+
+/** Exchange without atomics (32-bit values only). */
+static inline uint32_t buffer_port_exchange_u32(uint32_t volatile *value_u32p, uint32_t value_u32)
+{
+    uint32_t previous_u32 = *value_u32p;
+
+    *value_u32p = value_u32;
+    return previous_u32;
+}
+#endif
+
+#endif /* BUFFER_PORT_H_ */
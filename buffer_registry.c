@@ -0,0 +1,300 @@
+/**
+ * @file buffer_registry.c
+ * @brief Process-wide map from a data pointer to its buffer array context.
+ */
+
+#include "buffer_registry.h"
+#include "buffer_port.h"
+
+
+#define BUFFER_REGISTRY_FANOUT       ((size_t)1u << BUFFER_REGISTRY_LEVEL_BITS)
+#define BUFFER_REGISTRY_KEY_BITS     (BUFFER_REGISTRY_LEVELS * BUFFER_REGISTRY_LEVEL_BITS)
+
+/**
+ * @brief One registered context and the address range of its block.
+ */
+typedef struct
+{
+    buffer_array_ctx_st *ctx_sp;     /**< NULL when the slot is free. */
+    uintptr_t            start;      /**< First byte of the block. */
+    uintptr_t            end;        /**< One past the last byte. */
+} buffer_registry_entry_st;
+
+/**
+ * @brief Tree node: children of an interior node, entries of a leaf.
+ */
+typedef struct
+{
+    void *slot_ap[BUFFER_REGISTRY_FANOUT];
+} buffer_registry_node_st;
+
+/* -------------------------------------------------------------------------- */
+/* Static Data                                                                */
+/* -------------------------------------------------------------------------- */
+
+static buffer_registry_node_st  buffer_registry_root_s;
+static buffer_registry_node_st  buffer_registry_nodes_as[BUFFER_CFG_REGISTRY_NODES];
+static size_t                   buffer_registry_node_count;
+static buffer_registry_entry_st buffer_registry_entries_as[BUFFER_CFG_REGISTRY_MAX_CTX];
+
+/** Leaf value of a page shared by several contexts. */
+static buffer_registry_entry_st buffer_registry_ambiguous_s;
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+static size_t buffer_registry_level_index(uint64_t page, uint32_t level)
+{
+    uint32_t shift = (BUFFER_REGISTRY_LEVELS - 1u - level) * BUFFER_REGISTRY_LEVEL_BITS;
+
+    return (size_t)((page >> shift) & (BUFFER_REGISTRY_FANOUT - 1u));
+}
+
+/**
+ * @brief Return the leaf slot of a page.
+ *
+ * @param[in] page       Address >> @c BUFFER_REGISTRY_PAGE_BITS.
+ * @param[in] is_create  Allocate missing nodes from the static pool.
+ *
+ * @return Slot, or NULL if a node is missing and was not (or could not be)
+ *         created.
+ */
+static void **buffer_registry_leaf_slot(uint64_t page, bool is_create)
+{
+    buffer_registry_node_st *node_sp = &buffer_registry_root_s;
+    uint32_t                 level;
+
+    for (level = 0u; level < (BUFFER_REGISTRY_LEVELS - 1u); ++level)
+    {
+        void                   **slot_pp  = &node_sp->slot_ap[buffer_registry_level_index(page, level)];
+        buffer_registry_node_st *child_sp = (buffer_registry_node_st *)*slot_pp;
+
+        if (NULL == child_sp)
+        {
+            if ((false == is_create) || (buffer_registry_node_count >= BUFFER_CFG_REGISTRY_NODES))
+            {
+                return NULL;
+            }
+
+            /* Static nodes start zeroed, so publishing the pointer is enough. */
+            child_sp = &buffer_registry_nodes_as[buffer_registry_node_count];
+            buffer_registry_node_count++;
+            BUFFER_PORT_STORE_RELEASE(slot_pp, (void *)child_sp);
+        }
+
+        node_sp = child_sp;
+    }
+
+    return &node_sp->slot_ap[buffer_registry_level_index(page, BUFFER_REGISTRY_LEVELS - 1u)];
+}
+
+/**
+ * @brief Recompute the leaf value of a page from the registered entries.
+ *
+ * @return Entry value: NULL, the only entry touching the page, or the
+ *         ambiguous marker.
+ */
+static void *buffer_registry_page_owner(uint64_t page)
+{
+    uintptr_t page_start = (uintptr_t)(page << BUFFER_REGISTRY_PAGE_BITS);
+    uintptr_t page_end   = page_start + ((uintptr_t)1u << BUFFER_REGISTRY_PAGE_BITS);
+    void     *owner_p    = NULL;
+    size_t    slot;
+
+    for (slot = 0u; slot < BUFFER_CFG_REGISTRY_MAX_CTX; ++slot)
+    {
+        buffer_registry_entry_st *entry_sp = &buffer_registry_entries_as[slot];
+
+        if ((NULL != entry_sp->ctx_sp) && (entry_sp->start < page_end) && (entry_sp->end > page_start))
+        {
+            if (NULL != owner_p)
+            {
+                return &buffer_registry_ambiguous_s;
+            }
+            owner_p = entry_sp;
+        }
+    }
+
+    return owner_p;
+}
+
+/**
+ * @brief Refresh the leaf values of all pages of a range.
+ *
+ * @return false if a leaf could not be created.
+ */
+static bool buffer_registry_update_range(uintptr_t start, uintptr_t end, bool is_create)
+{
+    uint64_t page;
+    uint64_t last = (uint64_t)(end - 1u) >> BUFFER_REGISTRY_PAGE_BITS;
+
+    for (page = (uint64_t)start >> BUFFER_REGISTRY_PAGE_BITS; page <= last; ++page)
+    {
+        void **slot_pp = buffer_registry_leaf_slot(page, is_create);
+
+        if (NULL == slot_pp)
+        {
+            if (true == is_create)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        BUFFER_PORT_STORE_RELEASE(slot_pp, buffer_registry_page_owner(page));
+    }
+
+    return true;
+}
+
+static buffer_registry_entry_st *buffer_registry_entry_of(buffer_array_ctx_st const *ctx_csp)
+{
+    size_t slot;
+
+    for (slot = 0u; slot < BUFFER_CFG_REGISTRY_MAX_CTX; ++slot)
+    {
+        if (ctx_csp == buffer_registry_entries_as[slot].ctx_sp)
+        {
+            return &buffer_registry_entries_as[slot];
+        }
+    }
+
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Registry API                                                               */
+/* -------------------------------------------------------------------------- */
+
+bool buffer_registry_add(buffer_array_ctx_st *ctx_sp)
+{
+    buffer_registry_entry_st *entry_sp;
+    uintptr_t                 start;
+    uintptr_t                 end;
+
+    if ((NULL == ctx_sp) || (false == ctx_sp->is_initialized) ||
+        (NULL != buffer_registry_entry_of(ctx_sp)))
+    {
+        return false;
+    }
+
+    start = (uintptr_t)ctx_sp->memory_block_u8p;
+    end   = start + (ctx_sp->buffer_count * ctx_sp->buffer_size);
+
+    if ((end <= start) ||
+        (0u != ((uint64_t)(end - 1u) >> (BUFFER_REGISTRY_KEY_BITS + BUFFER_REGISTRY_PAGE_BITS))))
+    {
+        return false;
+    }
+
+    entry_sp = buffer_registry_entry_of(NULL);
+    if (NULL == entry_sp)
+    {
+        return false;
+    }
+
+    entry_sp->start  = start;
+    entry_sp->end    = end;
+    entry_sp->ctx_sp = ctx_sp;
+
+    if (false == buffer_registry_update_range(start, end, true))
+    {
+        /* Out of nodes: undo the pages already mapped. */
+        entry_sp->ctx_sp = NULL;
+        (void)buffer_registry_update_range(start, end, false);
+        return false;
+    }
+
+    return true;
+}
+
+void buffer_registry_remove(buffer_array_ctx_st const *ctx_csp)
+{
+    buffer_registry_entry_st *entry_sp;
+
+    if (NULL == ctx_csp)
+    {
+        return;
+    }
+
+    entry_sp = buffer_registry_entry_of(ctx_csp);
+    if (NULL == entry_sp)
+    {
+        return;
+    }
+
+    entry_sp->ctx_sp = NULL;
+    (void)buffer_registry_update_range(entry_sp->start, entry_sp->end, false);
+}
+
+buffer_array_ctx_st *buffer_registry_lookup(void const *memory_p, size_t *index_out_p)
+{
+    uintptr_t                       address = (uintptr_t)memory_p;
+    uint64_t                        page    = (uint64_t)address >> BUFFER_REGISTRY_PAGE_BITS;
+    buffer_registry_node_st const  *node_csp = &buffer_registry_root_s;
+    buffer_registry_entry_st const *entry_csp;
+    uint32_t                        level;
+
+    if (0u != (page >> BUFFER_REGISTRY_KEY_BITS))
+    {
+        return NULL;
+    }
+
+    for (level = 0u; level < (BUFFER_REGISTRY_LEVELS - 1u); ++level)
+    {
+        node_csp = (buffer_registry_node_st const *)BUFFER_PORT_LOAD_ACQUIRE(
+            &node_csp->slot_ap[buffer_registry_level_index(page, level)]);
+        if (NULL == node_csp)
+        {
+            return NULL;
+        }
+    }
+
+    entry_csp = (buffer_registry_entry_st const *)BUFFER_PORT_LOAD_ACQUIRE(
+        &node_csp->slot_ap[buffer_registry_level_index(page, BUFFER_REGISTRY_LEVELS - 1u)]);
+
+    if (BUFFER_PORT_UNLIKELY(&buffer_registry_ambiguous_s == entry_csp))
+    {
+        size_t slot;
+
+        entry_csp = NULL;
+        for (slot = 0u; slot < BUFFER_CFG_REGISTRY_MAX_CTX; ++slot)
+        {
+            buffer_registry_entry_st const *candidate_csp = &buffer_registry_entries_as[slot];
+
+            if ((NULL != candidate_csp->ctx_sp) && (address >= candidate_csp->start) && (address < candidate_csp->end))
+            {
+                entry_csp = candidate_csp;
+                break;
+            }
+        }
+    }
+
+    /* A page can be shared with unregistered memory: check the range too. */
+    if ((NULL == entry_csp) || (address < entry_csp->start) || (address >= entry_csp->end))
+    {
+        return NULL;
+    }
+
+    if (NULL != index_out_p)
+    {
+        *index_out_p = (size_t)(address - entry_csp->start) / entry_csp->ctx_sp->buffer_size;
+    }
+
+    return entry_csp->ctx_sp;
+}
+
+bool buffer_release_any(uint8_t *memory_u8p)
+{
+    buffer_array_ctx_st *ctx_sp;
+    size_t               index;
+
+    ctx_sp = buffer_registry_lookup(memory_u8p, &index);
+    if ((NULL == ctx_sp) || (ctx_sp->buffer_array_sa[index].data_u8p != memory_u8p))
+    {
+        return false;
+    }
+
+    return buffer_pool_release(&ctx_sp->pool_s, &ctx_sp->buffer_array_sa[index]);
+}
@@ -0,0 +1,98 @@
+/**
+ * @file buffer_registry.h
+ * @brief Process-wide map from a data pointer to its buffer array context.
+ *
+ * Registered contexts are indexed by the address of every 4 KiB page of
+ * their memory block in a three-level radix tree (12 address bits per
+ * level, bits 47..12), so a lookup costs three dependent loads whatever
+ * the number of pools. The owning buffer index then follows from the
+ * offset in the block. A page shared by two contexts (blocks that are not
+ * page aligned) is marked ambiguous and resolved by a range check over the
+ * registered contexts.
+ *
+ * Tree nodes come from a static pool of @c BUFFER_CFG_REGISTRY_NODES
+ * nodes; one leaf covers 16 MiB and one middle node 64 GiB of address
+ * space. Nodes are never freed, so the pool bounds the total address span
+ * ever registered, not the number of live contexts. A block of up to
+ * 16 MiB needs at most two leaves and one middle node, hence the default
+ * of three nodes per context: every one of @c BUFFER_CFG_REGISTRY_MAX_CTX
+ * separately mapped pools fits, while larger blocks need one more leaf per
+ * 16 MiB. The pool is zero-initialized storage, so untouched nodes cost
+ * address space only.
+ *
+ * Concurrency: @ref buffer_registry_lookup and @ref buffer_release_any may
+ * run on any thread while contexts are added. Adding and removing contexts
+ * must be serialized by the caller, and a context may only be removed once
+ * no thread can still release one of its buffers. Releasing itself follows
+ * the usual single-writer rule of the owning pool.
+ */
+
+#ifndef BUFFER_REGISTRY_H_
+#define BUFFER_REGISTRY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of registered contexts. */
+#ifndef BUFFER_CFG_REGISTRY_MAX_CTX
+#define BUFFER_CFG_REGISTRY_MAX_CTX  (64u)
+#endif
+
+/** Interior and leaf nodes available to the tree (32 KiB each on LP64). */
+#ifndef BUFFER_CFG_REGISTRY_NODES
+#define BUFFER_CFG_REGISTRY_NODES    (3u * BUFFER_CFG_REGISTRY_MAX_CTX)
+#endif
+
+#define BUFFER_REGISTRY_PAGE_BITS    (12u)   /**< Granularity of the map: 4 KiB. */
+#define BUFFER_REGISTRY_LEVEL_BITS   (12u)   /**< Address bits resolved per level. */
+#define BUFFER_REGISTRY_LEVELS       (3u)    /**< Covers 48-bit addresses. */
+
+/**
+ * @brief Register a context so that its buffers can be found by address.
+ *
+ * @param[in] ctx_sp  Initialized context; must stay valid until removed.
+ *
+ * @return false if the context is invalid or already registered, the
+ *         context table or node pool is full, or the block lies above the
+ *         48-bit address range.
+ */
+bool buffer_registry_add(buffer_array_ctx_st *ctx_sp);
+
+/**
+ * @brief Remove a registered context.
+ */
+void buffer_registry_remove(buffer_array_ctx_st const *ctx_csp);
+
+/**
+ * @brief Find the context and buffer index owning an address.
+ *
+ * @param[in]  memory_p     Any address inside a registered block.
+ * @param[out] index_out_p  Buffer index within the context, may be NULL.
+ *
+ * @return Owning context, or NULL if the address is not registered.
+ */
+buffer_array_ctx_st *buffer_registry_lookup(void const *memory_p, size_t *index_out_p);
+
+/**
+ * @brief Release a buffer of any registered context by its data pointer.
+ *
+ * @param[in] memory_u8p  Start of the buffer's data, as returned by acquire.
+ *
+ * @return true  if the pointer is the start of a buffer of a registered
+ *               context and the buffer was marked free.
+ * @return false otherwise.
+ */
+bool buffer_release_any(uint8_t *memory_u8p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_REGISTRY_H_ */
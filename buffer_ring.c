@@ -0,0 +1,231 @@
+/**
+ * @file buffer_ring.c
+ * @brief NIC-style RX descriptor ring over a buffer array.
+ */
+
+#include "buffer_ring.h"
+#include "buffer_port.h"
+
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+static bool buffer_ring_is_valid(buffer_ring_st const *ring_csp)
+{
+    return ((NULL != ring_csp) && (true == ring_csp->is_initialized));
+}
+
+/* -------------------------------------------------------------------------- */
+/* Driver API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+bool buffer_ring_init(buffer_ring_st *ring_sp,
+                      buffer_array_ctx_st *ctx_sp,
+                      buffer_ring_desc_st *desc_as,
+                      buffer_st **buffer_asp,
+                      uint32_t size_u32,
+                      uint32_t refill_threshold)
+{
+    if ((NULL == ring_sp)    || (NULL == ctx_sp) || (false == ctx_sp->is_initialized) ||
+        (NULL == desc_as)    || (NULL == buffer_asp)                                   ||
+        (0u == size_u32)     || (0u != (size_u32 & (size_u32 - 1u)))                   ||
+        (0u == refill_threshold) || (refill_threshold > size_u32))
+    {
+        return false;
+    }
+
+    memset(ring_sp, 0, sizeof(*ring_sp));
+    memset(desc_as, 0, size_u32 * sizeof(buffer_ring_desc_st));
+    memset(buffer_asp, 0, size_u32 * sizeof(buffer_st *));
+
+    ring_sp->ctx_sp               = ctx_sp;
+    ring_sp->desc_as              = desc_as;
+    ring_sp->buffer_asp           = buffer_asp;
+    ring_sp->size_u32             = size_u32;
+    ring_sp->mask_u32             = size_u32 - 1u;
+    ring_sp->refill_threshold_u32 = refill_threshold;
+    ring_sp->is_initialized       = true;
+
+    (void)buffer_ring_refill(ring_sp);
+    return true;
+}
+
+void buffer_ring_deinit(buffer_ring_st *ring_sp)
+{
+    uint32_t index;
+
+    if (false == buffer_ring_is_valid(ring_sp))
+    {
+        return;
+    }
+
+    for (index = ring_sp->next_to_clean_u32; index != ring_sp->next_to_use_u32; ++index)
+    {
+        uint32_t slot = index & ring_sp->mask_u32;
+
+        (void)buffer_pool_release(&ring_sp->ctx_sp->pool_s, ring_sp->buffer_asp[slot]);
+        ring_sp->buffer_asp[slot]         = NULL;
+        ring_sp->desc_as[slot].flags_u16 = 0u;
+    }
+
+    ring_sp->is_initialized = false;
+}
+
+size_t buffer_ring_refill(buffer_ring_st *ring_sp)
+{
+    uint32_t first;
+    uint32_t index;
+
+    if (false == buffer_ring_is_valid(ring_sp))
+    {
+        return 0u;
+    }
+
+    first = ring_sp->next_to_use_u32;
+
+    while ((uint32_t)(ring_sp->next_to_use_u32 - ring_sp->next_to_clean_u32) < ring_sp->size_u32)
+    {
+        uint32_t             slot = ring_sp->next_to_use_u32 & ring_sp->mask_u32;
+        buffer_ring_desc_st *desc_sp;
+        buffer_st           *buffer_sp = buffer_array_acquire(ring_sp->ctx_sp);
+
+        if (NULL == buffer_sp)
+        {
+            ring_sp->refill_shortfalls++;
+            break;
+        }
+
+        desc_sp               = &ring_sp->desc_as[slot];
+        desc_sp->data_u8p     = buffer_sp->data_u8p;
+        desc_sp->capacity_u32 = (buffer_sp->capacity_bytes > UINT32_MAX) ? UINT32_MAX
+                                                                         : (uint32_t)buffer_sp->capacity_bytes;
+        desc_sp->length_u32   = 0u;
+        desc_sp->status_u16   = BUFFER_RING_STATUS_OK;
+
+        ring_sp->buffer_asp[slot] = buffer_sp;
+        ring_sp->next_to_use_u32++;
+    }
+
+    if (first == ring_sp->next_to_use_u32)
+    {
+        return 0u;
+    }
+
+    /* One fence publishes the whole batch; the ownership flags that follow
+     * need no ordering of their own. */
+    BUFFER_PORT_FENCE_RELEASE();
+    for (index = first; index != ring_sp->next_to_use_u32; ++index)
+    {
+        BUFFER_PORT_STORE_RELAXED(&ring_sp->desc_as[index & ring_sp->mask_u32].flags_u16, (uint16_t)BUFFER_RING_OWN);
+    }
+
+    ring_sp->refills++;
+    return (size_t)(uint32_t)(ring_sp->next_to_use_u32 - first);
+}
+
+size_t buffer_ring_harvest(buffer_ring_st *ring_sp, buffer_ring_rx_st *rx_as, size_t max_rx)
+{
+    size_t   count = 0u;
+    size_t   index;
+    uint32_t pending;
+
+    if ((false == buffer_ring_is_valid(ring_sp)) || (NULL == rx_as))
+    {
+        return 0u;
+    }
+
+    pending = ring_sp->next_to_use_u32 - ring_sp->next_to_clean_u32;
+    if (max_rx > pending)
+    {
+        max_rx = pending;
+    }
+
+    /* Count completions first, then order all their reads with one fence. */
+    while (count < max_rx)
+    {
+        uint32_t slot = (ring_sp->next_to_clean_u32 + (uint32_t)count) & ring_sp->mask_u32;
+
+        if (0u != (BUFFER_PORT_LOAD_RELAXED(&ring_sp->desc_as[slot].flags_u16) & BUFFER_RING_OWN))
+        {
+            break;
+        }
+        count++;
+    }
+
+    if (0u != count)
+    {
+        BUFFER_PORT_FENCE_ACQUIRE();
+
+        for (index = 0u; index < count; ++index)
+        {
+            uint32_t                   slot     = ring_sp->next_to_clean_u32 & ring_sp->mask_u32;
+            buffer_ring_desc_st const *desc_csp = &ring_sp->desc_as[slot];
+
+            rx_as[index].buffer_sp  = ring_sp->buffer_asp[slot];
+            rx_as[index].length_u32 = desc_csp->length_u32;
+            rx_as[index].status_u16 = desc_csp->status_u16;
+
+            ring_sp->buffer_asp[slot] = NULL;
+            ring_sp->next_to_clean_u32++;
+        }
+
+        ring_sp->harvested += count;
+    }
+
+    if (buffer_ring_posted(ring_sp) < ring_sp->refill_threshold_u32)
+    {
+        (void)buffer_ring_refill(ring_sp);
+    }
+
+    return count;
+}
+
+uint32_t buffer_ring_posted(buffer_ring_st const *ring_csp)
+{
+    if (false == buffer_ring_is_valid(ring_csp))
+    {
+        return 0u;
+    }
+
+    return ring_csp->next_to_use_u32 - ring_csp->next_to_clean_u32;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Device API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+buffer_ring_desc_st *buffer_ring_device_peek(buffer_ring_st *ring_sp)
+{
+    buffer_ring_desc_st *desc_sp;
+
+    if (false == buffer_ring_is_valid(ring_sp))
+    {
+        return NULL;
+    }
+
+    desc_sp = &ring_sp->desc_as[ring_sp->device_next_u32 & ring_sp->mask_u32];
+
+    return (0u != (BUFFER_PORT_LOAD_ACQUIRE(&desc_sp->flags_u16) & BUFFER_RING_OWN)) ? desc_sp : NULL;
+}
+
+void buffer_ring_device_complete(buffer_ring_st *ring_sp, uint32_t length_u32, uint16_t status_u16)
+{
+    buffer_ring_desc_st *desc_sp;
+
+    if (false == buffer_ring_is_valid(ring_sp))
+    {
+        return;
+    }
+
+    desc_sp             = &ring_sp->desc_as[ring_sp->device_next_u32 & ring_sp->mask_u32];
+    desc_sp->length_u32 = (length_u32 > desc_sp->capacity_u32) ? desc_sp->capacity_u32 : length_u32;
+    desc_sp->status_u16 = status_u16;
+
+    /* Hand the descriptor back: length and status are visible with the flag. */
+    BUFFER_PORT_STORE_RELEASE(&desc_sp->flags_u16, (uint16_t)0u);
+
+    ring_sp->device_next_u32++;
+    ring_sp->device_completed++;
+}
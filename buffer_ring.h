@@ -0,0 +1,163 @@
+/**
+ * @file buffer_ring.h
+ * @brief NIC-style RX descriptor ring over a buffer array.
+ *
+ * The driver posts free buffers of a @ref buffer_array_ctx_st into a ring
+ * of descriptors and hands each one to the device by setting its
+ * @ref BUFFER_RING_OWN flag. The device fills the buffers in ring order,
+ * writes the received length and a status, and clears the flag. The
+ * driver then harvests the completed descriptors in ring order and in
+ * batches, passing their buffers to the caller, and posts fresh buffers
+ * from the pool only once fewer than @c refill_threshold descriptors are
+ * still with the device, so the pool and the ring are touched once per
+ * batch rather than once per buffer.
+ *
+ * The device side is either real hardware writing @ref buffer_ring_desc_st
+ * (place @c desc_as in DMA memory) or a thread using
+ * @ref buffer_ring_device_peek and @ref buffer_ring_device_complete, as in
+ * bench/bench_ring.c. The driver functions follow the pool's single-writer
+ * rule and run on one thread; a posted batch is published with one
+ * release fence.
+ *
+ * Harvested buffers belong to the caller, who releases them to the context
+ * (e.g. @ref buffer_array_release_by_ptr) when done.
+ */
+
+#ifndef BUFFER_RING_H_
+#define BUFFER_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUFFER_RING_OWN          (0x0001u)   /**< Descriptor is owned by the device. */
+
+#define BUFFER_RING_STATUS_OK    (0u)        /**< Buffer received without error. */
+
+/**
+ * @brief Descriptor shared with the device.
+ */
+typedef struct
+{
+    uint8_t           *data_u8p;     /**< Buffer to receive into (written by the driver). */
+    uint32_t           capacity_u32; /**< Its capacity (written by the driver). */
+    uint32_t           length_u32;   /**< Bytes received (written by the device). */
+    uint16_t           status_u16;   /**< @ref BUFFER_RING_STATUS_OK or a device code. */
+    uint16_t           flags_u16;    /**< @ref BUFFER_RING_OWN while posted. */
+} buffer_ring_desc_st;
+
+/**
+ * @brief Completed descriptor, as returned by @ref buffer_ring_harvest.
+ */
+typedef struct
+{
+    buffer_st         *buffer_sp;    /**< Received buffer, now held by the caller. */
+    uint32_t           length_u32;   /**< Bytes received. */
+    uint16_t           status_u16;   /**< Device status. */
+} buffer_ring_rx_st;
+
+/**
+ * @brief Descriptor ring state.
+ *
+ * Driver and device fields sit on separate cache lines. Indices are
+ * free-running; the slot is the index masked by @c mask_u32.
+ */
+typedef struct
+{
+    buffer_array_ctx_st *ctx_sp;
+    buffer_ring_desc_st *desc_as;            /**< Shared descriptors, @c size_u32 entries. */
+    buffer_st          **buffer_asp;         /**< Driver: buffer posted in each slot. */
+    uint32_t             size_u32;           /**< Descriptors, a power of two. */
+    uint32_t             mask_u32;
+    uint32_t             refill_threshold_u32; /**< Refill when fewer are posted. */
+    bool                 is_initialized;
+
+    /* Driver side. */
+    uint32_t             next_to_use_u32 BUFFER_CACHE_ALIGNED; /**< Next slot to post. */
+    uint32_t             next_to_clean_u32;  /**< Next slot to harvest. */
+    uint64_t             harvested;          /**< Descriptors harvested. */
+    uint64_t             refills;            /**< Refill batches posted. */
+    uint64_t             refill_shortfalls;  /**< Refills that found the pool empty. */
+
+    /* Device side. */
+    uint32_t             device_next_u32 BUFFER_CACHE_ALIGNED; /**< Next slot the device fills. */
+    uint64_t             device_completed;   /**< Descriptors completed by the device. */
+} buffer_ring_st;
+
+/**
+ * @brief Initialize a ring and post buffers into every descriptor.
+ *
+ * @param[out]    ring_sp           Ring to initialize.
+ * @param[in,out] ctx_sp            Initialized buffer array providing the buffers.
+ * @param[out]    desc_as           Array of @p size_u32 descriptors.
+ * @param[out]    buffer_asp        Array of @p size_u32 buffer pointers.
+ * @param[in]     size_u32          Ring size, a power of two.
+ * @param[in]     refill_threshold  Refill when fewer descriptors are posted,
+ *                                  1 to @p size_u32.
+ *
+ * @return false if the inputs are invalid.
+ */
+bool buffer_ring_init(buffer_ring_st *ring_sp,
+                      buffer_array_ctx_st *ctx_sp,
+                      buffer_ring_desc_st *desc_as,
+                      buffer_st **buffer_asp,
+                      uint32_t size_u32,
+                      uint32_t refill_threshold);
+
+/**
+ * @brief Release the posted buffers to the context. The device must be stopped.
+ */
+void buffer_ring_deinit(buffer_ring_st *ring_sp);
+
+/**
+ * @brief Driver: harvest up to @p max_rx completed descriptors, then
+ *        refill if the ring has run low.
+ *
+ * @param[in,out] ring_sp  Ring.
+ * @param[out]    rx_as    Completions, in ring order.
+ * @param[in]     max_rx   Capacity of @p rx_as.
+ *
+ * @return Number of completions written to @p rx_as.
+ */
+size_t buffer_ring_harvest(buffer_ring_st *ring_sp, buffer_ring_rx_st *rx_as, size_t max_rx);
+
+/**
+ * @brief Driver: post free buffers into all empty descriptors now.
+ *
+ * @return Number of descriptors posted (fewer if the pool ran out).
+ */
+size_t buffer_ring_refill(buffer_ring_st *ring_sp);
+
+/**
+ * @brief Driver: descriptors currently owned by the device.
+ */
+uint32_t buffer_ring_posted(buffer_ring_st const *ring_csp);
+
+/**
+ * @brief Device: next descriptor to fill.
+ *
+ * @return Descriptor owned by the device, or NULL if none is posted.
+ */
+buffer_ring_desc_st *buffer_ring_device_peek(buffer_ring_st *ring_sp);
+
+/**
+ * @brief Device: complete the descriptor returned by @ref buffer_ring_device_peek
+ *        and hand it back to the driver.
+ *
+ * @param[in,out] ring_sp     Ring.
+ * @param[in]     length_u32  Bytes written to the buffer.
+ * @param[in]     status_u16  @ref BUFFER_RING_STATUS_OK or a device code.
+ */
+void buffer_ring_device_complete(buffer_ring_st *ring_sp, uint32_t length_u32, uint16_t status_u16);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_RING_H_ */
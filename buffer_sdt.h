@@ -0,0 +1,66 @@
+/**
+ * @file buffer_sdt.h
+ * @brief Internal USDT (user statically defined tracing) probe macros.
+ *
+ * Only used by the library sources; not part of the public API.
+ *
+ * Emits the same ELF notes as systemtap's sys/sdt.h (section
+ * .note.stapsdt, note type 3), so perf, bpftrace and gdb find the probes,
+ * but needs no systemtap headers. Each probe site is a single nop; the note
+ * records its address and where the arguments live (register, stack slot or
+ * constant), so an inactive probe does not move any data.
+ *
+ * Supported on GNU-compatible compilers for x86-64 and AArch64 ELF
+ * targets; elsewhere the probes expand to nothing.
+ */
+
+#ifndef BUFFER_SDT_H_
+#define BUFFER_SDT_H_
+
+#include <stdint.h>
+
+#if defined(__GNUC__) && defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__))
+
+#define BUFFER_SDT_HAS_PROBES    (1)
+
+/* Note layout: namesz, descsz, type, "stapsdt", then pc, base, semaphore,
+ * provider, probe name and argument string ("size@operand", negative size
+ * for signed arguments). The .stapsdt.base symbol lets tools correct for
+ * prelink; it is shared by all probes through a comdat group. */
+#define BUFFER_SDT_PROBE3(provider, name, arg1_u64, arg2_i64, arg3_i64)                 \
+    __asm__ __volatile__(                                                               \
+        "990:\tnop\n"                                                                   \
+        "\t.pushsection .note.stapsdt,\"?\",\"note\"\n"                                 \
+        "\t.balign 4\n"                                                                 \
+        "\t.4byte 992f-991f, 994f-993f, 3\n"                                            \
+        "991:\t.asciz \"stapsdt\"\n"                                                    \
+        "992:\t.balign 4\n"                                                             \
+        "993:\t.8byte 990b\n"                                                           \
+        "\t.8byte _.stapsdt.base\n"                                                     \
+        "\t.8byte 0\n"                                                                  \
+        "\t.asciz \"" #provider "\"\n"                                                  \
+        "\t.asciz \"" #name "\"\n"                                                      \
+        "\t.asciz \"8@%[a1] -8@%[a2] -8@%[a3]\"\n"                                      \
+        "994:\t.balign 4\n"                                                             \
+        "\t.popsection\n"                                                               \
+        "\t.ifndef _.stapsdt.base\n"                                                    \
+        "\t.pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"       \
+        "\t.weak _.stapsdt.base\n"                                                      \
+        "\t.hidden _.stapsdt.base\n"                                                    \
+        "_.stapsdt.base:\t.space 1\n"                                                   \
+        "\t.size _.stapsdt.base, 1\n"                                                   \
+        "\t.popsection\n"                                                               \
+        "\t.endif\n"                                                                    \
+        :                                                                               \
+        : [a1] "nor" ((uint64_t)(arg1_u64)),                                            \
+          [a2] "nor" ((int64_t)(arg2_i64)),                                             \
+          [a3] "nor" ((int64_t)(arg3_i64)))
+
+#else
+
+#define BUFFER_SDT_HAS_PROBES    (0)
+#define BUFFER_SDT_PROBE3(provider, name, arg1_u64, arg2_i64, arg3_i64) do { } while (0)
+
+#endif
+
+#endif /* BUFFER_SDT_H_ */
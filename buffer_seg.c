@@ -0,0 +1,409 @@
+/**
+ * @file buffer_seg.c
+ * @brief Growable buffer context made of fixed-size segments.
+ */
+
+#include "buffer_seg.h"
+
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+static void buffer_seg_lock(buffer_seg_ctx_st const *seg_ctx_csp)
+{
+    if (NULL != seg_ctx_csp->provider_s.lock_fn)
+    {
+        seg_ctx_csp->provider_s.lock_fn(seg_ctx_csp->provider_s.user_p);
+    }
+}
+
+static void buffer_seg_unlock(buffer_seg_ctx_st const *seg_ctx_csp)
+{
+    if (NULL != seg_ctx_csp->provider_s.unlock_fn)
+    {
+        seg_ctx_csp->provider_s.unlock_fn(seg_ctx_csp->provider_s.user_p);
+    }
+}
+
+static bool buffer_seg_ctx_is_valid(buffer_seg_ctx_st const *seg_ctx_csp)
+{
+    return ((NULL != seg_ctx_csp) && (true == seg_ctx_csp->is_initialized));
+}
+
+/**
+ * @brief Bytes of the descriptor array at the start of a block, rounded up
+ *        so that buffer data starts on a cache line.
+ */
+static size_t buffer_seg_desc_bytes(size_t buffer_count)
+{
+    size_t bytes = buffer_count * sizeof(buffer_st);
+
+    return ((bytes + BUFFER_CFG_CACHE_LINE - 1u) / BUFFER_CFG_CACHE_LINE) * BUFFER_CFG_CACHE_LINE;
+}
+
+/**
+ * @brief Find the segment whose data block contains a pointer.
+ *
+ * @return Segment (active or draining), or NULL.
+ */
+static buffer_seg_st *buffer_seg_find(buffer_seg_ctx_st *seg_ctx_sp, uint8_t const *memory_u8p)
+{
+    size_t slot;
+
+    for (slot = 0u; slot < BUFFER_CFG_SEG_MAX; ++slot)
+    {
+        buffer_seg_st *seg_sp = &seg_ctx_sp->seg_as[slot];
+        uint8_t const *start_u8p;
+
+        if (BUFFER_SEG_STATE_EMPTY == seg_sp->state_e)
+        {
+            continue;
+        }
+
+        start_u8p = seg_sp->ctx_s.memory_block_u8p;
+        if ((memory_u8p >= start_u8p) &&
+            (memory_u8p <  (start_u8p + (seg_sp->ctx_s.buffer_count * seg_sp->ctx_s.buffer_size))))
+        {
+            return seg_sp;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Give a segment's block back to the provider (lock held).
+ */
+static void buffer_seg_free(buffer_seg_ctx_st *seg_ctx_sp, buffer_seg_st *seg_sp)
+{
+    if (BUFFER_SEG_STATE_ACTIVE == seg_sp->state_e)
+    {
+        seg_ctx_sp->capacity -= seg_sp->ctx_s.buffer_count;
+    }
+
+    seg_ctx_sp->in_use -= seg_sp->in_use;
+    seg_ctx_sp->provider_s.free_fn(seg_ctx_sp->provider_s.user_p, seg_sp->block_p, seg_sp->block_bytes);
+    memset(seg_sp, 0, sizeof(*seg_sp));
+}
+
+/* -------------------------------------------------------------------------- */
+/* Segmented context API                                                      */
+/* -------------------------------------------------------------------------- */
+
+size_t buffer_seg_block_bytes(size_t buffer_count, size_t buffer_size)
+{
+    return buffer_seg_desc_bytes(buffer_count) + (buffer_count * buffer_size);
+}
+
+void buffer_seg_init(buffer_seg_ctx_st *seg_ctx_sp, size_t buffer_size, buffer_seg_provider_st const *provider_csp)
+{
+    if ((NULL == seg_ctx_sp)             ||
+        (0u   == buffer_size)            ||
+        (NULL == provider_csp)           ||
+        (NULL == provider_csp->alloc_fn) ||
+        (NULL == provider_csp->free_fn))
+    {
+        return;
+    }
+
+    memset(seg_ctx_sp, 0, sizeof(*seg_ctx_sp));
+    seg_ctx_sp->provider_s     = *provider_csp;
+    seg_ctx_sp->buffer_size    = buffer_size;
+    seg_ctx_sp->is_initialized = true;
+}
+
+bool buffer_seg_add(buffer_seg_ctx_st *seg_ctx_sp, size_t buffer_count)
+{
+    buffer_seg_st *seg_sp = NULL;
+    size_t         desc_bytes;
+    size_t         block_bytes;
+    uint8_t       *block_u8p;
+    size_t         slot;
+
+    if ((false == buffer_seg_ctx_is_valid(seg_ctx_sp)) || (0u == buffer_count))
+    {
+        return false;
+    }
+
+    desc_bytes  = buffer_seg_desc_bytes(buffer_count);
+    block_bytes = buffer_seg_block_bytes(buffer_count, seg_ctx_sp->buffer_size);
+
+    /* Allocate outside the lock; the provider may be slow. */
+    block_u8p = (uint8_t *)seg_ctx_sp->provider_s.alloc_fn(seg_ctx_sp->provider_s.user_p, block_bytes);
+    if (NULL == block_u8p)
+    {
+        return false;
+    }
+
+    buffer_seg_lock(seg_ctx_sp);
+
+    for (slot = 0u; slot < BUFFER_CFG_SEG_MAX; ++slot)
+    {
+        if (BUFFER_SEG_STATE_EMPTY == seg_ctx_sp->seg_as[slot].state_e)
+        {
+            seg_sp = &seg_ctx_sp->seg_as[slot];
+            break;
+        }
+    }
+
+    if (NULL != seg_sp)
+    {
+        buffer_array_ctx_init(&seg_sp->ctx_s,
+                              (buffer_st *)(void *)block_u8p,
+                              &block_u8p[desc_bytes],
+                              buffer_count,
+                              seg_ctx_sp->buffer_size);
+        seg_sp->block_p      = block_u8p;
+        seg_sp->block_bytes  = block_bytes;
+        seg_sp->in_use       = 0u;
+        seg_sp->state_e      = BUFFER_SEG_STATE_ACTIVE;
+        seg_ctx_sp->capacity += buffer_count;
+    }
+
+    buffer_seg_unlock(seg_ctx_sp);
+
+    if (NULL == seg_sp)
+    {
+        seg_ctx_sp->provider_s.free_fn(seg_ctx_sp->provider_s.user_p, block_u8p, block_bytes);
+        return false;
+    }
+
+    return true;
+}
+
+bool buffer_seg_drain(buffer_seg_ctx_st *seg_ctx_sp, size_t min_capacity)
+{
+    buffer_seg_st *seg_sp = NULL;
+    size_t         slot;
+
+    if (false == buffer_seg_ctx_is_valid(seg_ctx_sp))
+    {
+        return false;
+    }
+
+    buffer_seg_lock(seg_ctx_sp);
+
+    for (slot = BUFFER_CFG_SEG_MAX; 0u < slot; --slot)
+    {
+        if (BUFFER_SEG_STATE_ACTIVE == seg_ctx_sp->seg_as[slot - 1u].state_e)
+        {
+            seg_sp = &seg_ctx_sp->seg_as[slot - 1u];
+            break;
+        }
+    }
+
+    if ((NULL != seg_sp) && ((seg_ctx_sp->capacity - seg_sp->ctx_s.buffer_count) >= min_capacity))
+    {
+        seg_sp->state_e       = BUFFER_SEG_STATE_DRAINING;
+        seg_ctx_sp->capacity -= seg_sp->ctx_s.buffer_count;
+    }
+    else
+    {
+        seg_sp = NULL;
+    }
+
+    buffer_seg_unlock(seg_ctx_sp);
+
+    return (NULL != seg_sp);
+}
+
+size_t buffer_seg_reactivate(buffer_seg_ctx_st *seg_ctx_sp)
+{
+    size_t buffer_count = 0u;
+    size_t slot;
+
+    if (false == buffer_seg_ctx_is_valid(seg_ctx_sp))
+    {
+        return 0u;
+    }
+
+    buffer_seg_lock(seg_ctx_sp);
+
+    for (slot = 0u; slot < BUFFER_CFG_SEG_MAX; ++slot)
+    {
+        buffer_seg_st *seg_sp = &seg_ctx_sp->seg_as[slot];
+
+        if (BUFFER_SEG_STATE_DRAINING == seg_sp->state_e)
+        {
+            seg_sp->state_e       = BUFFER_SEG_STATE_ACTIVE;
+            buffer_count          = seg_sp->ctx_s.buffer_count;
+            seg_ctx_sp->capacity += buffer_count;
+            break;
+        }
+    }
+
+    buffer_seg_unlock(seg_ctx_sp);
+
+    return buffer_count;
+}
+
+size_t buffer_seg_reclaim(buffer_seg_ctx_st *seg_ctx_sp)
+{
+    size_t reclaimed = 0u;
+    size_t slot;
+
+    if (false == buffer_seg_ctx_is_valid(seg_ctx_sp))
+    {
+        return 0u;
+    }
+
+    buffer_seg_lock(seg_ctx_sp);
+
+    for (slot = 0u; slot < BUFFER_CFG_SEG_MAX; ++slot)
+    {
+        buffer_seg_st *seg_sp = &seg_ctx_sp->seg_as[slot];
+
+        if ((BUFFER_SEG_STATE_DRAINING == seg_sp->state_e) && (0u == seg_sp->in_use))
+        {
+            buffer_seg_free(seg_ctx_sp, seg_sp);
+            ++reclaimed;
+        }
+    }
+
+    buffer_seg_unlock(seg_ctx_sp);
+
+    return reclaimed;
+}
+
+void buffer_seg_deinit(buffer_seg_ctx_st *seg_ctx_sp)
+{
+    size_t slot;
+
+    if (false == buffer_seg_ctx_is_valid(seg_ctx_sp))
+    {
+        return;
+    }
+
+    buffer_seg_lock(seg_ctx_sp);
+
+    for (slot = 0u; slot < BUFFER_CFG_SEG_MAX; ++slot)
+    {
+        if (BUFFER_SEG_STATE_EMPTY != seg_ctx_sp->seg_as[slot].state_e)
+        {
+            buffer_seg_free(seg_ctx_sp, &seg_ctx_sp->seg_as[slot]);
+        }
+    }
+
+    buffer_seg_unlock(seg_ctx_sp);
+}
+
+buffer_st *buffer_seg_acquire(buffer_seg_ctx_st *seg_ctx_sp)
+{
+    buffer_st *buffer_sp = NULL;
+    size_t     slot;
+
+    if (false == buffer_seg_ctx_is_valid(seg_ctx_sp))
+    {
+        return NULL;
+    }
+
+    buffer_seg_lock(seg_ctx_sp);
+
+    for (slot = 0u; (slot < BUFFER_CFG_SEG_MAX) && (NULL == buffer_sp); ++slot)
+    {
+        buffer_seg_st *seg_sp = &seg_ctx_sp->seg_as[slot];
+
+        if ((BUFFER_SEG_STATE_ACTIVE == seg_sp->state_e) && (seg_sp->in_use < seg_sp->ctx_s.buffer_count))
+        {
+            buffer_sp = buffer_array_acquire(&seg_sp->ctx_s);
+            if (NULL != buffer_sp)
+            {
+                seg_sp->in_use++;
+            }
+        }
+    }
+
+    if (NULL != buffer_sp)
+    {
+        seg_ctx_sp->acquires++;
+        seg_ctx_sp->in_use++;
+        if (seg_ctx_sp->in_use > seg_ctx_sp->peak_in_use)
+        {
+            seg_ctx_sp->peak_in_use = seg_ctx_sp->in_use;
+        }
+    }
+    else
+    {
+        seg_ctx_sp->failed_acquires++;
+    }
+
+    buffer_seg_unlock(seg_ctx_sp);
+
+    return buffer_sp;
+}
+
+bool buffer_seg_release_by_ptr(buffer_seg_ctx_st *seg_ctx_sp, uint8_t *memory_u8p)
+{
+    buffer_seg_st *seg_sp;
+    bool           is_released = false;
+
+    if ((false == buffer_seg_ctx_is_valid(seg_ctx_sp)) || (NULL == memory_u8p))
+    {
+        return false;
+    }
+
+    buffer_seg_lock(seg_ctx_sp);
+
+    seg_sp = buffer_seg_find(seg_ctx_sp, memory_u8p);
+    if (NULL != seg_sp)
+    {
+        /* O(1) lookup of the descriptor to tell a release from a double release. */
+        size_t           index      = (size_t)(memory_u8p - seg_sp->ctx_s.memory_block_u8p) / seg_sp->ctx_s.buffer_size;
+        buffer_st const *buffer_csp = &seg_sp->ctx_s.buffer_array_sa[index];
+        bool             was_in_use = ((buffer_csp->data_u8p == memory_u8p) && (false == buffer_csp->is_available));
+
+        is_released = buffer_array_release_by_ptr(&seg_sp->ctx_s, memory_u8p);
+        if ((true == is_released) && (true == was_in_use))
+        {
+            seg_sp->in_use--;
+            seg_ctx_sp->in_use--;
+        }
+    }
+
+    buffer_seg_unlock(seg_ctx_sp);
+
+    return is_released;
+}
+
+void buffer_seg_sample(buffer_seg_ctx_st *seg_ctx_sp, buffer_seg_sample_st *sample_sp)
+{
+    size_t slot;
+
+    if ((false == buffer_seg_ctx_is_valid(seg_ctx_sp)) || (NULL == sample_sp))
+    {
+        return;
+    }
+
+    memset(sample_sp, 0, sizeof(*sample_sp));
+
+    buffer_seg_lock(seg_ctx_sp);
+
+    for (slot = 0u; slot < BUFFER_CFG_SEG_MAX; ++slot)
+    {
+        if (BUFFER_SEG_STATE_ACTIVE == seg_ctx_sp->seg_as[slot].state_e)
+        {
+            sample_sp->active_segments++;
+        }
+        else if (BUFFER_SEG_STATE_DRAINING == seg_ctx_sp->seg_as[slot].state_e)
+        {
+            sample_sp->draining_segments++;
+            sample_sp->draining_buffers += seg_ctx_sp->seg_as[slot].ctx_s.buffer_count;
+        }
+        else
+        {
+            /* Empty slot. */
+        }
+    }
+
+    sample_sp->capacity        = seg_ctx_sp->capacity;
+    sample_sp->in_use          = seg_ctx_sp->in_use;
+    sample_sp->peak_in_use     = seg_ctx_sp->peak_in_use;
+    sample_sp->acquires        = seg_ctx_sp->acquires;
+    sample_sp->failed_acquires = seg_ctx_sp->failed_acquires;
+
+    seg_ctx_sp->peak_in_use = seg_ctx_sp->in_use;
+
+    buffer_seg_unlock(seg_ctx_sp);
+}
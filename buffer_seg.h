@@ -0,0 +1,184 @@
+/**
+ * @file buffer_seg.h
+ * @brief Growable buffer context made of fixed-size segments.
+ *
+ * A segmented context holds up to @c BUFFER_CFG_SEG_MAX segments, each a
+ * complete @ref buffer_array_ctx_st over one block obtained from a
+ * caller-provided memory provider. All segments use the same buffer size.
+ * Capacity grows by adding a segment and shrinks by draining one: a
+ * draining segment hands out no more buffers, still accepts releases, and
+ * is returned to the provider by @ref buffer_seg_reclaim once all of its
+ * buffers are free. Buffers never move, so pointers stay valid.
+ *
+ * Acquire takes the first free buffer of the lowest active segment, which
+ * keeps the newest segments as idle as possible and so cheap to drain.
+ *
+ * Every operation runs under the optional lock callbacks of the context.
+ * When a background thread (e.g. buffer_tuner.h) resizes the context, the
+ * lock must be provided and replaces the caller's own serialization of
+ * pool calls. Without a lock the usual single-writer rule applies.
+ */
+
+#ifndef BUFFER_SEG_H_
+#define BUFFER_SEG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of segments per context. */
+#ifndef BUFFER_CFG_SEG_MAX
+#define BUFFER_CFG_SEG_MAX       (16u)
+#endif
+
+/**
+ * @brief Segment state.
+ */
+typedef enum
+{
+    BUFFER_SEG_STATE_EMPTY    = 0,   /**< Slot holds no memory. */
+    BUFFER_SEG_STATE_ACTIVE   = 1,   /**< Buffers can be acquired and released. */
+    BUFFER_SEG_STATE_DRAINING = 2    /**< Buffers can only be released. */
+} buffer_seg_state_et;
+
+/**
+ * @brief Memory provider and lock callbacks of a segmented context.
+ */
+typedef struct
+{
+    void *(*alloc_fn)(void *user_p, size_t size_bytes);                 /**< Return a block, or NULL. */
+    void  (*free_fn)(void *user_p, void *block_p, size_t size_bytes);   /**< Take a block back. */
+    void  (*lock_fn)(void *user_p);                                     /**< Optional, may be NULL. */
+    void  (*unlock_fn)(void *user_p);                                   /**< Optional, may be NULL. */
+    void   *user_p;                                                     /**< Passed to every callback. */
+} buffer_seg_provider_st;
+
+/**
+ * @brief One segment.
+ */
+typedef struct
+{
+    buffer_array_ctx_st ctx_s;       /**< Pool over the segment's block. */
+    void               *block_p;     /**< Block from the provider (descriptors, then data). */
+    size_t              block_bytes; /**< Size of @ref block_p. */
+    size_t              in_use;      /**< Buffers of this segment currently acquired. */
+    buffer_seg_state_et state_e;
+} buffer_seg_st;
+
+/**
+ * @brief Segmented context.
+ */
+typedef struct
+{
+    buffer_seg_st          seg_as[BUFFER_CFG_SEG_MAX];
+    buffer_seg_provider_st provider_s;
+    size_t                 buffer_size;          /**< Bytes per buffer, all segments. */
+    size_t                 capacity;             /**< Buffers in active segments. */
+    size_t                 in_use;               /**< Buffers acquired, all segments. */
+    size_t                 peak_in_use;          /**< Highest @ref in_use since the last sample. */
+    uint64_t               acquires;             /**< Successful acquires since init. */
+    uint64_t               failed_acquires;      /**< Acquires that found no free buffer since init. */
+    bool                   is_initialized;
+} buffer_seg_ctx_st;
+
+/**
+ * @brief Occupancy sample, as returned by @ref buffer_seg_sample.
+ */
+typedef struct
+{
+    size_t   capacity;               /**< Buffers in active segments. */
+    size_t   in_use;                 /**< Buffers acquired now. */
+    size_t   peak_in_use;            /**< Highest in-use count since the previous sample. */
+    size_t   active_segments;
+    size_t   draining_segments;
+    size_t   draining_buffers;       /**< Buffers in draining segments (memory still held). */
+    uint64_t acquires;               /**< Since init. */
+    uint64_t failed_acquires;        /**< Since init. */
+} buffer_seg_sample_st;
+
+/**
+ * @brief Size of the block @ref buffer_seg_add requests for a segment.
+ *
+ * @param[in] buffer_count  Buffers in the segment.
+ * @param[in] buffer_size   Bytes per buffer.
+ *
+ * @return Descriptor array (rounded up to a cache line) plus buffer data.
+ */
+size_t buffer_seg_block_bytes(size_t buffer_count, size_t buffer_size);
+
+/**
+ * @brief Initialize an empty segmented context.
+ *
+ * @param[out] seg_ctx_sp    Context to initialize.
+ * @param[in]  buffer_size   Bytes per buffer.
+ * @param[in]  provider_csp  Memory provider (alloc_fn and free_fn are required).
+ */
+void buffer_seg_init(buffer_seg_ctx_st *seg_ctx_sp, size_t buffer_size, buffer_seg_provider_st const *provider_csp);
+
+/**
+ * @brief Add an active segment of @p buffer_count buffers.
+ *
+ * @return true if a free slot and memory were available.
+ */
+bool buffer_seg_add(buffer_seg_ctx_st *seg_ctx_sp, size_t buffer_count);
+
+/**
+ * @brief Stop handing out buffers from the highest active segment.
+ *
+ * @param[in,out] seg_ctx_sp  Context.
+ * @param[in]     min_capacity  Capacity that must remain active.
+ *
+ * @return true if a segment was set to draining.
+ */
+bool buffer_seg_drain(buffer_seg_ctx_st *seg_ctx_sp, size_t min_capacity);
+
+/**
+ * @brief Put the lowest draining segment back into service.
+ *
+ * Cheaper than @ref buffer_seg_add when capacity is needed again before a
+ * drained segment was reclaimed: its memory is still held anyway.
+ *
+ * @return Buffers made active again, 0 if no segment was draining.
+ */
+size_t buffer_seg_reactivate(buffer_seg_ctx_st *seg_ctx_sp);
+
+/**
+ * @brief Return the memory of draining segments with no buffer in use.
+ *
+ * @return Number of segments reclaimed.
+ */
+size_t buffer_seg_reclaim(buffer_seg_ctx_st *seg_ctx_sp);
+
+/**
+ * @brief Reclaim every segment regardless of use. Buffers become invalid.
+ */
+void buffer_seg_deinit(buffer_seg_ctx_st *seg_ctx_sp);
+
+/**
+ * @brief Acquire a free buffer from the lowest active segment that has one.
+ */
+buffer_st *buffer_seg_acquire(buffer_seg_ctx_st *seg_ctx_sp);
+
+/**
+ * @brief Release a buffer by its data pointer.
+ *
+ * @return true if the pointer belongs to one of the segments.
+ */
+bool buffer_seg_release_by_ptr(buffer_seg_ctx_st *seg_ctx_sp, uint8_t *memory_u8p);
+
+/**
+ * @brief Read the occupancy counters and restart the peak measurement.
+ */
+void buffer_seg_sample(buffer_seg_ctx_st *seg_ctx_sp, buffer_seg_sample_st *sample_sp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_SEG_H_ */
@@ -0,0 +1,186 @@
+/**
+ * @file buffer_shm.c
+ * @brief Publish pool statistics in a shared memory segment (POSIX).
+ *
+ * Only needed when the library is built with BUFFER_CFG_STATS=1.
+ * Link with -lrt on older glibc.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "buffer_shm.h"
+
+#if (0 != BUFFER_CFG_STATS)
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Statistics start on the first cache line after the header. */
+#define BUFFER_SHM_STATS_OFFSET  (((sizeof(buffer_shm_header_st) + BUFFER_CFG_CACHE_LINE - 1u) / \
+                                   BUFFER_CFG_CACHE_LINE) * BUFFER_CFG_CACHE_LINE)
+#define BUFFER_SHM_SIZE          (BUFFER_SHM_STATS_OFFSET + sizeof(buffer_pool_stats_st))
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Check that a mapped header was written by a compatible writer.
+ */
+static bool buffer_shm_header_is_valid(buffer_shm_header_st const *header_csp, size_t size_bytes)
+{
+    return ((sizeof(*header_csp) <= size_bytes)                                                  &&
+            (0 == memcmp(header_csp->magic_ac, BUFFER_SHM_MAGIC, sizeof(header_csp->magic_ac))) &&
+            (BUFFER_SHM_VERSION == header_csp->version)                                         &&
+            (BUFFER_SHM_STATS_OFFSET == header_csp->stats_offset)                               &&
+            (sizeof(buffer_pool_stats_st) == header_csp->stats_size)                            &&
+            (BUFFER_CFG_STATS_SHARDS == header_csp->shard_count)                                &&
+            (BUFFER_SHM_SIZE <= size_bytes));
+}
+
+/* -------------------------------------------------------------------------- */
+/* Segment API                                                                */
+/* -------------------------------------------------------------------------- */
+
+bool buffer_shm_publish(buffer_shm_st *shm_sp, buffer_pool_st *pool_sp, char const *name_cp, size_t buffer_size)
+{
+    buffer_shm_header_st *header_sp;
+    void                 *base_p;
+    int                   fd;
+
+    if ((NULL == shm_sp) || (NULL == pool_sp) || (false == pool_sp->is_initialized) ||
+        (NULL == name_cp) || (BUFFER_SHM_NAME_MAX <= strlen(name_cp)))
+    {
+        return false;
+    }
+
+    (void)shm_unlink(name_cp);
+    fd = shm_open(name_cp, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (0 > fd)
+    {
+        return false;
+    }
+
+    if (0 != ftruncate(fd, (off_t)BUFFER_SHM_SIZE))
+    {
+        (void)close(fd);
+        (void)shm_unlink(name_cp);
+        return false;
+    }
+
+    base_p = mmap(NULL, BUFFER_SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (MAP_FAILED == base_p)
+    {
+        (void)shm_unlink(name_cp);
+        return false;
+    }
+
+    /* The header is written before the pool starts updating the statistics. */
+    header_sp = (buffer_shm_header_st *)base_p;
+    memcpy(header_sp->magic_ac, BUFFER_SHM_MAGIC, sizeof(header_sp->magic_ac));
+    header_sp->version      = BUFFER_SHM_VERSION;
+    header_sp->stats_offset = (uint32_t)BUFFER_SHM_STATS_OFFSET;
+    header_sp->stats_size   = (uint32_t)sizeof(buffer_pool_stats_st);
+    header_sp->shard_count  = BUFFER_CFG_STATS_SHARDS;
+    header_sp->buffer_count = pool_sp->buffer_count;
+    header_sp->buffer_size  = buffer_size;
+    header_sp->pid          = (int64_t)getpid();
+
+    shm_sp->base_p     = base_p;
+    shm_sp->size_bytes = BUFFER_SHM_SIZE;
+    shm_sp->pool_sp    = pool_sp;
+    memcpy(shm_sp->name_ac, name_cp, strlen(name_cp) + 1u);
+
+    buffer_pool_stats_attach(pool_sp, (buffer_pool_stats_st *)((uint8_t *)base_p + BUFFER_SHM_STATS_OFFSET));
+    return true;
+}
+
+void buffer_shm_unpublish(buffer_shm_st *shm_sp)
+{
+    if ((NULL == shm_sp) || (NULL == shm_sp->base_p))
+    {
+        return;
+    }
+
+    if (NULL != shm_sp->pool_sp)
+    {
+        buffer_pool_stats_attach(shm_sp->pool_sp, NULL);
+        (void)shm_unlink(shm_sp->name_ac);
+    }
+
+    (void)munmap(shm_sp->base_p, shm_sp->size_bytes);
+    memset(shm_sp, 0, sizeof(*shm_sp));
+}
+
+bool buffer_shm_open(buffer_shm_st *shm_sp, char const *name_cp)
+{
+    struct stat st_s;
+    void       *base_p;
+    int         fd;
+
+    if ((NULL == shm_sp) || (NULL == name_cp))
+    {
+        return false;
+    }
+
+    fd = shm_open(name_cp, O_RDONLY, 0);
+    if (0 > fd)
+    {
+        return false;
+    }
+
+    if ((0 != fstat(fd, &st_s)) || ((off_t)sizeof(buffer_shm_header_st) > st_s.st_size))
+    {
+        (void)close(fd);
+        return false;
+    }
+
+    base_p = mmap(NULL, (size_t)st_s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (MAP_FAILED == base_p)
+    {
+        return false;
+    }
+
+    if (false == buffer_shm_header_is_valid((buffer_shm_header_st const *)base_p, (size_t)st_s.st_size))
+    {
+        (void)munmap(base_p, (size_t)st_s.st_size);
+        return false;
+    }
+
+    memset(shm_sp, 0, sizeof(*shm_sp));
+    shm_sp->base_p     = base_p;
+    shm_sp->size_bytes = (size_t)st_s.st_size;
+    return true;
+}
+
+void buffer_shm_close(buffer_shm_st *shm_sp)
+{
+    buffer_shm_unpublish(shm_sp);
+}
+
+buffer_shm_header_st const *buffer_shm_header(buffer_shm_st const *shm_csp)
+{
+    if ((NULL == shm_csp) || (NULL == shm_csp->base_p))
+    {
+        return NULL;
+    }
+
+    return (buffer_shm_header_st const *)shm_csp->base_p;
+}
+
+buffer_pool_stats_st const *buffer_shm_stats(buffer_shm_st const *shm_csp)
+{
+    if ((NULL == shm_csp) || (NULL == shm_csp->base_p))
+    {
+        return NULL;
+    }
+
+    return (buffer_pool_stats_st const *)((uint8_t const *)shm_csp->base_p + BUFFER_SHM_STATS_OFFSET);
+}
+
+#endif /* BUFFER_CFG_STATS */
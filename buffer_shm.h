@@ -0,0 +1,114 @@
+/**
+ * @file buffer_shm.h
+ * @brief Publish pool statistics in a shared memory segment (POSIX).
+ *
+ * Requires the library to be built with @c BUFFER_CFG_STATS=1.
+ *
+ * The segment holds a @ref buffer_shm_header_st followed, at
+ * @ref buffer_shm_header_st::stats_offset, by the @ref buffer_pool_stats_st
+ * that the pool updates. Publishing attaches that block to the pool, so the
+ * service does no work beyond its normal counter updates; other processes
+ * map the segment read-only and read it with @ref buffer_pool_stats_sum and
+ * the seqlock-protected occupancy fields, without any system call per read.
+ *
+ * Reader and writer must agree on the layout: the header records the
+ * format version, the size of the statistics block and the shard count,
+ * and @ref buffer_shm_open rejects segments that do not match this build.
+ */
+
+#ifndef BUFFER_SHM_H_
+#define BUFFER_SHM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if (0 != BUFFER_CFG_STATS)
+
+#define BUFFER_SHM_MAGIC         "BUFSTATS"      /**< 8 bytes, without terminator. */
+#define BUFFER_SHM_VERSION       (1u)
+#define BUFFER_SHM_NAME_MAX      (64u)           /**< Including terminator. */
+
+/**
+ * @brief Header at the start of a statistics segment.
+ */
+typedef struct
+{
+    char     magic_ac[8];            /**< @ref BUFFER_SHM_MAGIC. */
+    uint32_t version;                /**< @ref BUFFER_SHM_VERSION. */
+    uint32_t stats_offset;           /**< Offset of the @ref buffer_pool_stats_st. */
+    uint32_t stats_size;             /**< sizeof(@ref buffer_pool_stats_st). */
+    uint32_t shard_count;            /**< @c BUFFER_CFG_STATS_SHARDS of the writer. */
+    uint64_t buffer_count;           /**< Buffers in the published pool. */
+    uint64_t buffer_size;            /**< Buffer size of the published pool, 0 if unknown. */
+    int64_t  pid;                    /**< Process id of the writer. */
+} buffer_shm_header_st;
+
+/**
+ * @brief Handle of a mapped statistics segment.
+ */
+typedef struct
+{
+    void           *base_p;                      /**< Start of the mapping. */
+    size_t          size_bytes;                  /**< Length of the mapping. */
+    buffer_pool_st *pool_sp;                     /**< Published pool (writer only). */
+    char            name_ac[BUFFER_SHM_NAME_MAX]; /**< Segment name (writer only). */
+} buffer_shm_st;
+
+/**
+ * @brief Create a segment and attach it to a pool as its statistics storage.
+ *
+ * @param[out]    shm_sp       Handle to fill.
+ * @param[in,out] pool_sp      Initialized pool to publish.
+ * @param[in]     name_cp      Segment name for shm_open(), e.g. "/rx_pool".
+ * @param[in]     buffer_size  Buffer size recorded in the header (0 if unknown).
+ *
+ * @return true on success. An existing segment of the same name is replaced.
+ */
+bool buffer_shm_publish(buffer_shm_st *shm_sp, buffer_pool_st *pool_sp, char const *name_cp, size_t buffer_size);
+
+/**
+ * @brief Detach the statistics from the pool and remove the segment.
+ *
+ * Readers that still have it mapped keep seeing the last values.
+ */
+void buffer_shm_unpublish(buffer_shm_st *shm_sp);
+
+/**
+ * @brief Map an existing segment read-only.
+ *
+ * @param[out] shm_sp   Handle to fill.
+ * @param[in]  name_cp  Segment name.
+ *
+ * @return true if the segment exists and its layout matches this build.
+ */
+bool buffer_shm_open(buffer_shm_st *shm_sp, char const *name_cp);
+
+/**
+ * @brief Unmap a segment opened with @ref buffer_shm_open.
+ */
+void buffer_shm_close(buffer_shm_st *shm_sp);
+
+/**
+ * @brief Header of a mapped segment.
+ */
+buffer_shm_header_st const *buffer_shm_header(buffer_shm_st const *shm_csp);
+
+/**
+ * @brief Statistics block of a mapped segment.
+ */
+buffer_pool_stats_st const *buffer_shm_stats(buffer_shm_st const *shm_csp);
+
+#endif /* BUFFER_CFG_STATS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_SHM_H_ */
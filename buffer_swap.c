@@ -0,0 +1,156 @@
+/**
+ * @file buffer_swap.c
+ * @brief Triple buffer handing the latest full buffer from a producer to a
+ *        consumer thread.
+ */
+
+#include "buffer_swap.h"
+#include "buffer_port.h"
+
+#include <string.h>
+
+#define BUFFER_SWAP_INDEX_MASK   (0x3u)      /**< Slot index in @c middle_u32. */
+#define BUFFER_SWAP_FRESH        (0x4u)      /**< Middle slot published and not yet taken. */
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+static bool buffer_swap_is_valid(buffer_swap_st const *swap_csp)
+{
+    return ((NULL != swap_csp) && (true == swap_csp->is_initialized));
+}
+
+/* -------------------------------------------------------------------------- */
+/* Triple buffer API                                                          */
+/* -------------------------------------------------------------------------- */
+
+bool buffer_swap_init(buffer_swap_st *swap_sp, buffer_array_ctx_st *ctx_sp)
+{
+    uint32_t slot;
+
+    if ((NULL == swap_sp) || (NULL == ctx_sp) || (false == ctx_sp->is_initialized))
+    {
+        return false;
+    }
+
+    memset(swap_sp, 0, sizeof(*swap_sp));
+
+    for (slot = 0u; slot < BUFFER_SWAP_SLOTS; ++slot)
+    {
+        swap_sp->slot_asp[slot] = buffer_array_acquire(ctx_sp);
+        if (NULL == swap_sp->slot_asp[slot])
+        {
+            while (slot > 0u)
+            {
+                --slot;
+                (void)buffer_pool_release(&ctx_sp->pool_s, swap_sp->slot_asp[slot]);
+            }
+            return false;
+        }
+    }
+
+    swap_sp->ctx_sp         = ctx_sp;
+    swap_sp->back_u32       = 0u;
+    swap_sp->middle_u32     = 1u;
+    swap_sp->front_u32      = 2u;
+    swap_sp->is_initialized = true;
+    return true;
+}
+
+void buffer_swap_deinit(buffer_swap_st *swap_sp)
+{
+    uint32_t slot;
+
+    if (false == buffer_swap_is_valid(swap_sp))
+    {
+        return;
+    }
+
+    for (slot = 0u; slot < BUFFER_SWAP_SLOTS; ++slot)
+    {
+        (void)buffer_pool_release(&swap_sp->ctx_sp->pool_s, swap_sp->slot_asp[slot]);
+    }
+
+    swap_sp->is_initialized = false;
+}
+
+buffer_st *buffer_swap_back(buffer_swap_st *swap_sp)
+{
+    if (false == buffer_swap_is_valid(swap_sp))
+    {
+        return NULL;
+    }
+
+    return swap_sp->slot_asp[swap_sp->back_u32];
+}
+
+buffer_st *buffer_swap_publish(buffer_swap_st *swap_sp, size_t length_bytes)
+{
+    uint32_t previous_u32;
+
+    if (false == buffer_swap_is_valid(swap_sp))
+    {
+        return NULL;
+    }
+
+    swap_sp->length_a[swap_sp->back_u32] = length_bytes;
+
+    /* Release orders the data and length before the index; acquire orders
+     * the consumer's last reads of the returned slot before our writes. */
+    previous_u32 = BUFFER_PORT_EXCHANGE(&swap_sp->middle_u32, swap_sp->back_u32 | BUFFER_SWAP_FRESH);
+
+    if (0u != (previous_u32 & BUFFER_SWAP_FRESH))
+    {
+        swap_sp->dropped++;
+    }
+    swap_sp->published++;
+
+    swap_sp->back_u32 = previous_u32 & BUFFER_SWAP_INDEX_MASK;
+    return swap_sp->slot_asp[swap_sp->back_u32];
+}
+
+buffer_st *buffer_swap_try_publish(buffer_swap_st *swap_sp, size_t length_bytes)
+{
+    if (false == buffer_swap_is_valid(swap_sp))
+    {
+        return NULL;
+    }
+
+    /* Only the producer sets the flag, so a middle seen taken stays taken
+     * and the exchange in publish cannot replace an unread buffer. */
+    if (0u != (BUFFER_PORT_LOAD_ACQUIRE(&swap_sp->middle_u32) & BUFFER_SWAP_FRESH))
+    {
+        return NULL;
+    }
+
+    return buffer_swap_publish(swap_sp, length_bytes);
+}
+
+buffer_st *buffer_swap_take(buffer_swap_st *swap_sp, size_t *length_p)
+{
+    uint32_t previous_u32;
+
+    if (false == buffer_swap_is_valid(swap_sp))
+    {
+        return NULL;
+    }
+
+    /* Only the consumer clears the flag, so a fresh middle stays fresh
+     * until the exchange below. */
+    if (0u == (BUFFER_PORT_LOAD_RELAXED(&swap_sp->middle_u32) & BUFFER_SWAP_FRESH))
+    {
+        return NULL;
+    }
+
+    previous_u32       = BUFFER_PORT_EXCHANGE(&swap_sp->middle_u32, swap_sp->front_u32);
+    swap_sp->front_u32 = previous_u32 & BUFFER_SWAP_INDEX_MASK;
+    swap_sp->taken++;
+
+    if (NULL != length_p)
+    {
+        *length_p = swap_sp->length_a[swap_sp->front_u32];
+    }
+
+    return swap_sp->slot_asp[swap_sp->front_u32];
+}
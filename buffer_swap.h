@@ -0,0 +1,127 @@
+/**
+ * @file buffer_swap.h
+ * @brief Triple buffer: hand the latest full buffer from one producer
+ *        thread to one consumer thread without copying or locking.
+ *
+ * Three buffers of a @ref buffer_array_ctx_st are acquired once at init and
+ * then rotate between three roles: the producer's back buffer, the shared
+ * middle buffer and the consumer's front buffer. @ref buffer_swap_publish
+ * and @ref buffer_swap_take each trade a buffer index with the middle in a
+ * single atomic exchange, so neither side waits, the producer always has
+ * an empty buffer to fill and data never moves.
+ *
+ * With @ref buffer_swap_publish the consumer sees the most recent
+ * publication: a buffer published while the previous one was still unread
+ * replaces it (counted in @ref buffer_swap_st::dropped). This suits state
+ * snapshots, frames and double-buffered DMA. When every buffer must be
+ * delivered, publish with @ref buffer_swap_try_publish, which refuses
+ * instead of replacing, so at most one buffer is in flight.
+ *
+ * Exactly one thread may call the producer functions and one the consumer
+ * functions. Init and deinit run while neither is active.
+ */
+
+#ifndef BUFFER_SWAP_H_
+#define BUFFER_SWAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUFFER_SWAP_SLOTS        (3u)        /**< Back, middle and front. */
+
+/**
+ * @brief Triple buffer state.
+ *
+ * Producer, shared and consumer fields sit on separate cache lines.
+ */
+typedef struct
+{
+    buffer_array_ctx_st *ctx_sp;
+    buffer_st           *slot_asp[BUFFER_SWAP_SLOTS];  /**< Buffers owned by the swap. */
+    size_t               length_a[BUFFER_SWAP_SLOTS];  /**< Bytes published in each slot. */
+    bool                 is_initialized;
+
+    /* Producer side. */
+    uint32_t             back_u32 BUFFER_CACHE_ALIGNED; /**< Slot being filled. */
+    uint64_t             published;                     /**< Buffers published. */
+    uint64_t             dropped;                       /**< Published buffers replaced before being taken. */
+
+    /* Shared. */
+    uint32_t             middle_u32 BUFFER_CACHE_ALIGNED; /**< Slot in the middle, plus a fresh flag. */
+
+    /* Consumer side. */
+    uint32_t             front_u32 BUFFER_CACHE_ALIGNED; /**< Slot being read. */
+    uint64_t             taken;                          /**< Buffers taken. */
+} buffer_swap_st;
+
+/**
+ * @brief Take three buffers from a context and set up the rotation.
+ *
+ * @param[out]    swap_sp  Swap to initialize.
+ * @param[in,out] ctx_sp   Initialized buffer array with at least three free buffers.
+ *
+ * @return false if the inputs are invalid or fewer than three buffers are
+ *         free (none is kept in that case).
+ */
+bool buffer_swap_init(buffer_swap_st *swap_sp, buffer_array_ctx_st *ctx_sp);
+
+/**
+ * @brief Return the three buffers to the context.
+ */
+void buffer_swap_deinit(buffer_swap_st *swap_sp);
+
+/**
+ * @brief Producer: buffer to fill next.
+ *
+ * @return Back buffer, or NULL if @p swap_sp is not initialized.
+ */
+buffer_st *buffer_swap_back(buffer_swap_st *swap_sp);
+
+/**
+ * @brief Producer: publish the back buffer and get an empty one in exchange.
+ *
+ * @param[in,out] swap_sp       Swap.
+ * @param[in]     length_bytes  Bytes written to the back buffer, passed to the consumer.
+ *
+ * @return The new back buffer (never NULL on an initialized swap). Its
+ *         content is stale.
+ */
+buffer_st *buffer_swap_publish(buffer_swap_st *swap_sp, size_t length_bytes);
+
+/**
+ * @brief Producer: publish the back buffer only if the consumer has taken
+ *        the previous publication, and get an empty one in exchange.
+ *
+ * @param[in,out] swap_sp       Swap.
+ * @param[in]     length_bytes  Bytes written to the back buffer, passed to the consumer.
+ *
+ * @return The new back buffer, or NULL if the previous publication is
+ *         still unread (the back buffer stays with the producer; retry
+ *         later) or @p swap_sp is not initialized. Never drops a buffer.
+ */
+buffer_st *buffer_swap_try_publish(buffer_swap_st *swap_sp, size_t length_bytes);
+
+/**
+ * @brief Consumer: take the most recently published buffer.
+ *
+ * @param[in,out] swap_sp   Swap.
+ * @param[out]    length_p  Published length, or NULL.
+ *
+ * @return The new front buffer, valid until the next successful take, or
+ *         NULL if nothing was published since the last take (the previous
+ *         front buffer stays valid).
+ */
+buffer_st *buffer_swap_take(buffer_swap_st *swap_sp, size_t *length_p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_SWAP_H_ */
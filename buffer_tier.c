@@ -0,0 +1,231 @@
+/**
+ * @file buffer_tier.c
+ * @brief Two-tier pool: a fast primary context that overflows to a
+ *        secondary one.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "buffer_tier.h"
+#include "buffer_port.h"
+
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BUFFER_TIER_HAS_MMAP     (1)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define BUFFER_TIER_HAS_MMAP     (0)
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+static bool buffer_tier_ctx_is_valid(buffer_tier_ctx_st const *tier_csp)
+{
+    return ((NULL != tier_csp) && (true == tier_csp->is_initialized));
+}
+
+static uintptr_t buffer_tier_block_end(buffer_array_ctx_st const *ctx_csp)
+{
+    return (uintptr_t)ctx_csp->memory_block_u8p + (ctx_csp->buffer_count * ctx_csp->buffer_size);
+}
+
+static void buffer_tier_in_use_add(buffer_tier_counters_st *counters_sp)
+{
+    counters_sp->acquires++;
+    counters_sp->in_use++;
+    if (counters_sp->in_use > counters_sp->high_water)
+    {
+        counters_sp->high_water = counters_sp->in_use;
+    }
+}
+
+/**
+ * @brief Release a buffer of one tier if the pointer falls in its block.
+ *
+ * @return true if the pointer lies in the tier's block (released or not).
+ */
+static bool buffer_tier_release_in(buffer_tier_ctx_st *tier_sp,
+                                   buffer_tier_et tier_e,
+                                   uint8_t *memory_u8p,
+                                   bool *is_released_p)
+{
+    buffer_array_ctx_st *ctx_sp  = tier_sp->tier_asp[tier_e];
+    uintptr_t            address = (uintptr_t)memory_u8p;
+    uintptr_t            start   = (uintptr_t)ctx_sp->memory_block_u8p;
+    buffer_st           *buffer_sp;
+    bool                 was_in_use;
+
+    if ((address < start) || (address >= buffer_tier_block_end(ctx_sp)))
+    {
+        return false;
+    }
+
+    buffer_sp      = &ctx_sp->buffer_array_sa[(address - start) / ctx_sp->buffer_size];
+    *is_released_p = false;
+
+    if (buffer_sp->data_u8p == memory_u8p)
+    {
+        was_in_use     = (false == buffer_sp->is_available);
+        *is_released_p = buffer_pool_release(&ctx_sp->pool_s, buffer_sp);
+
+        if ((true == *is_released_p) && (true == was_in_use))
+        {
+            tier_sp->counters_as[tier_e].releases++;
+            tier_sp->counters_as[tier_e].in_use--;
+        }
+    }
+
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Tiered pool API                                                            */
+/* -------------------------------------------------------------------------- */
+
+bool buffer_tier_init(buffer_tier_ctx_st *tier_sp,
+                      buffer_array_ctx_st *primary_sp,
+                      buffer_array_ctx_st *secondary_sp)
+{
+    if ((NULL == tier_sp)                                         ||
+        (NULL == primary_sp)   || (false == primary_sp->is_initialized)   ||
+        (NULL == secondary_sp) || (false == secondary_sp->is_initialized) ||
+        (secondary_sp->buffer_size < primary_sp->buffer_size))
+    {
+        return false;
+    }
+
+    /* Blocks must not overlap, or release could pick the wrong tier. */
+    if (((uintptr_t)primary_sp->memory_block_u8p < buffer_tier_block_end(secondary_sp)) &&
+        ((uintptr_t)secondary_sp->memory_block_u8p < buffer_tier_block_end(primary_sp)))
+    {
+        return false;
+    }
+
+    memset(tier_sp, 0, sizeof(*tier_sp));
+    tier_sp->tier_asp[BUFFER_TIER_PRIMARY]   = primary_sp;
+    tier_sp->tier_asp[BUFFER_TIER_SECONDARY] = secondary_sp;
+    tier_sp->is_initialized                  = true;
+    return true;
+}
+
+buffer_st *buffer_tier_acquire(buffer_tier_ctx_st *tier_sp, buffer_tier_et *tier_out_p)
+{
+    buffer_st     *buffer_sp;
+    buffer_tier_et tier_e = BUFFER_TIER_PRIMARY;
+
+    if (false == buffer_tier_ctx_is_valid(tier_sp))
+    {
+        return NULL;
+    }
+
+    buffer_sp = buffer_array_acquire(tier_sp->tier_asp[BUFFER_TIER_PRIMARY]);
+
+    if (BUFFER_PORT_UNLIKELY(NULL == buffer_sp))
+    {
+        tier_sp->counters_as[BUFFER_TIER_PRIMARY].failed_acquires++;
+
+        tier_e    = BUFFER_TIER_SECONDARY;
+        buffer_sp = buffer_array_acquire(tier_sp->tier_asp[BUFFER_TIER_SECONDARY]);
+        if (NULL == buffer_sp)
+        {
+            tier_sp->counters_as[BUFFER_TIER_SECONDARY].failed_acquires++;
+            return NULL;
+        }
+    }
+
+    buffer_tier_in_use_add(&tier_sp->counters_as[tier_e]);
+
+    if (NULL != tier_out_p)
+    {
+        *tier_out_p = tier_e;
+    }
+
+    return buffer_sp;
+}
+
+bool buffer_tier_release_by_ptr(buffer_tier_ctx_st *tier_sp, uint8_t *memory_u8p)
+{
+    bool is_released = false;
+
+    if ((false == buffer_tier_ctx_is_valid(tier_sp)) || (NULL == memory_u8p))
+    {
+        return false;
+    }
+
+    if ((false == buffer_tier_release_in(tier_sp, BUFFER_TIER_PRIMARY, memory_u8p, &is_released)) &&
+        (false == buffer_tier_release_in(tier_sp, BUFFER_TIER_SECONDARY, memory_u8p, &is_released)))
+    {
+        tier_sp->foreign_releases++;
+    }
+
+    return is_released;
+}
+
+bool buffer_tier_read(buffer_tier_ctx_st const *tier_csp, buffer_tier_et tier_e, buffer_tier_counters_st *counters_sp)
+{
+    if ((false == buffer_tier_ctx_is_valid(tier_csp)) ||
+        (BUFFER_TIER_COUNT <= tier_e)                 ||
+        (NULL == counters_sp))
+    {
+        return false;
+    }
+
+    *counters_sp = tier_csp->counters_as[tier_e];
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* File-backed memory                                                         */
+/* -------------------------------------------------------------------------- */
+
+uint8_t *buffer_tier_map_file(char const *path_cp, size_t size_bytes)
+{
+#if (0 != BUFFER_TIER_HAS_MMAP)
+    void *block_p;
+    int   fd;
+
+    if ((NULL == path_cp) || (0u == size_bytes))
+    {
+        return NULL;
+    }
+
+    fd = open(path_cp, O_RDWR | O_CREAT, 0600);
+    if (0 > fd)
+    {
+        return NULL;
+    }
+
+    if (0 != ftruncate(fd, (off_t)size_bytes))
+    {
+        (void)close(fd);
+        return NULL;
+    }
+
+    block_p = mmap(NULL, size_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    (void)close(fd);
+
+    return (MAP_FAILED == block_p) ? NULL : (uint8_t *)block_p;
+#else
+    (void)path_cp;
+    (void)size_bytes;
+    return NULL;
+#endif
+}
+
+void buffer_tier_unmap_file(uint8_t *block_u8p, size_t size_bytes)
+{
+#if (0 != BUFFER_TIER_HAS_MMAP)
+    if (NULL != block_u8p)
+    {
+        (void)munmap(block_u8p, size_bytes);
+    }
+#else
+    (void)block_u8p;
+    (void)size_bytes;
+#endif
+}
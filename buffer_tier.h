@@ -0,0 +1,122 @@
+/**
+ * @file buffer_tier.h
+ * @brief Two-tier pool: a fast primary context that overflows to a
+ *        secondary one.
+ *
+ * Acquire serves from the primary context (e.g. hugepage, mlocked memory)
+ * and only when it is exhausted from the secondary context (e.g. a larger
+ * block of ordinary pages or a file mapped with @ref buffer_tier_map_file).
+ * The primary path costs one extra branch and counter over a plain
+ * @ref buffer_array_acquire. Release finds the tier by address range and
+ * the buffer by its offset, so it does not search either context.
+ *
+ * Secondary buffers must be at least as large as primary ones; callers
+ * then only rely on the primary buffer size. Concurrency follows the
+ * single-writer rule of the two contexts.
+ */
+
+#ifndef BUFFER_TIER_H_
+#define BUFFER_TIER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Tier index.
+ */
+typedef enum
+{
+    BUFFER_TIER_PRIMARY   = 0,
+    BUFFER_TIER_SECONDARY = 1,
+    BUFFER_TIER_COUNT     = 2
+} buffer_tier_et;
+
+/**
+ * @brief Event counters of one tier.
+ */
+typedef struct
+{
+    uint64_t acquires;               /**< Buffers handed out by this tier. */
+    uint64_t failed_acquires;        /**< Acquires that found this tier exhausted. */
+    uint64_t releases;               /**< Buffers released back to this tier. */
+    size_t   in_use;                 /**< Buffers of this tier acquired now. */
+    size_t   high_water;             /**< Highest @ref in_use since init. */
+} buffer_tier_counters_st;
+
+/**
+ * @brief Two-tier context.
+ */
+typedef struct
+{
+    buffer_array_ctx_st    *tier_asp[BUFFER_TIER_COUNT];       /**< Primary, then secondary. */
+    buffer_tier_counters_st counters_as[BUFFER_TIER_COUNT];
+    uint64_t                foreign_releases;                  /**< Pointers owned by neither tier. */
+    bool                    is_initialized;
+} buffer_tier_ctx_st;
+
+/**
+ * @brief Initialize a tiered context over two initialized contexts.
+ *
+ * @param[out] tier_sp       Context to initialize.
+ * @param[in]  primary_sp    Fast tier, served first.
+ * @param[in]  secondary_sp  Overflow tier, buffers at least as large.
+ *
+ * @return false if a context is invalid, the secondary buffers are smaller,
+ *         or the two blocks overlap.
+ */
+bool buffer_tier_init(buffer_tier_ctx_st *tier_sp,
+                      buffer_array_ctx_st *primary_sp,
+                      buffer_array_ctx_st *secondary_sp);
+
+/**
+ * @brief Acquire from the primary tier, or from the secondary one when the
+ *        primary is exhausted.
+ *
+ * @param[in,out] tier_sp  Initialized context.
+ * @param[out]    tier_out_p  Tier that served the buffer, may be NULL.
+ *
+ * @return Buffer, or NULL if both tiers are exhausted.
+ */
+buffer_st *buffer_tier_acquire(buffer_tier_ctx_st *tier_sp, buffer_tier_et *tier_out_p);
+
+/**
+ * @brief Release a buffer of either tier by its data pointer.
+ *
+ * @return true if the pointer is the start of a buffer of one of the tiers.
+ */
+bool buffer_tier_release_by_ptr(buffer_tier_ctx_st *tier_sp, uint8_t *memory_u8p);
+
+/**
+ * @brief Copy the counters of one tier.
+ *
+ * @return false if the inputs are invalid.
+ */
+bool buffer_tier_read(buffer_tier_ctx_st const *tier_csp, buffer_tier_et tier_e, buffer_tier_counters_st *counters_sp);
+
+/**
+ * @brief Map a file of @p size_bytes as memory for a secondary tier (POSIX).
+ *
+ * The file is created if needed and sized to @p size_bytes; its pages are
+ * written back by the kernel, so the tier's capacity is not limited by RAM.
+ *
+ * @return Page-aligned block, or NULL on failure or on non-POSIX targets.
+ */
+uint8_t *buffer_tier_map_file(char const *path_cp, size_t size_bytes);
+
+/**
+ * @brief Unmap a block returned by @ref buffer_tier_map_file.
+ */
+void buffer_tier_unmap_file(uint8_t *block_u8p, size_t size_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_TIER_H_ */
@@ -0,0 +1,343 @@
+/**
+ * @file buffer_trace.c
+ * @brief Recorder of pool operations into a binary trace (POSIX).
+ *
+ * Only needed when the library is built with BUFFER_CFG_TRACE=1. A thread's
+ * ring is returned when the thread exits and handed out again once the
+ * drainer has written its last records.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "buffer_trace.h"
+#include "buffer_port.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BUFFER_TRACE_RING_MASK   (BUFFER_CFG_TRACE_RING_RECORDS - 1u)
+#define BUFFER_TRACE_DRAIN_NS    (1000000L)  /**< Drainer polling period. */
+#define BUFFER_TRACE_RETRY_MASK  (63u)       /**< A thread without a ring looks again every 64 events. */
+
+#if (0u != (BUFFER_CFG_TRACE_RING_RECORDS & BUFFER_TRACE_RING_MASK))
+#error "BUFFER_CFG_TRACE_RING_RECORDS must be a power of two"
+#endif
+
+/**
+ * @brief Per-thread record ring (single producer, drainer consumes).
+ *
+ * Producer and consumer indices live on separate cache lines.
+ */
+typedef struct
+{
+    buffer_trace_record_st records_as[BUFFER_CFG_TRACE_RING_RECORDS];
+    uint32_t               head_u32;         /**< Next slot to write (producer). */
+    uint64_t               dropped;          /**< Records lost to a full ring (producer). */
+    uint32_t               owned_u32;        /**< Non-zero from claim until the drainer returns the ring. */
+    uint32_t               released_u32;     /**< Owner exited; drain, then return the ring. */
+    uint8_t                pad_au8[64];
+    uint32_t               tail_u32;         /**< Next slot to drain (drainer). */
+} buffer_trace_ring_st;
+
+buffer_pool_st const *buffer_trace_pool_csp = NULL;
+
+static buffer_trace_ring_st buffer_trace_rings_as[BUFFER_CFG_TRACE_MAX_THREADS];
+static uint64_t             buffer_trace_overflow_dropped;   /**< Records from threads without a ring. */
+static pthread_once_t       buffer_trace_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t        buffer_trace_key;
+static bool                 buffer_trace_has_key;
+
+static BUFFER_PORT_THREAD_LOCAL buffer_trace_ring_st *buffer_trace_ring_sp;
+static BUFFER_PORT_THREAD_LOCAL uint32_t              buffer_trace_misses_u32;
+
+static FILE      *buffer_trace_file_fp;
+static pthread_t  buffer_trace_drainer;
+static int        buffer_trace_stop_flag;
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Read the trace timestamp (cycle counter, or CLOCK_MONOTONIC ns).
+ */
+static uint64_t buffer_trace_now(void)
+{
+#if (0 != BUFFER_PORT_HAS_TICKS)
+    return buffer_port_ticks();
+#else
+    struct timespec ts_s;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts_s);
+    return ((uint64_t)ts_s.tv_sec * 1000000000u) + (uint64_t)ts_s.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Measure the frequency of @ref buffer_trace_now.
+ *
+ * @return Timestamp ticks per second.
+ */
+static uint64_t buffer_trace_calibrate(void)
+{
+#if (0 != BUFFER_PORT_HAS_TICKS)
+    struct timespec start_s;
+    struct timespec now_s;
+    struct timespec pause_s = { 0, 20000000L };
+    uint64_t        start_ticks;
+    uint64_t        elapsed_ns;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &start_s);
+    start_ticks = buffer_port_ticks();
+    (void)nanosleep(&pause_s, NULL);
+    (void)clock_gettime(CLOCK_MONOTONIC, &now_s);
+
+    elapsed_ns = ((uint64_t)(now_s.tv_sec - start_s.tv_sec) * 1000000000u) +
+                 (uint64_t)now_s.tv_nsec - (uint64_t)start_s.tv_nsec;
+
+    return (uint64_t)(((double)(buffer_port_ticks() - start_ticks) * 1e9) / (double)elapsed_ns);
+#else
+    return UINT64_C(1000000000);
+#endif
+}
+
+/**
+ * @brief Write all pending records of one ring to the trace file.
+ */
+static void buffer_trace_drain_ring(buffer_trace_ring_st *ring_sp)
+{
+    uint32_t head = BUFFER_PORT_LOAD_ACQUIRE(&ring_sp->head_u32);
+    uint32_t tail = ring_sp->tail_u32;
+
+    while (tail != head)
+    {
+        uint32_t start = tail & BUFFER_TRACE_RING_MASK;
+        uint32_t count = head - tail;
+
+        /* Write up to the end of the ring, then wrap. */
+        if (count > (BUFFER_CFG_TRACE_RING_RECORDS - start))
+        {
+            count = BUFFER_CFG_TRACE_RING_RECORDS - start;
+        }
+
+        (void)fwrite(&ring_sp->records_as[start], sizeof(buffer_trace_record_st), count, buffer_trace_file_fp);
+        tail += count;
+    }
+
+    BUFFER_PORT_STORE_RELEASE(&ring_sp->tail_u32, tail);
+}
+
+/**
+ * @brief Hand a drained ring whose owner has exited back to the free set.
+ *
+ * Called by the drainer, or by start/stop while no drainer runs, after the
+ * ring's records were written or discarded.
+ */
+static void buffer_trace_return_ring(buffer_trace_ring_st *ring_sp)
+{
+    BUFFER_PORT_STORE_RELAXED(&ring_sp->released_u32, 0u);
+    BUFFER_PORT_STORE_RELEASE(&ring_sp->owned_u32, 0u);
+}
+
+static void buffer_trace_drain_all(void)
+{
+    uint32_t index;
+
+    for (index = 0u; index < BUFFER_CFG_TRACE_MAX_THREADS; ++index)
+    {
+        buffer_trace_ring_st *ring_sp     = &buffer_trace_rings_as[index];
+        bool const            is_released = (0u != BUFFER_PORT_LOAD_ACQUIRE(&ring_sp->released_u32));
+
+        /* Read the release first: the owner's last records precede it. */
+        buffer_trace_drain_ring(ring_sp);
+        if (true == is_released)
+        {
+            buffer_trace_return_ring(ring_sp);
+        }
+    }
+}
+
+static void *buffer_trace_drainer_main(void *arg_p)
+{
+    struct timespec period_s = { 0, BUFFER_TRACE_DRAIN_NS };
+
+    (void)arg_p;
+
+    while (0 == BUFFER_PORT_LOAD_ACQUIRE(&buffer_trace_stop_flag))
+    {
+        buffer_trace_drain_all();
+        (void)nanosleep(&period_s, NULL);
+    }
+
+    buffer_trace_drain_all();
+    return NULL;
+}
+
+/**
+ * @brief Mark the exiting thread's ring for return (pthread key destructor).
+ *
+ * The drainer writes what is left in it before anyone else may claim it.
+ */
+static void buffer_trace_thread_exit(void *ring_p)
+{
+    buffer_trace_ring_st *ring_sp = (buffer_trace_ring_st *)ring_p;
+
+    /* Later hooks on this thread (other destructors) must not write to it. */
+    buffer_trace_ring_sp = NULL;
+    BUFFER_PORT_STORE_RELEASE(&ring_sp->released_u32, 1u);
+}
+
+static void buffer_trace_key_create(void)
+{
+    buffer_trace_has_key = (0 == pthread_key_create(&buffer_trace_key, buffer_trace_thread_exit));
+}
+
+/**
+ * @brief Claim a free ring for the calling thread.
+ *
+ * @return The thread's ring, or NULL if all rings are owned or still
+ *         waiting to be drained.
+ */
+static buffer_trace_ring_st *buffer_trace_claim_ring(void)
+{
+    uint32_t slot;
+
+    (void)pthread_once(&buffer_trace_key_once, buffer_trace_key_create);
+
+    for (slot = 0u; slot < BUFFER_CFG_TRACE_MAX_THREADS; ++slot)
+    {
+        buffer_trace_ring_st *ring_sp = &buffer_trace_rings_as[slot];
+
+        /* Only the drainer clears the flag, so a ring is never claimed undrained. */
+        if ((0u == BUFFER_PORT_LOAD_RELAXED(&ring_sp->owned_u32)) &&
+            (0u == BUFFER_PORT_EXCHANGE(&ring_sp->owned_u32, 1u)))
+        {
+            /* Without a key the ring is never returned, as before. */
+            if (true == buffer_trace_has_key)
+            {
+                (void)pthread_setspecific(buffer_trace_key, ring_sp);
+            }
+
+            buffer_trace_ring_sp = ring_sp;
+            return ring_sp;
+        }
+    }
+
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Recorder API                                                               */
+/* -------------------------------------------------------------------------- */
+
+void buffer_trace_emit(buffer_trace_op_et op_e, uint32_t index)
+{
+    buffer_trace_ring_st   *ring_sp = buffer_trace_ring_sp;
+    buffer_trace_record_st *rec_sp;
+    uint32_t                head;
+
+    if (BUFFER_PORT_UNLIKELY(NULL == ring_sp))
+    {
+        /* Rings come back as threads exit: look again now and then. */
+        if (0u == (buffer_trace_misses_u32++ & BUFFER_TRACE_RETRY_MASK))
+        {
+            ring_sp = buffer_trace_claim_ring();
+        }
+        if (NULL == ring_sp)
+        {
+            (void)BUFFER_PORT_FETCH_ADD(&buffer_trace_overflow_dropped, 1u);
+            return;
+        }
+        buffer_trace_misses_u32 = 0u;
+    }
+
+    head = ring_sp->head_u32;
+    if (BUFFER_PORT_UNLIKELY((head - BUFFER_PORT_LOAD_ACQUIRE(&ring_sp->tail_u32)) >= BUFFER_CFG_TRACE_RING_RECORDS))
+    {
+        BUFFER_PORT_STORE_RELAXED(&ring_sp->dropped, ring_sp->dropped + 1u);
+        return;
+    }
+
+    rec_sp         = &ring_sp->records_as[head & BUFFER_TRACE_RING_MASK];
+    rec_sp->tsc    = buffer_trace_now();
+    rec_sp->index  = index;
+    rec_sp->thread = (uint16_t)(ring_sp - buffer_trace_rings_as);
+    rec_sp->op     = (uint8_t)op_e;
+    rec_sp->flags  = 0u;
+
+    BUFFER_PORT_STORE_RELEASE(&ring_sp->head_u32, head + 1u);
+}
+
+bool buffer_trace_start(buffer_pool_st const *pool_csp, char const *path_cp, size_t buffer_size)
+{
+    buffer_trace_header_st header_s;
+    uint32_t               index;
+
+    if ((NULL == pool_csp) || (NULL == path_cp) || (NULL != buffer_trace_file_fp))
+    {
+        return false;
+    }
+
+    buffer_trace_file_fp = fopen(path_cp, "wb");
+    if (NULL == buffer_trace_file_fp)
+    {
+        return false;
+    }
+
+    buffer_trace_header_init(&header_s, buffer_trace_calibrate(), pool_csp->buffer_count, buffer_size);
+    (void)fwrite(&header_s, sizeof(header_s), 1u, buffer_trace_file_fp);
+
+    /* Discard records that raced with the previous stop, and return the
+     * rings of threads that exited while no drainer ran. */
+    for (index = 0u; index < BUFFER_CFG_TRACE_MAX_THREADS; ++index)
+    {
+        buffer_trace_ring_st *ring_sp     = &buffer_trace_rings_as[index];
+        bool const            is_released = (0u != BUFFER_PORT_LOAD_ACQUIRE(&ring_sp->released_u32));
+
+        BUFFER_PORT_STORE_RELEASE(&ring_sp->tail_u32, BUFFER_PORT_LOAD_ACQUIRE(&ring_sp->head_u32));
+        if (true == is_released)
+        {
+            buffer_trace_return_ring(ring_sp);
+        }
+    }
+
+    BUFFER_PORT_STORE_RELEASE(&buffer_trace_stop_flag, 0);
+    if (0 != pthread_create(&buffer_trace_drainer, NULL, buffer_trace_drainer_main, NULL))
+    {
+        fclose(buffer_trace_file_fp);
+        buffer_trace_file_fp = NULL;
+        return false;
+    }
+
+    BUFFER_PORT_STORE_RELEASE(&buffer_trace_pool_csp, pool_csp);
+    return true;
+}
+
+void buffer_trace_stop(void)
+{
+    if (NULL == buffer_trace_file_fp)
+    {
+        return;
+    }
+
+    BUFFER_PORT_STORE_RELEASE(&buffer_trace_pool_csp, (buffer_pool_st const *)NULL);
+    BUFFER_PORT_STORE_RELEASE(&buffer_trace_stop_flag, 1);
+    (void)pthread_join(buffer_trace_drainer, NULL);
+
+    fclose(buffer_trace_file_fp);
+    buffer_trace_file_fp = NULL;
+}
+
+uint64_t buffer_trace_dropped(void)
+{
+    uint64_t dropped = BUFFER_PORT_LOAD_RELAXED(&buffer_trace_overflow_dropped);
+    uint32_t index;
+
+    for (index = 0u; index < BUFFER_CFG_TRACE_MAX_THREADS; ++index)
+    {
+        dropped += BUFFER_PORT_LOAD_RELAXED(&buffer_trace_rings_as[index].dropped);
+    }
+
+    return dropped;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file buffer_trace.h
+ * @brief Binary trace format of pool operations.
+ *
+ * A trace file is one @ref buffer_trace_header_st followed by any number of
+ * @ref buffer_trace_record_st. All fields are stored in host byte order;
+ * readers reject files whose header does not match (see
+ * @ref buffer_trace_header_is_valid).
+ *
+ * Records are not required to be sorted: writers that collect per-thread
+ * streams may interleave them. Readers order by @ref buffer_trace_record_st::tsc.
+ *
+ * When the library is built with @c BUFFER_CFG_TRACE=1, the recorder in
+ * buffer_trace.c captures the operations of one pool at a time. Each thread
+ * appends records to its own lock-free ring (one producer, one consumer);
+ * a background thread drains the rings into the trace file. A full ring
+ * drops records rather than block the caller (see @ref buffer_trace_dropped).
+ * With @c BUFFER_CFG_TRACE=0 the hooks in buffer.c compile to nothing.
+ */
+
+#ifndef BUFFER_TRACE_H_
+#define BUFFER_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUFFER_TRACE_MAGIC       "BUFTRACE"      /**< 8 bytes, without terminator. */
+#define BUFFER_TRACE_VERSION     (1u)
+#define BUFFER_TRACE_INDEX_NONE  (0xFFFFFFFFu)   /**< Record carries no buffer index. */
+
+/** Maximum number of threads that can record; later threads are counted as dropped. */
+#ifndef BUFFER_CFG_TRACE_MAX_THREADS
+#define BUFFER_CFG_TRACE_MAX_THREADS     (64u)
+#endif
+
+/** Records per thread ring (power of two). */
+#ifndef BUFFER_CFG_TRACE_RING_RECORDS
+#define BUFFER_CFG_TRACE_RING_RECORDS    (4096u)
+#endif
+
+/**
+ * @brief Traced operation.
+ */
+typedef enum
+{
+    BUFFER_TRACE_OP_ACQUIRE         = 1,     /**< Buffer @c index was acquired. */
+    BUFFER_TRACE_OP_ACQUIRE_FAIL    = 2,     /**< Acquire returned NULL (no index). */
+    BUFFER_TRACE_OP_RELEASE         = 3,     /**< Buffer @c index was released. */
+    BUFFER_TRACE_OP_RELEASE_INVALID = 4,     /**< Release of an unknown pointer (no index). */
+    BUFFER_TRACE_OP_MARK_ALL_FREE   = 5      /**< All buffers were marked free (no index). */
+} buffer_trace_op_et;
+
+/**
+ * @brief Trace file header.
+ */
+typedef struct
+{
+    char     magic_ac[8];            /**< @ref BUFFER_TRACE_MAGIC. */
+    uint32_t version;                /**< @ref BUFFER_TRACE_VERSION. */
+    uint32_t record_size;            /**< sizeof(@ref buffer_trace_record_st). */
+    uint64_t ticks_per_sec;          /**< Timestamp frequency of @ref buffer_trace_record_st::tsc. */
+    uint64_t buffer_count;           /**< Buffer count of the recorded pool, 0 if unknown. */
+    uint64_t buffer_size;            /**< Buffer size of the recorded pool, 0 if unknown. */
+} buffer_trace_header_st;
+
+/**
+ * @brief One traced operation (16 bytes).
+ */
+typedef struct
+{
+    uint64_t tsc;                    /**< Timestamp in header ticks. */
+    uint32_t index;                  /**< Buffer index in the recorded pool, or @ref BUFFER_TRACE_INDEX_NONE. */
+    uint16_t thread;                 /**< Small id of the calling thread; reused after it exits. */
+    uint8_t  op;                     /**< @ref buffer_trace_op_et. */
+    uint8_t  flags;                  /**< Reserved, zero. */
+} buffer_trace_record_st;
+
+/**
+ * @brief Fill a trace header for the current format version.
+ *
+ * @param[out] header_sp      Header to fill.
+ * @param[in]  ticks_per_sec  Timestamp frequency.
+ * @param[in]  buffer_count   Buffer count of the traced pool (0 if unknown).
+ * @param[in]  buffer_size    Buffer size of the traced pool (0 if unknown).
+ */
+static inline void buffer_trace_header_init(buffer_trace_header_st *header_sp,
+                                            uint64_t ticks_per_sec,
+                                            uint64_t buffer_count,
+                                            uint64_t buffer_size)
+{
+    memset(header_sp, 0, sizeof(*header_sp));
+    memcpy(header_sp->magic_ac, BUFFER_TRACE_MAGIC, sizeof(header_sp->magic_ac));
+    header_sp->version       = BUFFER_TRACE_VERSION;
+    header_sp->record_size   = (uint32_t)sizeof(buffer_trace_record_st);
+    header_sp->ticks_per_sec = ticks_per_sec;
+    header_sp->buffer_count  = buffer_count;
+    header_sp->buffer_size   = buffer_size;
+}
+
+/**
+ * @brief Check that a header was written by a compatible writer.
+ *
+ * @param[in] header_csp  Header read from a trace file.
+ *
+ * @return true if magic, version and record size match this build.
+ */
+static inline bool buffer_trace_header_is_valid(buffer_trace_header_st const *header_csp)
+{
+    return ((0 == memcmp(header_csp->magic_ac, BUFFER_TRACE_MAGIC, sizeof(header_csp->magic_ac))) &&
+            (BUFFER_TRACE_VERSION == header_csp->version)                                      &&
+            (sizeof(buffer_trace_record_st) == header_csp->record_size)                        &&
+            (0u != header_csp->ticks_per_sec));
+}
+
+/* -------------------------------------------------------------------------- */
+/* Recorder API (BUFFER_CFG_TRACE=1)                                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Pool currently being traced, or NULL.
+ *
+ * Read by the hooks in buffer.c; set through @ref buffer_trace_start and
+ * @ref buffer_trace_stop only.
+ */
+extern buffer_pool_st const *buffer_trace_pool_csp;
+
+/**
+ * @brief Start recording the operations of one pool to a file.
+ *
+ * @param[in] pool_csp     Pool to trace.
+ * @param[in] path_cp      Output file, truncated if it exists.
+ * @param[in] buffer_size  Buffer size stored in the header (0 if unknown).
+ *
+ * @return true if recording started, false if already recording or the
+ *         file or drainer thread could not be created.
+ */
+bool buffer_trace_start(buffer_pool_st const *pool_csp, char const *path_cp, size_t buffer_size);
+
+/**
+ * @brief Stop recording, drain all rings and close the file.
+ *
+ * Does nothing if not recording.
+ */
+void buffer_trace_stop(void);
+
+/**
+ * @brief Append one record to the calling thread's ring.
+ *
+ * Called by the hooks in buffer.c; may also be used to inject records.
+ *
+ * @param[in] op_e   Operation.
+ * @param[in] index  Buffer index, or @ref BUFFER_TRACE_INDEX_NONE.
+ */
+void buffer_trace_emit(buffer_trace_op_et op_e, uint32_t index);
+
+/**
+ * @brief Number of records dropped because a ring was full or too many
+ *        threads were recording at once.
+ *
+ * A ring is returned when its thread exits (the recorder links POSIX
+ * threads) and can be claimed again once its last records were drained.
+ */
+uint64_t buffer_trace_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_TRACE_H_ */
@@ -0,0 +1,207 @@
+/**
+ * @file buffer_tuner.c
+ * @brief Background control loop that sizes a segmented context (POSIX).
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "buffer_tuner.h"
+#include "buffer_port.h"
+
+#include <string.h>
+#include <time.h>
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+static void *buffer_tuner_main(void *arg_p)
+{
+    buffer_tuner_st *tuner_sp = (buffer_tuner_st *)arg_p;
+    struct timespec  period_s;
+
+    period_s.tv_sec  = (time_t)(tuner_sp->cfg_s.period_ms / 1000u);
+    period_s.tv_nsec = (long)(tuner_sp->cfg_s.period_ms % 1000u) * 1000000L;
+
+    while (0 == BUFFER_PORT_LOAD_ACQUIRE(&tuner_sp->stop_flag))
+    {
+        (void)nanosleep(&period_s, NULL);
+        buffer_tuner_step(tuner_sp);
+    }
+
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Tuner API                                                                  */
+/* -------------------------------------------------------------------------- */
+
+void buffer_tuner_cfg_default(buffer_tuner_cfg_st *cfg_sp, size_t segment_buffers, size_t max_buffers)
+{
+    if (NULL == cfg_sp)
+    {
+        return;
+    }
+
+    cfg_sp->period_ms         = 1000u;
+    cfg_sp->segment_buffers   = segment_buffers;
+    cfg_sp->min_buffers       = segment_buffers;
+    cfg_sp->max_buffers       = max_buffers;
+    cfg_sp->alpha             = 0.3;
+    cfg_sp->beta              = 0.2;
+    cfg_sp->lookahead_periods = 5.0;
+    cfg_sp->headroom          = 0.2;
+    cfg_sp->shrink_periods    = 30u;
+}
+
+bool buffer_tuner_init(buffer_tuner_st *tuner_sp, buffer_seg_ctx_st *seg_ctx_sp, buffer_tuner_cfg_st const *cfg_csp)
+{
+    if ((NULL == tuner_sp) || (NULL == seg_ctx_sp) || (NULL == cfg_csp) ||
+        (false == seg_ctx_sp->is_initialized)                           ||
+        (0u == cfg_csp->period_ms)                                      ||
+        (0u == cfg_csp->segment_buffers)                                ||
+        (cfg_csp->min_buffers > cfg_csp->max_buffers)                   ||
+        (0.0 >= cfg_csp->alpha) || (1.0 < cfg_csp->alpha)               ||
+        (0.0 >= cfg_csp->beta)  || (1.0 < cfg_csp->beta))
+    {
+        return false;
+    }
+
+    memset(tuner_sp, 0, sizeof(*tuner_sp));
+    tuner_sp->cfg_s      = *cfg_csp;
+    tuner_sp->seg_ctx_sp = seg_ctx_sp;
+    return true;
+}
+
+void buffer_tuner_step(buffer_tuner_st *tuner_sp)
+{
+    buffer_tuner_cfg_st const *cfg_csp;
+    buffer_seg_sample_st       sample_s;
+    uint64_t                   failed;
+    double                     demand;
+    double                     forecast;
+    size_t                     target;
+    size_t                     wanted;
+    size_t                     capacity;
+    size_t                     draining;
+
+    if ((NULL == tuner_sp) || (NULL == tuner_sp->seg_ctx_sp))
+    {
+        return;
+    }
+
+    cfg_csp = &tuner_sp->cfg_s;
+    buffer_seg_sample(tuner_sp->seg_ctx_sp, &sample_s);
+
+    failed                = sample_s.failed_acquires - tuner_sp->last_failed;
+    tuner_sp->last_failed = sample_s.failed_acquires;
+
+    /* Failed acquires are demand the pool could not see; count up to one segment of it. */
+    demand = (double)sample_s.peak_in_use +
+             (double)((failed < cfg_csp->segment_buffers) ? failed : cfg_csp->segment_buffers);
+
+    /* Holt's linear smoothing: level follows the peaks, trend their slope. */
+    if (false == tuner_sp->is_primed)
+    {
+        tuner_sp->level     = demand;
+        tuner_sp->trend     = 0.0;
+        tuner_sp->is_primed = true;
+    }
+    else
+    {
+        double previous = tuner_sp->level;
+
+        tuner_sp->level = (cfg_csp->alpha * demand) + ((1.0 - cfg_csp->alpha) * (previous + tuner_sp->trend));
+        tuner_sp->trend = (cfg_csp->beta * (tuner_sp->level - previous)) + ((1.0 - cfg_csp->beta) * tuner_sp->trend);
+
+        if (tuner_sp->level < 0.0)
+        {
+            tuner_sp->level = 0.0;
+        }
+    }
+
+    forecast = tuner_sp->level + (tuner_sp->trend * cfg_csp->lookahead_periods);
+    if (forecast < demand)
+    {
+        forecast = demand;
+    }
+
+    target   = (size_t)(forecast * (1.0 + cfg_csp->headroom)) + 1u;
+    wanted   = (target > cfg_csp->min_buffers) ? target : cfg_csp->min_buffers;
+    capacity = sample_s.capacity;
+    draining = sample_s.draining_buffers;
+
+    if ((0u < failed) || (capacity < wanted))
+    {
+        tuner_sp->low_periods = 0u;
+
+        while (capacity < wanted)
+        {
+            /* A draining segment still holds its memory: reuse it first. */
+            size_t reactivated = buffer_seg_reactivate(tuner_sp->seg_ctx_sp);
+
+            if (0u < reactivated)
+            {
+                capacity += reactivated;
+                draining  = (draining > reactivated) ? (draining - reactivated) : 0u;
+                tuner_sp->reactivate_count++;
+                continue;
+            }
+
+            if (((capacity + draining + cfg_csp->segment_buffers) > cfg_csp->max_buffers) ||
+                (false == buffer_seg_add(tuner_sp->seg_ctx_sp, cfg_csp->segment_buffers)))
+            {
+                break;
+            }
+            capacity += cfg_csp->segment_buffers;
+            tuner_sp->grow_count++;
+        }
+    }
+    else if ((capacity >= (wanted + cfg_csp->segment_buffers)) && (0u < sample_s.active_segments))
+    {
+        tuner_sp->low_periods++;
+        if (tuner_sp->low_periods >= cfg_csp->shrink_periods)
+        {
+            if (true == buffer_seg_drain(tuner_sp->seg_ctx_sp, wanted))
+            {
+                tuner_sp->drain_count++;
+            }
+            tuner_sp->low_periods = 0u;
+        }
+    }
+    else
+    {
+        tuner_sp->low_periods = 0u;
+    }
+
+    (void)buffer_seg_reclaim(tuner_sp->seg_ctx_sp);
+}
+
+bool buffer_tuner_start(buffer_tuner_st *tuner_sp)
+{
+    if ((NULL == tuner_sp) || (NULL == tuner_sp->seg_ctx_sp) || (true == tuner_sp->is_running))
+    {
+        return false;
+    }
+
+    BUFFER_PORT_STORE_RELEASE(&tuner_sp->stop_flag, 0);
+    if (0 != pthread_create(&tuner_sp->thread, NULL, buffer_tuner_main, tuner_sp))
+    {
+        return false;
+    }
+
+    tuner_sp->is_running = true;
+    return true;
+}
+
+void buffer_tuner_stop(buffer_tuner_st *tuner_sp)
+{
+    if ((NULL == tuner_sp) || (false == tuner_sp->is_running))
+    {
+        return;
+    }
+
+    BUFFER_PORT_STORE_RELEASE(&tuner_sp->stop_flag, 1);
+    (void)pthread_join(tuner_sp->thread, NULL);
+    tuner_sp->is_running = false;
+}
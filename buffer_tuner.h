@@ -0,0 +1,114 @@
+/**
+ * @file buffer_tuner.h
+ * @brief Background control loop that sizes a segmented context (POSIX).
+ *
+ * Every period the tuner samples a @ref buffer_seg_ctx_st (see
+ * buffer_seg.h) and decides whether to add or drain a segment:
+ *  - demand is the peak in-use count of the period, smoothed with an
+ *    exponentially weighted moving average (EWMA) and extended by its
+ *    smoothed trend @c lookahead_periods ahead, plus @c headroom;
+ *  - it grows at once when the forecast exceeds capacity or any acquire
+ *    failed in the period, first by putting draining segments back into
+ *    service and only then by adding segments;
+ *  - it shrinks only after @c shrink_periods consecutive periods in which
+ *    the forecast would still fit with one segment less (hysteresis), and
+ *    then drains a single segment; drained segments are returned to the
+ *    provider once their buffers are released.
+ * Capacity stays within [@c min_buffers, @c max_buffers]; segments that
+ * are still draining count against @c max_buffers, since they still hold
+ * their memory.
+ *
+ * The tuner only takes the context's lock for a sample or a resize, so the
+ * acquire and release paths are unchanged. @ref buffer_tuner_step runs one
+ * iteration synchronously, for callers with their own timer thread.
+ */
+
+#ifndef BUFFER_TUNER_H_
+#define BUFFER_TUNER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "buffer_seg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Tuner configuration.
+ */
+typedef struct
+{
+    uint32_t period_ms;              /**< Sampling period. */
+    size_t   segment_buffers;        /**< Buffers per added segment. */
+    size_t   min_buffers;            /**< Capacity never drained below this. */
+    size_t   max_buffers;            /**< Active plus draining buffers never grown above this. */
+    double   alpha;                  /**< EWMA weight of the newest peak (0, 1]. */
+    double   beta;                   /**< EWMA weight of the newest trend (0, 1]. */
+    double   lookahead_periods;      /**< How far ahead the trend is extrapolated. */
+    double   headroom;               /**< Spare fraction on top of the forecast, e.g. 0.2. */
+    uint32_t shrink_periods;         /**< Consecutive low periods before a drain. */
+} buffer_tuner_cfg_st;
+
+/**
+ * @brief Tuner state.
+ */
+typedef struct
+{
+    buffer_tuner_cfg_st cfg_s;
+    buffer_seg_ctx_st  *seg_ctx_sp;
+    double              level;               /**< Smoothed peak demand. */
+    double              trend;               /**< Smoothed change of @ref level per period. */
+    uint64_t            last_failed;         /**< Failed acquires at the previous sample. */
+    uint32_t            low_periods;         /**< Consecutive periods with spare capacity. */
+    bool                is_primed;           /**< @ref level holds a sample. */
+    uint64_t            grow_count;          /**< Segments added. */
+    uint64_t            reactivate_count;    /**< Draining segments put back into service. */
+    uint64_t            drain_count;         /**< Segments drained. */
+    pthread_t           thread;
+    int                 stop_flag;
+    bool                is_running;
+} buffer_tuner_st;
+
+/**
+ * @brief Fill a configuration with defaults for a segment size.
+ *
+ * @param[out] cfg_sp           Configuration to fill.
+ * @param[in]  segment_buffers  Buffers per segment.
+ * @param[in]  max_buffers      Upper capacity limit.
+ */
+void buffer_tuner_cfg_default(buffer_tuner_cfg_st *cfg_sp, size_t segment_buffers, size_t max_buffers);
+
+/**
+ * @brief Prepare a tuner without starting its thread.
+ *
+ * @return true if the configuration is valid.
+ */
+bool buffer_tuner_init(buffer_tuner_st *tuner_sp, buffer_seg_ctx_st *seg_ctx_sp, buffer_tuner_cfg_st const *cfg_csp);
+
+/**
+ * @brief Run one control iteration: sample, decide, resize, reclaim.
+ */
+void buffer_tuner_step(buffer_tuner_st *tuner_sp);
+
+/**
+ * @brief Start the background thread (calls @ref buffer_tuner_step each period).
+ *
+ * @return true if the thread was created.
+ */
+bool buffer_tuner_start(buffer_tuner_st *tuner_sp);
+
+/**
+ * @brief Stop and join the background thread. Capacity is left as is.
+ */
+void buffer_tuner_stop(buffer_tuner_st *tuner_sp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_TUNER_H_ */
@@ -0,0 +1,355 @@
+/**
+ * @file buffer_umem.c
+ * @brief Fill and completion rings between an application and an I/O
+ *        engine thread, modeled on AF_XDP UMEM.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "buffer_umem.h"
+#include "buffer_port.h"
+
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BUFFER_UMEM_HAS_READV    (1)
+#include <errno.h>
+#include <sys/uio.h>
+#else
+#define BUFFER_UMEM_HAS_READV    (0)
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+static bool buffer_umem_is_valid(buffer_umem_st const *umem_csp)
+{
+    return ((NULL != umem_csp) && (true == umem_csp->is_initialized));
+}
+
+/**
+ * @brief Producer: give back the newest @p count_u32 reserved entries.
+ */
+static void buffer_umem_ring_unreserve(buffer_umem_ring_st *ring_sp, uint32_t count_u32)
+{
+    ring_sp->prod_cached_prod_u32 -= count_u32;
+}
+
+#if (0 != BUFFER_UMEM_HAS_READV)
+
+static int buffer_umem_fd_rx(void *engine_p, buffer_umem_io_st *io_as, uint32_t count_u32)
+{
+    buffer_umem_fd_st const *fd_csp = engine_p;
+    struct iovec             iov_as[BUFFER_UMEM_MAX_BATCH];
+    ssize_t                  got;
+    size_t                   left;
+    uint32_t                 index;
+
+    if (count_u32 > BUFFER_UMEM_MAX_BATCH)
+    {
+        count_u32 = BUFFER_UMEM_MAX_BATCH;
+    }
+
+    for (index = 0u; index < count_u32; ++index)
+    {
+        iov_as[index].iov_base = io_as[index].data_u8p;
+        iov_as[index].iov_len  = io_as[index].capacity_u32;
+    }
+
+    got = readv(fd_csp->fd, iov_as, (int)count_u32);
+    if (0 > got)
+    {
+        return ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno)) ? 0 : -1;
+    }
+    if (0 == got)
+    {
+        return -1;   /* End of input. */
+    }
+
+    /* readv() fills the frames in order; the last one may be partial. */
+    left = (size_t)got;
+    for (index = 0u; (index < count_u32) && (0u != left); ++index)
+    {
+        uint32_t length_u32 = (left < io_as[index].capacity_u32) ? (uint32_t)left : io_as[index].capacity_u32;
+
+        io_as[index].length_u32  = length_u32;
+        io_as[index].options_u32 = 0u;
+        left                    -= length_u32;
+    }
+
+    return (int)index;
+}
+
+#endif /* BUFFER_UMEM_HAS_READV */
+
+/* -------------------------------------------------------------------------- */
+/* Ring API                                                                   */
+/* -------------------------------------------------------------------------- */
+
+bool buffer_umem_ring_init(buffer_umem_ring_st *ring_sp, buffer_umem_desc_st *desc_as, uint32_t size_u32)
+{
+    if ((NULL == ring_sp) || (NULL == desc_as) || (0u == size_u32) || (0u != (size_u32 & (size_u32 - 1u))))
+    {
+        return false;
+    }
+
+    memset(ring_sp, 0, sizeof(*ring_sp));
+    ring_sp->desc_as  = desc_as;
+    ring_sp->size_u32 = size_u32;
+    ring_sp->mask_u32 = size_u32 - 1u;
+    return true;
+}
+
+uint32_t buffer_umem_ring_reserve(buffer_umem_ring_st *ring_sp, uint32_t count_u32, uint32_t *index_u32p)
+{
+    uint32_t free_u32 = ring_sp->size_u32 - (ring_sp->prod_cached_prod_u32 - ring_sp->prod_cached_cons_u32);
+
+    /* Only look at the consumer's index when the cached view runs short. */
+    if (free_u32 < count_u32)
+    {
+        ring_sp->prod_cached_cons_u32 = BUFFER_PORT_LOAD_ACQUIRE(&ring_sp->consumer_u32);
+        free_u32 = ring_sp->size_u32 - (ring_sp->prod_cached_prod_u32 - ring_sp->prod_cached_cons_u32);
+    }
+
+    if (count_u32 > free_u32)
+    {
+        count_u32 = free_u32;
+    }
+
+    *index_u32p                    = ring_sp->prod_cached_prod_u32;
+    ring_sp->prod_cached_prod_u32 += count_u32;
+    return count_u32;
+}
+
+void buffer_umem_ring_submit(buffer_umem_ring_st *ring_sp, uint32_t count_u32)
+{
+    if (0u != count_u32)
+    {
+        BUFFER_PORT_STORE_RELEASE(&ring_sp->producer_u32, ring_sp->producer_u32 + count_u32);
+    }
+}
+
+uint32_t buffer_umem_ring_peek(buffer_umem_ring_st *ring_sp, uint32_t count_u32, uint32_t *index_u32p)
+{
+    uint32_t avail_u32 = ring_sp->cons_cached_prod_u32 - ring_sp->cons_cached_cons_u32;
+
+    if (avail_u32 < count_u32)
+    {
+        ring_sp->cons_cached_prod_u32 = BUFFER_PORT_LOAD_ACQUIRE(&ring_sp->producer_u32);
+        avail_u32 = ring_sp->cons_cached_prod_u32 - ring_sp->cons_cached_cons_u32;
+    }
+
+    if (count_u32 > avail_u32)
+    {
+        count_u32 = avail_u32;
+    }
+
+    *index_u32p                    = ring_sp->cons_cached_cons_u32;
+    ring_sp->cons_cached_cons_u32 += count_u32;
+    return count_u32;
+}
+
+void buffer_umem_ring_release(buffer_umem_ring_st *ring_sp, uint32_t count_u32)
+{
+    if (0u != count_u32)
+    {
+        BUFFER_PORT_STORE_RELEASE(&ring_sp->consumer_u32, ring_sp->consumer_u32 + count_u32);
+    }
+}
+
+void buffer_umem_ring_cancel(buffer_umem_ring_st *ring_sp, uint32_t count_u32)
+{
+    ring_sp->cons_cached_cons_u32 -= count_u32;
+}
+
+/* -------------------------------------------------------------------------- */
+/* UMEM API                                                                   */
+/* -------------------------------------------------------------------------- */
+
+bool buffer_umem_init(buffer_umem_st *umem_sp,
+                      buffer_array_ctx_st *ctx_sp,
+                      buffer_umem_desc_st *fill_as,
+                      uint32_t fill_size,
+                      buffer_umem_desc_st *comp_as,
+                      uint32_t comp_size)
+{
+    if ((NULL == umem_sp) || (NULL == ctx_sp) || (false == ctx_sp->is_initialized) ||
+        (ctx_sp->buffer_size > UINT32_MAX))
+    {
+        return false;
+    }
+
+    memset(umem_sp, 0, sizeof(*umem_sp));
+
+    if ((false == buffer_umem_ring_init(&umem_sp->fill_s, fill_as, fill_size)) ||
+        (false == buffer_umem_ring_init(&umem_sp->comp_s, comp_as, comp_size)))
+    {
+        return false;
+    }
+
+    umem_sp->ctx_sp         = ctx_sp;
+    umem_sp->is_initialized = true;
+    return true;
+}
+
+uint64_t buffer_umem_addr(buffer_umem_st const *umem_csp, buffer_st const *buffer_csp)
+{
+    return (uint64_t)((uintptr_t)buffer_csp->data_u8p - (uintptr_t)umem_csp->ctx_sp->memory_block_u8p);
+}
+
+buffer_st *buffer_umem_frame(buffer_umem_st const *umem_csp, uint64_t addr_u64)
+{
+    buffer_array_ctx_st const *ctx_csp;
+
+    if (false == buffer_umem_is_valid(umem_csp))
+    {
+        return NULL;
+    }
+
+    ctx_csp = umem_csp->ctx_sp;
+
+    if ((0u != (addr_u64 % ctx_csp->buffer_size)) || ((addr_u64 / ctx_csp->buffer_size) >= ctx_csp->buffer_count))
+    {
+        return NULL;
+    }
+
+    return &ctx_csp->buffer_array_sa[addr_u64 / ctx_csp->buffer_size];
+}
+
+uint32_t buffer_umem_fill(buffer_umem_st *umem_sp, uint32_t count_u32)
+{
+    uint32_t index_u32;
+    uint32_t reserved;
+    uint32_t filled;
+
+    if (false == buffer_umem_is_valid(umem_sp))
+    {
+        return 0u;
+    }
+
+    reserved = buffer_umem_ring_reserve(&umem_sp->fill_s, count_u32, &index_u32);
+
+    for (filled = 0u; filled < reserved; ++filled)
+    {
+        buffer_umem_desc_st *desc_sp   = buffer_umem_ring_desc(&umem_sp->fill_s, index_u32 + filled);
+        buffer_st           *buffer_sp = buffer_array_acquire(umem_sp->ctx_sp);
+
+        if (NULL == buffer_sp)
+        {
+            break;
+        }
+
+        desc_sp->addr_u64    = buffer_umem_addr(umem_sp, buffer_sp);
+        desc_sp->length_u32  = 0u;
+        desc_sp->options_u32 = 0u;
+    }
+
+    buffer_umem_ring_unreserve(&umem_sp->fill_s, reserved - filled);
+    buffer_umem_ring_submit(&umem_sp->fill_s, filled);
+    return filled;
+}
+
+uint32_t buffer_umem_complete(buffer_umem_st *umem_sp, buffer_umem_frame_st *frame_as, uint32_t max_frames)
+{
+    uint32_t index_u32;
+    uint32_t count;
+    uint32_t frame;
+
+    if ((false == buffer_umem_is_valid(umem_sp)) || (NULL == frame_as))
+    {
+        return 0u;
+    }
+
+    count = buffer_umem_ring_peek(&umem_sp->comp_s, max_frames, &index_u32);
+
+    for (frame = 0u; frame < count; ++frame)
+    {
+        buffer_umem_desc_st const *desc_csp = buffer_umem_ring_desc(&umem_sp->comp_s, index_u32 + frame);
+
+        frame_as[frame].buffer_sp   = buffer_umem_frame(umem_sp, desc_csp->addr_u64);
+        frame_as[frame].length_u32  = desc_csp->length_u32;
+        frame_as[frame].options_u32 = desc_csp->options_u32;
+    }
+
+    buffer_umem_ring_release(&umem_sp->comp_s, count);
+    return count;
+}
+
+int buffer_umem_engine_poll(buffer_umem_st *umem_sp, buffer_umem_engine_st const *engine_csp)
+{
+    buffer_umem_io_st io_as[BUFFER_UMEM_MAX_BATCH];
+    uint32_t          fill_index_u32;
+    uint32_t          comp_index_u32;
+    uint32_t          room;
+    uint32_t          count;
+    uint32_t          done;
+    uint32_t          frame;
+    int               result;
+
+    if ((false == buffer_umem_is_valid(umem_sp)) || (NULL == engine_csp) || (NULL == engine_csp->rx_fn))
+    {
+        return -1;
+    }
+
+    /* Take no more frames than the completion ring can return. */
+    room  = buffer_umem_ring_reserve(&umem_sp->comp_s, BUFFER_UMEM_MAX_BATCH, &comp_index_u32);
+    count = buffer_umem_ring_peek(&umem_sp->fill_s, room, &fill_index_u32);
+
+    if (0u == count)
+    {
+        buffer_umem_ring_unreserve(&umem_sp->comp_s, room);
+        return 0;
+    }
+
+    /* Fill ring addresses come from the application and are trusted. */
+    for (frame = 0u; frame < count; ++frame)
+    {
+        buffer_umem_desc_st const *desc_csp = buffer_umem_ring_desc(&umem_sp->fill_s, fill_index_u32 + frame);
+
+        io_as[frame].data_u8p     = &umem_sp->ctx_sp->memory_block_u8p[desc_csp->addr_u64];
+        io_as[frame].capacity_u32 = (uint32_t)umem_sp->ctx_sp->buffer_size;
+        io_as[frame].length_u32   = 0u;
+        io_as[frame].options_u32  = 0u;
+    }
+
+    result = engine_csp->rx_fn(engine_csp->engine_p, io_as, count);
+    done   = (0 < result) ? (((uint32_t)result < count) ? (uint32_t)result : count) : 0u;
+
+    for (frame = 0u; frame < done; ++frame)
+    {
+        buffer_umem_desc_st *comp_sp = buffer_umem_ring_desc(&umem_sp->comp_s, comp_index_u32 + frame);
+
+        comp_sp->addr_u64    = buffer_umem_ring_desc(&umem_sp->fill_s, fill_index_u32 + frame)->addr_u64;
+        comp_sp->length_u32  = io_as[frame].length_u32;
+        comp_sp->options_u32 = io_as[frame].options_u32;
+    }
+
+    /* Frames the engine did not fill stay at the head of the fill ring. */
+    buffer_umem_ring_cancel(&umem_sp->fill_s, count - done);
+    buffer_umem_ring_release(&umem_sp->fill_s, done);
+    buffer_umem_ring_unreserve(&umem_sp->comp_s, room - done);
+    buffer_umem_ring_submit(&umem_sp->comp_s, done);
+
+    return (0 > result) ? result : (int)done;
+}
+
+bool buffer_umem_fd_engine_init(buffer_umem_engine_st *engine_sp, buffer_umem_fd_st *fd_sp, int fd)
+{
+#if (0 != BUFFER_UMEM_HAS_READV)
+    if ((NULL == engine_sp) || (NULL == fd_sp) || (0 > fd))
+    {
+        return false;
+    }
+
+    fd_sp->fd            = fd;
+    engine_sp->rx_fn     = buffer_umem_fd_rx;
+    engine_sp->engine_p  = fd_sp;
+    return true;
+#else
+    (void)engine_sp;
+    (void)fd_sp;
+    (void)fd;
+    return false;
+#endif
+}
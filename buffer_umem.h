@@ -0,0 +1,264 @@
+/**
+ * @file buffer_umem.h
+ * @brief Fill and completion rings between an application and an I/O
+ *        engine thread, modeled on AF_XDP UMEM.
+ *
+ * The frames are the buffers of a @ref buffer_array_ctx_st and are named
+ * by their byte offset in the context's memory block, so ring entries stay
+ * meaningful to any agent that maps the same block. The application puts
+ * free frames on the fill ring; the engine takes them, performs I/O into
+ * them and puts them with their lengths on the completion ring; the
+ * application takes the filled frames from there. Frames are never copied.
+ *
+ * Both rings are single-producer single-consumer. As in libxdp, each side
+ * keeps cached copies of the two indices and only reads the other side's
+ * index when its cache runs out; reserve/submit and peek/release move any
+ * number of entries with one index store, so a batch costs one cache line
+ * transfer per ring rather than one per frame.
+ *
+ * The engine's I/O is pluggable (@ref buffer_umem_engine_st): it is handed
+ * a batch of frames and reports how many it filled, in order. A readv()
+ * backend for pipes, sockets and files is provided
+ * (@ref buffer_umem_fd_engine_init); an io_uring or device backend plugs in
+ * the same way.
+ *
+ * One application thread calls the application functions and one engine
+ * thread calls @ref buffer_umem_engine_poll.
+ */
+
+#ifndef BUFFER_UMEM_H_
+#define BUFFER_UMEM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUFFER_UMEM_MAX_BATCH    (64u)       /**< Frames handed to the engine per call. */
+
+/**
+ * @brief Ring entry: a frame and, on the completion ring, its length.
+ */
+typedef struct
+{
+    uint64_t addr_u64;               /**< Frame offset in the memory block. */
+    uint32_t length_u32;             /**< Bytes filled (completion ring), 0 on the fill ring. */
+    uint32_t options_u32;            /**< Engine-defined flags, 0 if unused. */
+} buffer_umem_desc_st;
+
+/**
+ * @brief SPSC ring of @ref buffer_umem_desc_st.
+ *
+ * The shared indices and each side's cached indices sit on separate cache
+ * lines. Indices are free-running.
+ */
+typedef struct
+{
+    buffer_umem_desc_st *desc_as;
+    uint32_t             size_u32;           /**< Entries, a power of two. */
+    uint32_t             mask_u32;
+
+    uint32_t             producer_u32 BUFFER_CACHE_ALIGNED; /**< Written by the producer. */
+    uint32_t             consumer_u32 BUFFER_CACHE_ALIGNED; /**< Written by the consumer. */
+
+    /* Producer's view. */
+    uint32_t             prod_cached_prod_u32 BUFFER_CACHE_ALIGNED;
+    uint32_t             prod_cached_cons_u32;
+
+    /* Consumer's view. */
+    uint32_t             cons_cached_prod_u32 BUFFER_CACHE_ALIGNED;
+    uint32_t             cons_cached_cons_u32;
+} buffer_umem_ring_st;
+
+/**
+ * @brief Frame handed to an engine.
+ */
+typedef struct
+{
+    uint8_t  *data_u8p;              /**< Start of the frame. */
+    uint32_t  capacity_u32;          /**< Frame size. */
+    uint32_t  length_u32;            /**< Bytes filled, set by the engine. */
+    uint32_t  options_u32;           /**< Engine flags, copied to the completion. */
+} buffer_umem_io_st;
+
+/**
+ * @brief Pluggable I/O engine.
+ */
+typedef struct
+{
+    /**
+     * Fill frames in order. Sets @c length_u32 (and optionally
+     * @c options_u32) of the first N entries of @p io_as.
+     *
+     * @return N, 0 if no data is ready, or negative on error or end of input.
+     */
+    int  (*rx_fn)(void *engine_p, buffer_umem_io_st *io_as, uint32_t count_u32);
+    void  *engine_p;                 /**< Backend state, passed to @c rx_fn. */
+} buffer_umem_engine_st;
+
+/**
+ * @brief UMEM: a buffer array and its two rings.
+ */
+typedef struct
+{
+    buffer_array_ctx_st *ctx_sp;
+    buffer_umem_ring_st  fill_s;             /**< Application to engine: free frames. */
+    buffer_umem_ring_st  comp_s;             /**< Engine to application: filled frames. */
+    bool                 is_initialized;
+} buffer_umem_st;
+
+/**
+ * @brief Filled frame, as returned by @ref buffer_umem_complete.
+ */
+typedef struct
+{
+    buffer_st *buffer_sp;            /**< Frame, now held by the application. */
+    uint32_t   length_u32;
+    uint32_t   options_u32;
+} buffer_umem_frame_st;
+
+/* -------------------------------------------------------------------------- */
+/* Ring API                                                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Initialize an empty ring over @p size_u32 caller-provided entries.
+ *
+ * @return false unless @p size_u32 is a non-zero power of two.
+ */
+bool buffer_umem_ring_init(buffer_umem_ring_st *ring_sp, buffer_umem_desc_st *desc_as, uint32_t size_u32);
+
+/**
+ * @brief Producer: reserve up to @p count_u32 entries.
+ *
+ * @param[out] index_u32p  First reserved index.
+ *
+ * @return Entries reserved, possibly fewer than requested.
+ */
+uint32_t buffer_umem_ring_reserve(buffer_umem_ring_st *ring_sp, uint32_t count_u32, uint32_t *index_u32p);
+
+/**
+ * @brief Producer: publish the next @p count_u32 reserved entries.
+ */
+void buffer_umem_ring_submit(buffer_umem_ring_st *ring_sp, uint32_t count_u32);
+
+/**
+ * @brief Consumer: look at up to @p count_u32 published entries.
+ *
+ * @param[out] index_u32p  First available index.
+ *
+ * @return Entries available, possibly fewer than requested.
+ */
+uint32_t buffer_umem_ring_peek(buffer_umem_ring_st *ring_sp, uint32_t count_u32, uint32_t *index_u32p);
+
+/**
+ * @brief Consumer: give back the oldest @p count_u32 peeked entries to the producer.
+ */
+void buffer_umem_ring_release(buffer_umem_ring_st *ring_sp, uint32_t count_u32);
+
+/**
+ * @brief Consumer: un-peek the newest @p count_u32 peeked entries, so they
+ *        are returned by the next peek.
+ */
+void buffer_umem_ring_cancel(buffer_umem_ring_st *ring_sp, uint32_t count_u32);
+
+/**
+ * @brief Entry at a free-running index.
+ */
+static inline buffer_umem_desc_st *buffer_umem_ring_desc(buffer_umem_ring_st *ring_sp, uint32_t index_u32)
+{
+    return &ring_sp->desc_as[index_u32 & ring_sp->mask_u32];
+}
+
+/* -------------------------------------------------------------------------- */
+/* UMEM API                                                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Set up the two rings over an initialized buffer array.
+ *
+ * @param[out]    umem_sp     UMEM to initialize.
+ * @param[in,out] ctx_sp      Buffer array providing the frames.
+ * @param[out]    fill_as     Fill ring entries, @p fill_size entries (power of two).
+ * @param[in]     fill_size   Fill ring size.
+ * @param[out]    comp_as     Completion ring entries (power of two).
+ * @param[in]     comp_size   Completion ring size.
+ *
+ * @return false if the inputs are invalid.
+ */
+bool buffer_umem_init(buffer_umem_st *umem_sp,
+                      buffer_array_ctx_st *ctx_sp,
+                      buffer_umem_desc_st *fill_as,
+                      uint32_t fill_size,
+                      buffer_umem_desc_st *comp_as,
+                      uint32_t comp_size);
+
+/**
+ * @brief Offset of a frame in the memory block.
+ */
+uint64_t buffer_umem_addr(buffer_umem_st const *umem_csp, buffer_st const *buffer_csp);
+
+/**
+ * @brief Frame at an offset.
+ *
+ * @return Descriptor of the frame, or NULL if @p addr_u64 is not the start of one.
+ */
+buffer_st *buffer_umem_frame(buffer_umem_st const *umem_csp, uint64_t addr_u64);
+
+/**
+ * @brief Application: acquire up to @p count_u32 free buffers and put them
+ *        on the fill ring with a single submit.
+ *
+ * @return Frames submitted (fewer if the ring or the pool ran out).
+ */
+uint32_t buffer_umem_fill(buffer_umem_st *umem_sp, uint32_t count_u32);
+
+/**
+ * @brief Application: take up to @p max_frames filled frames from the
+ *        completion ring.
+ *
+ * @return Frames written to @p frame_as. Release them to the context (or
+ *         put them back with @ref buffer_umem_fill) when done.
+ */
+uint32_t buffer_umem_complete(buffer_umem_st *umem_sp, buffer_umem_frame_st *frame_as, uint32_t max_frames);
+
+/**
+ * @brief Engine: move one batch of frames from the fill ring, through the
+ *        engine, to the completion ring.
+ *
+ * @param[in,out] umem_sp    UMEM.
+ * @param[in]     engine_csp I/O engine.
+ *
+ * @return Frames completed, 0 if there was nothing to do, or the engine's
+ *         negative result.
+ */
+int buffer_umem_engine_poll(buffer_umem_st *umem_sp, buffer_umem_engine_st const *engine_csp);
+
+/**
+ * @brief Backend state of the readv() engine.
+ */
+typedef struct
+{
+    int fd;                          /**< Pipe, socket or file opened for reading. */
+} buffer_umem_fd_st;
+
+/**
+ * @brief Set up an engine that fills each batch with one readv() call on @p fd.
+ *
+ * Frames are filled in order; only frames that received data are
+ * completed. End of input and errors other than EAGAIN and EINTR return -1.
+ *
+ * @return false if readv() is not available on this platform.
+ */
+bool buffer_umem_fd_engine_init(buffer_umem_engine_st *engine_sp, buffer_umem_fd_st *fd_sp, int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_UMEM_H_ */
@@ -0,0 +1,408 @@
+/**
+ * @file buffer_zero.c
+ * @brief Zero-filled buffers with dirty tracking and background scrubbing.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "buffer_zero.h"
+#include "buffer_port.h"
+
+#include <string.h>
+
+#if (0 != BUFFER_CFG_ZERO_THREAD)
+#include <time.h>
+#endif
+
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define BUFFER_ZERO_HAS_STREAM   (1)
+#include <immintrin.h>
+#else
+#define BUFFER_ZERO_HAS_STREAM   (0)
+#endif
+
+/** Below this size non-temporal stores are not worth the fence. */
+#define BUFFER_ZERO_STREAM_MIN   (256u)
+
+/* -------------------------------------------------------------------------- */
+/* Static Functions                                                           */
+/* -------------------------------------------------------------------------- */
+
+static void buffer_zero_lock(buffer_zero_ctx_st const *zero_csp)
+{
+    if (NULL != zero_csp->lock_fn)
+    {
+        zero_csp->lock_fn(zero_csp->user_p);
+    }
+}
+
+static void buffer_zero_unlock(buffer_zero_ctx_st const *zero_csp)
+{
+    if (NULL != zero_csp->unlock_fn)
+    {
+        zero_csp->unlock_fn(zero_csp->user_p);
+    }
+}
+
+static bool buffer_zero_ctx_is_valid(buffer_zero_ctx_st const *zero_csp)
+{
+    return ((NULL != zero_csp) && (true == zero_csp->is_initialized));
+}
+
+#if (0 != BUFFER_ZERO_HAS_STREAM)
+
+__attribute__((target("avx2")))
+static void buffer_zero_stream_avx2(uint8_t *memory_u8p, size_t bytes)
+{
+    __m256i const zero_v = _mm256_setzero_si256();
+    size_t        offset;
+
+    for (offset = 0u; offset < bytes; offset += 64u)
+    {
+        _mm256_stream_si256((__m256i *)(void *)&memory_u8p[offset], zero_v);
+        _mm256_stream_si256((__m256i *)(void *)&memory_u8p[offset + 32u], zero_v);
+    }
+}
+
+static void buffer_zero_stream_sse2(uint8_t *memory_u8p, size_t bytes)
+{
+    __m128i const zero_v = _mm_setzero_si128();
+    size_t        offset;
+
+    for (offset = 0u; offset < bytes; offset += 64u)
+    {
+        _mm_stream_si128((__m128i *)(void *)&memory_u8p[offset], zero_v);
+        _mm_stream_si128((__m128i *)(void *)&memory_u8p[offset + 16u], zero_v);
+        _mm_stream_si128((__m128i *)(void *)&memory_u8p[offset + 32u], zero_v);
+        _mm_stream_si128((__m128i *)(void *)&memory_u8p[offset + 48u], zero_v);
+    }
+}
+
+/** 0 = unknown, 1 = SSE2, 2 = AVX2. */
+static int buffer_zero_stream_level;
+
+#endif /* BUFFER_ZERO_HAS_STREAM */
+
+/**
+ * @brief Clear memory with non-temporal stores where available.
+ *
+ * The unaligned head and the tail are cleared with memset; the 64-byte
+ * aligned body is streamed past the caches.
+ */
+static void buffer_zero_clear_stream(uint8_t *memory_u8p, size_t bytes)
+{
+#if (0 != BUFFER_ZERO_HAS_STREAM)
+    size_t head;
+    size_t body;
+    int    level;
+
+    if (bytes < BUFFER_ZERO_STREAM_MIN)
+    {
+        memset(memory_u8p, 0, bytes);
+        return;
+    }
+
+    head = (64u - ((uintptr_t)memory_u8p & 63u)) & 63u;
+    body = (bytes - head) & ~(size_t)63u;
+
+    memset(memory_u8p, 0, head);
+
+    level = BUFFER_PORT_LOAD_RELAXED(&buffer_zero_stream_level);
+    if (0 == level)
+    {
+        __builtin_cpu_init();
+        level = (0 != __builtin_cpu_supports("avx2")) ? 2 : 1;
+        BUFFER_PORT_STORE_RELAXED(&buffer_zero_stream_level, level);
+    }
+
+    if (2 == level)
+    {
+        buffer_zero_stream_avx2(&memory_u8p[head], body);
+    }
+    else
+    {
+        buffer_zero_stream_sse2(&memory_u8p[head], body);
+    }
+
+    /* Streaming stores are weakly ordered: complete them before publishing. */
+    _mm_sfence();
+
+    memset(&memory_u8p[head + body], 0, bytes - head - body);
+#else
+    memset(memory_u8p, 0, bytes);
+#endif
+}
+
+static void buffer_zero_push(uint32_t *head_u32p, buffer_zero_slot_st *slot_as, uint32_t index_u32)
+{
+    slot_as[index_u32].next_u32 = *head_u32p;
+    *head_u32p                  = index_u32;
+}
+
+static uint32_t buffer_zero_pop(uint32_t *head_u32p, buffer_zero_slot_st const *slot_as)
+{
+    uint32_t index_u32 = *head_u32p;
+
+    if (BUFFER_ZERO_NONE != index_u32)
+    {
+        *head_u32p = slot_as[index_u32].next_u32;
+    }
+
+    return index_u32;
+}
+
+#if (0 != BUFFER_CFG_ZERO_THREAD)
+
+static void *buffer_zero_main(void *arg_p)
+{
+    buffer_zero_ctx_st *zero_sp = (buffer_zero_ctx_st *)arg_p;
+    struct timespec     period_s;
+
+    period_s.tv_sec  = (time_t)(zero_sp->period_ms / 1000u);
+    period_s.tv_nsec = (long)(zero_sp->period_ms % 1000u) * 1000000L;
+
+    while (0 == BUFFER_PORT_LOAD_ACQUIRE(&zero_sp->stop_flag))
+    {
+        if (0u == buffer_zero_scrub(zero_sp, 16u))
+        {
+            (void)nanosleep(&period_s, NULL);
+        }
+    }
+
+    return NULL;
+}
+
+#endif /* BUFFER_CFG_ZERO_THREAD */
+
+/* -------------------------------------------------------------------------- */
+/* Zeroing context API                                                        */
+/* -------------------------------------------------------------------------- */
+
+bool buffer_zero_init(buffer_zero_ctx_st *zero_sp,
+                      buffer_array_ctx_st *ctx_sp,
+                      buffer_zero_slot_st *slot_as,
+                      bool is_zeroed,
+                      void (*lock_fn)(void *user_p),
+                      void (*unlock_fn)(void *user_p),
+                      void *user_p)
+{
+    size_t index;
+
+    if ((NULL == zero_sp) || (NULL == ctx_sp) || (false == ctx_sp->is_initialized) ||
+        (NULL == slot_as) || (ctx_sp->buffer_count >= BUFFER_ZERO_NONE))
+    {
+        return false;
+    }
+
+    memset(zero_sp, 0, sizeof(*zero_sp));
+    zero_sp->ctx_sp         = ctx_sp;
+    zero_sp->slot_as        = slot_as;
+    zero_sp->clean_head_u32 = BUFFER_ZERO_NONE;
+    zero_sp->dirty_head_u32 = BUFFER_ZERO_NONE;
+    zero_sp->lock_fn        = lock_fn;
+    zero_sp->unlock_fn      = unlock_fn;
+    zero_sp->user_p         = user_p;
+
+    /* Push in reverse so that the lowest buffers are handed out first. */
+    for (index = ctx_sp->buffer_count; index > 0u; --index)
+    {
+        slot_as[index - 1u].dirty_bytes = (true == is_zeroed) ? 0u : ctx_sp->buffer_size;
+        buffer_zero_push((true == is_zeroed) ? &zero_sp->clean_head_u32 : &zero_sp->dirty_head_u32,
+                         slot_as,
+                         (uint32_t)(index - 1u));
+    }
+
+    if (true == is_zeroed)
+    {
+        zero_sp->clean_count = ctx_sp->buffer_count;
+    }
+    else
+    {
+        zero_sp->dirty_count = ctx_sp->buffer_count;
+    }
+
+    zero_sp->is_initialized = true;
+    return true;
+}
+
+buffer_st *buffer_zero_acquire(buffer_zero_ctx_st *zero_sp)
+{
+    buffer_st *buffer_sp;
+    uint32_t   index_u32;
+    size_t     dirty_bytes = 0u;
+
+    if (false == buffer_zero_ctx_is_valid(zero_sp))
+    {
+        return NULL;
+    }
+
+    buffer_zero_lock(zero_sp);
+
+    index_u32 = buffer_zero_pop(&zero_sp->clean_head_u32, zero_sp->slot_as);
+    if (BUFFER_PORT_LIKELY(BUFFER_ZERO_NONE != index_u32))
+    {
+        zero_sp->clean_count--;
+        zero_sp->clean_acquires++;
+    }
+    else
+    {
+        index_u32 = buffer_zero_pop(&zero_sp->dirty_head_u32, zero_sp->slot_as);
+        if (BUFFER_ZERO_NONE == index_u32)
+        {
+            buffer_zero_unlock(zero_sp);
+            return NULL;
+        }
+        zero_sp->dirty_count--;
+        zero_sp->inline_clears++;
+        dirty_bytes = zero_sp->slot_as[index_u32].dirty_bytes;
+    }
+
+    buffer_sp = &zero_sp->ctx_sp->buffer_array_sa[index_u32];
+    buffer_mark_in_use(buffer_sp);
+
+    buffer_zero_unlock(zero_sp);
+
+    /* The buffer is ours now: clear it without holding the lock. */
+    if (0u < dirty_bytes)
+    {
+        memset(buffer_sp->data_u8p, 0, dirty_bytes);
+    }
+    zero_sp->slot_as[index_u32].dirty_bytes = 0u;
+
+    return buffer_sp;
+}
+
+bool buffer_zero_release_by_ptr(buffer_zero_ctx_st *zero_sp, uint8_t *memory_u8p, size_t written_bytes)
+{
+    buffer_array_ctx_st *ctx_sp;
+    buffer_st           *buffer_sp;
+    uintptr_t            offset;
+    uint32_t             index_u32;
+
+    if ((false == buffer_zero_ctx_is_valid(zero_sp)) || (NULL == memory_u8p))
+    {
+        return false;
+    }
+
+    ctx_sp = zero_sp->ctx_sp;
+    offset = (uintptr_t)memory_u8p - (uintptr_t)ctx_sp->memory_block_u8p;
+    if ((memory_u8p < ctx_sp->memory_block_u8p)                        ||
+        (offset >= (ctx_sp->buffer_count * ctx_sp->buffer_size))         ||
+        (0u != (offset % ctx_sp->buffer_size)))
+    {
+        return false;
+    }
+
+    index_u32 = (uint32_t)(offset / ctx_sp->buffer_size);
+    buffer_sp = &ctx_sp->buffer_array_sa[index_u32];
+
+    if (written_bytes > ctx_sp->buffer_size)
+    {
+        written_bytes = ctx_sp->buffer_size;
+    }
+
+    buffer_zero_lock(zero_sp);
+
+    if (true == buffer_sp->is_available)
+    {
+        buffer_zero_unlock(zero_sp);
+        return false;
+    }
+
+    buffer_mark_free(buffer_sp);
+    zero_sp->slot_as[index_u32].dirty_bytes = written_bytes;
+
+    if (0u == written_bytes)
+    {
+        buffer_zero_push(&zero_sp->clean_head_u32, zero_sp->slot_as, index_u32);
+        zero_sp->clean_count++;
+    }
+    else
+    {
+        buffer_zero_push(&zero_sp->dirty_head_u32, zero_sp->slot_as, index_u32);
+        zero_sp->dirty_count++;
+    }
+
+    buffer_zero_unlock(zero_sp);
+    return true;
+}
+
+size_t buffer_zero_scrub(buffer_zero_ctx_st *zero_sp, size_t max_buffers)
+{
+    size_t   scrubbed = 0u;
+    size_t   dirty_bytes;
+    uint32_t index_u32;
+
+    if (false == buffer_zero_ctx_is_valid(zero_sp))
+    {
+        return 0u;
+    }
+
+    while (scrubbed < max_buffers)
+    {
+        /* Take the buffer off the dirty list so acquire cannot see it while it is cleared. */
+        buffer_zero_lock(zero_sp);
+        index_u32 = buffer_zero_pop(&zero_sp->dirty_head_u32, zero_sp->slot_as);
+        if (BUFFER_ZERO_NONE != index_u32)
+        {
+            zero_sp->dirty_count--;
+        }
+        buffer_zero_unlock(zero_sp);
+
+        if (BUFFER_ZERO_NONE == index_u32)
+        {
+            break;
+        }
+
+        dirty_bytes = zero_sp->slot_as[index_u32].dirty_bytes;
+        buffer_zero_clear_stream(zero_sp->ctx_sp->buffer_array_sa[index_u32].data_u8p, dirty_bytes);
+
+        buffer_zero_lock(zero_sp);
+        zero_sp->slot_as[index_u32].dirty_bytes = 0u;
+        buffer_zero_push(&zero_sp->clean_head_u32, zero_sp->slot_as, index_u32);
+        zero_sp->clean_count++;
+        zero_sp->scrubbed++;
+        zero_sp->scrubbed_bytes += dirty_bytes;
+        buffer_zero_unlock(zero_sp);
+
+        scrubbed++;
+    }
+
+    return scrubbed;
+}
+
+#if (0 != BUFFER_CFG_ZERO_THREAD)
+
+bool buffer_zero_start(buffer_zero_ctx_st *zero_sp, uint32_t period_ms)
+{
+    if ((false == buffer_zero_ctx_is_valid(zero_sp)) ||
+        (NULL == zero_sp->lock_fn) || (NULL == zero_sp->unlock_fn) ||
+        (0u == period_ms) || (true == zero_sp->is_running))
+    {
+        return false;
+    }
+
+    zero_sp->period_ms = period_ms;
+    BUFFER_PORT_STORE_RELEASE(&zero_sp->stop_flag, 0);
+    if (0 != pthread_create(&zero_sp->thread, NULL, buffer_zero_main, zero_sp))
+    {
+        return false;
+    }
+
+    zero_sp->is_running = true;
+    return true;
+}
+
+void buffer_zero_stop(buffer_zero_ctx_st *zero_sp)
+{
+    if ((NULL == zero_sp) || (false == zero_sp->is_running))
+    {
+        return;
+    }
+
+    BUFFER_PORT_STORE_RELEASE(&zero_sp->stop_flag, 1);
+    (void)pthread_join(zero_sp->thread, NULL);
+    zero_sp->is_running = false;
+}
+
+#endif /* BUFFER_CFG_ZERO_THREAD */
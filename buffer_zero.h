@@ -0,0 +1,166 @@
+/**
+ * @file buffer_zero.h
+ * @brief Zero-filled buffers with dirty tracking and background scrubbing.
+ *
+ * A zeroing context manages the buffers of a @ref buffer_array_ctx_st in
+ * two free lists: clean buffers, known to be all zero, and dirty ones,
+ * together with how many leading bytes may have been written. The caller
+ * passes that length on release (0 if the buffer was not written, its
+ * capacity if unknown), so only written bytes are ever cleared.
+ *
+ * @ref buffer_zero_acquire serves clean buffers first. When none is left it
+ * takes a dirty one and clears it inline with memset (the C library picks
+ * its widest stores, AVX2 or wider on current x86). @ref buffer_zero_scrub
+ * moves dirty buffers to the clean list, clearing them with non-temporal
+ * stores so that scrubbing does not evict the caller's working set; the
+ * store width is chosen at run time (AVX2, else SSE2, else memset). With
+ * @c BUFFER_CFG_ZERO_THREAD, @ref buffer_zero_start runs it on a
+ * background thread.
+ *
+ * The context takes over acquire and release for its buffer array: do not
+ * also use the pool API on it. Buffers keep their descriptor state, so
+ * @ref buffer_data works as usual. All operations run under the optional
+ * lock callbacks; with a scrubber thread the lock is required. Clearing
+ * always happens outside the lock.
+ */
+
+#ifndef BUFFER_ZERO_H_
+#define BUFFER_ZERO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "buffer.h"
+
+/** Build the background scrubber thread (POSIX threads). */
+#ifndef BUFFER_CFG_ZERO_THREAD
+#if defined(__unix__) || defined(__APPLE__)
+#define BUFFER_CFG_ZERO_THREAD   (1)
+#else
+#define BUFFER_CFG_ZERO_THREAD   (0)
+#endif
+#endif
+
+#if (0 != BUFFER_CFG_ZERO_THREAD)
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUFFER_ZERO_NONE         (0xFFFFFFFFu)   /**< End of a free list. */
+
+/**
+ * @brief Per-buffer bookkeeping, one per buffer of the array.
+ */
+typedef struct
+{
+    size_t   dirty_bytes;            /**< Leading bytes that may be non-zero. */
+    uint32_t next_u32;               /**< Next buffer of the same free list. */
+} buffer_zero_slot_st;
+
+/**
+ * @brief Zeroing context.
+ */
+typedef struct
+{
+    buffer_array_ctx_st *ctx_sp;
+    buffer_zero_slot_st *slot_as;            /**< One per buffer, caller-provided. */
+    uint32_t             clean_head_u32;     /**< Free and all zero. */
+    uint32_t             dirty_head_u32;     /**< Free, needs clearing. */
+    size_t               clean_count;
+    size_t               dirty_count;
+
+    uint64_t             clean_acquires;     /**< Acquires served by a clean buffer. */
+    uint64_t             inline_clears;      /**< Acquires that had to clear a dirty buffer. */
+    uint64_t             scrubbed;           /**< Buffers cleared by @ref buffer_zero_scrub. */
+    uint64_t             scrubbed_bytes;     /**< Bytes cleared by @ref buffer_zero_scrub. */
+
+    void               (*lock_fn)(void *user_p);     /**< Optional, may be NULL. */
+    void               (*unlock_fn)(void *user_p);   /**< Optional, may be NULL. */
+    void                *user_p;
+
+#if (0 != BUFFER_CFG_ZERO_THREAD)
+    uint32_t             period_ms;          /**< Scrubber sleep when nothing is dirty. */
+    pthread_t            thread;
+    int                  stop_flag;
+    bool                 is_running;
+#endif
+    bool                 is_initialized;
+} buffer_zero_ctx_st;
+
+/**
+ * @brief Initialize a zeroing context over an initialized buffer array.
+ *
+ * @param[out] zero_sp     Context to initialize.
+ * @param[in]  ctx_sp      Buffer array; all buffers must be free.
+ * @param[in]  slot_as     Array of @c ctx_sp->buffer_count slots.
+ * @param[in]  is_zeroed   The array's memory is already all zero (e.g. calloc, mmap).
+ * @param[in]  lock_fn     Lock, or NULL.
+ * @param[in]  unlock_fn   Matching unlock, or NULL.
+ * @param[in]  user_p      Passed to the lock callbacks.
+ *
+ * @return false if the inputs are invalid.
+ */
+bool buffer_zero_init(buffer_zero_ctx_st *zero_sp,
+                      buffer_array_ctx_st *ctx_sp,
+                      buffer_zero_slot_st *slot_as,
+                      bool is_zeroed,
+                      void (*lock_fn)(void *user_p),
+                      void (*unlock_fn)(void *user_p),
+                      void *user_p);
+
+/**
+ * @brief Acquire a buffer whose whole capacity reads as zero.
+ *
+ * @return Buffer, or NULL if none is free.
+ */
+buffer_st *buffer_zero_acquire(buffer_zero_ctx_st *zero_sp);
+
+/**
+ * @brief Release a buffer by its data pointer.
+ *
+ * @param[in,out] zero_sp       Context.
+ * @param[in]     memory_u8p    Start of the buffer's data.
+ * @param[in]     written_bytes Leading bytes that may have been written:
+ *                              0 keeps the buffer clean, values above the
+ *                              capacity are clamped.
+ *
+ * @return true if the pointer is the start of an acquired buffer.
+ */
+bool buffer_zero_release_by_ptr(buffer_zero_ctx_st *zero_sp, uint8_t *memory_u8p, size_t written_bytes);
+
+/**
+ * @brief Clear up to @p max_buffers dirty buffers with non-temporal stores.
+ *
+ * @return Number of buffers moved to the clean list.
+ */
+size_t buffer_zero_scrub(buffer_zero_ctx_st *zero_sp, size_t max_buffers);
+
+#if (0 != BUFFER_CFG_ZERO_THREAD)
+
+/**
+ * @brief Start a thread that scrubs dirty buffers as they are released.
+ *
+ * @param[in,out] zero_sp    Context with lock callbacks.
+ * @param[in]     period_ms  Sleep between checks when nothing is dirty.
+ *
+ * @return false if the context has no lock, is running, or the thread
+ *         could not be created.
+ */
+bool buffer_zero_start(buffer_zero_ctx_st *zero_sp, uint32_t period_ms);
+
+/**
+ * @brief Stop the scrubber thread and wait for it.
+ */
+void buffer_zero_stop(buffer_zero_ctx_st *zero_sp);
+
+#endif /* BUFFER_CFG_ZERO_THREAD */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUFFER_ZERO_H_ */
@@ -0,0 +1,207 @@
+/**
+ * @file flight_decode.c
+ * @brief Print a flight recorder dump (see buffer_flight.h) as one timeline.
+ *
+ * The records of all thread rings are merged by timestamp and printed
+ * oldest first, with the time of each event before the dump was taken.
+ * Times are in timestamp ticks (64-tick resolution). Each event names its
+ * pool by id; the ids are listed with the pool addresses first.
+ *
+ * Build:
+ *   cc -O2 -I. -Ibench tools/flight_decode.c bench/bench_util.c -o flight_decode
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "buffer_flight.h"
+#include "bench_util.h"
+
+/**
+ * @brief One decoded event.
+ */
+typedef struct
+{
+    uint64_t age_ticks;              /**< Ticks before the dump. */
+    uint32_t thread;
+    uint32_t op;
+    uint32_t pool;
+    uint32_t index;
+    size_t   seq;                    /**< Position in the dump, for a stable order. */
+} flight_event_st;
+
+static char const *flight_op_name(uint32_t op)
+{
+    switch (op)
+    {
+        case BUFFER_TRACE_OP_ACQUIRE:         return "acquire";
+        case BUFFER_TRACE_OP_ACQUIRE_FAIL:    return "acquire_fail";
+        case BUFFER_TRACE_OP_RELEASE:         return "release";
+        case BUFFER_TRACE_OP_RELEASE_INVALID: return "release_invalid";
+        case BUFFER_TRACE_OP_MARK_ALL_FREE:   return "mark_all_free";
+        default:                              return "?";
+    }
+}
+
+static int flight_event_compare(void const *left_p, void const *right_p)
+{
+    flight_event_st const *left_csp  = (flight_event_st const *)left_p;
+    flight_event_st const *right_csp = (flight_event_st const *)right_p;
+
+    /* Oldest (largest age) first. */
+    if (left_csp->age_ticks != right_csp->age_ticks)
+    {
+        return (left_csp->age_ticks > right_csp->age_ticks) ? -1 : 1;
+    }
+
+    /* Keep dump order (ring by ring, oldest first) for equal timestamps. */
+    if (left_csp->seq != right_csp->seq)
+    {
+        return (left_csp->seq < right_csp->seq) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    buffer_flight_header_st header_s;
+    uint64_t                pool_au64[BUFFER_FLIGHT_POOLS];
+    buffer_flight_ring_st  *ring_sp;
+    flight_event_st        *events_as;
+    char const             *path_cp = NULL;
+    size_t                  last    = 0u;
+    size_t                  count   = 0u;
+    size_t                  first;
+    size_t                  index;
+    uint32_t                ring;
+    uint32_t                threads = 0u;
+    FILE                   *file_fp;
+    int                     arg;
+
+    for (arg = 1; arg < argc; ++arg)
+    {
+        char const *value_cp;
+
+        if (true == bench_match_option(argv[arg], "--last", &value_cp))
+        {
+            last = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (('-' != argv[arg][0]) && (NULL == path_cp))
+        {
+            path_cp = argv[arg];
+        }
+        else
+        {
+            path_cp = NULL;
+            break;
+        }
+    }
+
+    if (NULL == path_cp)
+    {
+        fprintf(stderr, "usage: %s DUMP [--last=N]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    file_fp = fopen(path_cp, "rb");
+    if (NULL == file_fp)
+    {
+        perror(path_cp);
+        return EXIT_FAILURE;
+    }
+
+    if ((1u != fread(&header_s, sizeof(header_s), 1u, file_fp))                          ||
+        (0 != memcmp(header_s.magic_ac, BUFFER_FLIGHT_MAGIC, sizeof(header_s.magic_ac))) ||
+        (BUFFER_FLIGHT_VERSION != header_s.version)                                      ||
+        (BUFFER_CFG_FLIGHT_RECORDS != header_s.ring_records)                             ||
+        (BUFFER_FLIGHT_POOLS != header_s.pool_count)                                     ||
+        (1u != fread(pool_au64, sizeof(pool_au64), 1u, file_fp)))
+    {
+        fprintf(stderr, "%s: not a flight recorder dump of this build\n", path_cp);
+        return EXIT_FAILURE;
+    }
+
+    ring_sp   = bench_calloc(1u, sizeof(*ring_sp));
+    events_as = bench_calloc((size_t)header_s.ring_count * BUFFER_CFG_FLIGHT_RECORDS + 1u, sizeof(*events_as));
+
+    for (ring = 0u; ring < header_s.ring_count; ++ring)
+    {
+        uint32_t valid;
+        uint32_t pos;
+
+        if (1u != fread(ring_sp, sizeof(*ring_sp), 1u, file_fp))
+        {
+            fprintf(stderr, "%s: truncated dump\n", path_cp);
+            return EXIT_FAILURE;
+        }
+
+        if (0u == ring_sp->thread_u32)
+        {
+            continue;   /* Never claimed. */
+        }
+        ++threads;
+
+        valid = (ring_sp->head_u32 < BUFFER_CFG_FLIGHT_RECORDS) ? ring_sp->head_u32 : BUFFER_CFG_FLIGHT_RECORDS;
+
+        for (pos = ring_sp->head_u32 - valid; pos != ring_sp->head_u32; ++pos)
+        {
+            uint64_t record = ring_sp->records_au64[pos & (BUFFER_CFG_FLIGHT_RECORDS - 1u)];
+
+            events_as[count].age_ticks = BUFFER_FLIGHT_AGE(header_s.now_ticks_u64, record);
+            events_as[count].thread    = ring_sp->thread_u32;
+            events_as[count].op        = BUFFER_FLIGHT_OP(record);
+            events_as[count].pool      = BUFFER_FLIGHT_POOL(record);
+            events_as[count].index     = BUFFER_FLIGHT_INDEX(record);
+            events_as[count].seq       = count;
+            ++count;
+        }
+    }
+
+    fclose(file_fp);
+
+    for (ring = 0u; ring < BUFFER_FLIGHT_POOLS; ++ring)
+    {
+        if (0u != pool_au64[ring])
+        {
+            printf("pool %2u: %#llx\n", ring + 1u, (unsigned long long)pool_au64[ring]);
+        }
+    }
+    if (0u != header_s.dropped_u64)
+    {
+        printf("%llu events dropped by threads without a ring\n", (unsigned long long)header_s.dropped_u64);
+    }
+
+    if (0u == count)
+    {
+        printf("no events\n");
+        return EXIT_SUCCESS;
+    }
+
+    qsort(events_as, count, sizeof(*events_as), flight_event_compare);
+
+    first = ((0u < last) && (last < count)) ? (count - last) : 0u;
+
+    printf("%zu events from %u threads\n", count, threads);
+    printf("%17s %6s %4s %-16s %8s\n", "ticks before dump", "thread", "pool", "op", "index");
+
+    for (index = first; index < count; ++index)
+    {
+        printf("%17llu %6u %4u %-16s ",
+               (unsigned long long)events_as[index].age_ticks,
+               events_as[index].thread, events_as[index].pool, flight_op_name(events_as[index].op));
+
+        if (BUFFER_FLIGHT_INDEX_NONE == events_as[index].index)
+        {
+            printf("%8s\n", "-");
+        }
+        else
+        {
+            printf("%8u\n", events_as[index].index);
+        }
+    }
+
+    free(ring_sp);
+    free(events_as);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,642 @@
+/**
+ * @file pool_sizer.c
+ * @brief Offline pool sizing simulator.
+ *
+ * Reads a recorded trace (see buffer_trace.h) and, optionally, the size
+ * each acquire actually needed, then recommends a pool configuration:
+ *  - the minimum buffer_count that keeps the acquire failure rate at or
+ *    below a target, found by re-simulating the recorded demand against
+ *    pools of decreasing capacity (a failed acquire holds nothing);
+ *  - the internal fragmentation of each candidate buffer_size;
+ *  - the cheapest split into two size classes (small buffers for requests
+ *    up to a threshold, large buffers for the rest), each sized for the
+ *    same failure target.
+ * Memory cost counts the buffers and their buffer_st descriptors.
+ *
+ * The sizes file holds one decimal byte count per acquire record in the
+ * trace (including failed acquires), in timestamp order, separated by
+ * whitespace. Without it every request is assumed to need the recorded
+ * buffer size. Acquires that failed in the recording are simulated with a
+ * zero hold time, since their hold time is unknown.
+ *
+ * Build:
+ *   cc -O2 -I. -Ibench tools/pool_sizer.c bench/bench_util.c -o pool_sizer
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "buffer_trace.h"
+#include "bench_util.h"
+
+#define SIZER_MAX_CANDIDATES     (64u)
+
+/**
+ * @brief Simulator configuration (from the command line).
+ */
+typedef struct
+{
+    bench_format_et format_e;
+    char const     *trace_path_cp;
+    char const     *sizes_path_cp;
+    double          target_fail;     /**< Maximum acceptable fraction of failed acquires. */
+    size_t          align;           /**< Candidate sizes are multiples of this. */
+    size_t          buffer_size;     /**< Request size when no sizes file is given. */
+} sizer_cfg_st;
+
+/**
+ * @brief Demand stream event: acquire or release of one demand.
+ */
+typedef struct
+{
+    uint32_t demand;
+    uint8_t  is_release;
+} sizer_event_st;
+
+/**
+ * @brief Demand stream rebuilt from the trace.
+ */
+typedef struct
+{
+    sizer_event_st *events_as;
+    size_t          event_count;
+    uint32_t       *size_au32;       /**< Requested bytes per demand. */
+    size_t          demand_count;
+    uint32_t        max_size;
+} sizer_stream_st;
+
+/**
+ * @brief Result for one size class.
+ */
+typedef struct
+{
+    size_t   buffer_size;
+    size_t   demands;                /**< Requests served by this class. */
+    size_t   buffer_count;           /**< Minimum count for the failure target. */
+    size_t   peak;                   /**< Count with zero failures. */
+    double   fail_rate;              /**< Failure rate at @ref buffer_count. */
+    double   frag;                   /**< Internal fragmentation (wasted / allocated bytes). */
+    uint64_t memory_bytes;
+} sizer_class_st;
+
+/* -------------------------------------------------------------------------- */
+/* Input                                                                      */
+/* -------------------------------------------------------------------------- */
+
+static bool sizer_build_stream(sizer_cfg_st const *cfg_csp, bench_trace_st const *trace_csp, sizer_stream_st *stream_sp)
+{
+    uint32_t *open_au32 = bench_calloc((size_t)trace_csp->max_index + 1u, sizeof(uint32_t));
+    FILE     *sizes_fp  = NULL;
+    size_t    default_size = (0u != cfg_csp->buffer_size) ? cfg_csp->buffer_size :
+                             (size_t)trace_csp->header_s.buffer_size;
+    size_t    index;
+
+    if (0u == default_size)
+    {
+        default_size = 64u;
+    }
+
+    if (NULL != cfg_csp->sizes_path_cp)
+    {
+        sizes_fp = fopen(cfg_csp->sizes_path_cp, "r");
+        if (NULL == sizes_fp)
+        {
+            perror(cfg_csp->sizes_path_cp);
+            free(open_au32);
+            return false;
+        }
+    }
+
+    /* Each demand yields one acquire and at most one release event. */
+    memset(stream_sp, 0, sizeof(*stream_sp));
+    stream_sp->size_au32 = bench_calloc(trace_csp->record_count + 1u, sizeof(uint32_t));
+    stream_sp->events_as = bench_calloc((2u * trace_csp->record_count) + 1u, sizeof(sizer_event_st));
+
+    /* open_au32[index] holds demand + 1 of the buffer's open demand, 0 if none. */
+    for (index = 0u; index < trace_csp->record_count; ++index)
+    {
+        buffer_trace_record_st const *rec_csp = &trace_csp->records_as[index];
+        uint32_t                      demand;
+        uint32_t                      slot;
+        unsigned long                 size;
+
+        /* A corrupt or hand-made trace may name no buffer, or one past the
+         * indices counted at load: such a record cannot be tracked. */
+        if (((BUFFER_TRACE_OP_ACQUIRE == rec_csp->op) || (BUFFER_TRACE_OP_RELEASE == rec_csp->op)) &&
+            (rec_csp->index >= trace_csp->max_index))
+        {
+            continue;
+        }
+
+        switch (rec_csp->op)
+        {
+            case BUFFER_TRACE_OP_ACQUIRE:
+            case BUFFER_TRACE_OP_ACQUIRE_FAIL:
+                demand = (uint32_t)stream_sp->demand_count++;
+                size   = (unsigned long)default_size;
+
+                if ((NULL != sizes_fp) && (1 != fscanf(sizes_fp, "%lu", &size)))
+                {
+                    fprintf(stderr, "%s: fewer sizes than acquires in the trace (%zu)\n",
+                            cfg_csp->sizes_path_cp, stream_sp->demand_count);
+                    fclose(sizes_fp);
+                    free(open_au32);
+                    return false;
+                }
+
+                stream_sp->size_au32[demand] = (uint32_t)size;
+                if ((uint32_t)size > stream_sp->max_size)
+                {
+                    stream_sp->max_size = (uint32_t)size;
+                }
+
+                stream_sp->events_as[stream_sp->event_count].demand       = demand;
+                stream_sp->events_as[stream_sp->event_count++].is_release = 0u;
+
+                if (BUFFER_TRACE_OP_ACQUIRE_FAIL == rec_csp->op)
+                {
+                    stream_sp->events_as[stream_sp->event_count].demand       = demand;
+                    stream_sp->events_as[stream_sp->event_count++].is_release = 1u;
+                }
+                else
+                {
+                    open_au32[rec_csp->index] = demand + 1u;
+                }
+                break;
+
+            case BUFFER_TRACE_OP_RELEASE:
+                if (0u != open_au32[rec_csp->index])
+                {
+                    stream_sp->events_as[stream_sp->event_count].demand       = open_au32[rec_csp->index] - 1u;
+                    stream_sp->events_as[stream_sp->event_count++].is_release = 1u;
+                    open_au32[rec_csp->index] = 0u;
+                }
+                break;
+
+            case BUFFER_TRACE_OP_MARK_ALL_FREE:
+                for (slot = 0u; slot < trace_csp->max_index; ++slot)
+                {
+                    if (0u != open_au32[slot])
+                    {
+                        stream_sp->events_as[stream_sp->event_count].demand       = open_au32[slot] - 1u;
+                        stream_sp->events_as[stream_sp->event_count++].is_release = 1u;
+                        open_au32[slot] = 0u;
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    if (NULL != sizes_fp)
+    {
+        fclose(sizes_fp);
+    }
+    free(open_au32);
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Simulation                                                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Count failed acquires for demands in (@p min_size, @p max_size]
+ *        against a pool of @p capacity buffers.
+ *
+ * @param[out] demands_p  Number of demands in the size range.
+ * @param[out] peak_p     Peak concurrent demand (unbounded pool), may be NULL.
+ */
+static size_t sizer_simulate(sizer_stream_st const *stream_csp,
+                             uint8_t *served_au8,
+                             uint32_t min_size,
+                             uint32_t max_size,
+                             size_t capacity,
+                             size_t *demands_p,
+                             size_t *peak_p)
+{
+    size_t in_use   = 0u;
+    size_t peak     = 0u;
+    size_t fails    = 0u;
+    size_t demands  = 0u;
+    size_t index;
+
+    for (index = 0u; index < stream_csp->event_count; ++index)
+    {
+        sizer_event_st const *event_csp = &stream_csp->events_as[index];
+        uint32_t              size      = stream_csp->size_au32[event_csp->demand];
+
+        if ((size <= min_size) || (size > max_size))
+        {
+            continue;
+        }
+
+        if (0u != event_csp->is_release)
+        {
+            if (0u != served_au8[event_csp->demand])
+            {
+                in_use--;
+            }
+            continue;
+        }
+
+        demands++;
+        if (in_use < capacity)
+        {
+            served_au8[event_csp->demand] = 1u;
+            if (++in_use > peak)
+            {
+                peak = in_use;
+            }
+        }
+        else
+        {
+            served_au8[event_csp->demand] = 0u;
+            fails++;
+        }
+    }
+
+    *demands_p = demands;
+    if (NULL != peak_p)
+    {
+        *peak_p = peak;
+    }
+
+    return fails;
+}
+
+/**
+ * @brief Size one class: demands in (@p min_size, @p max_size] served by
+ *        buffers of @p buffer_size bytes.
+ */
+static void sizer_size_class(sizer_cfg_st const *cfg_csp,
+                             sizer_stream_st const *stream_csp,
+                             uint8_t *served_au8,
+                             uint32_t min_size,
+                             uint32_t max_size,
+                             size_t buffer_size,
+                             sizer_class_st *class_sp)
+{
+    size_t   demands;
+    size_t   fails;
+    size_t   lo;
+    size_t   hi;
+    uint64_t requested = 0u;
+    size_t   index;
+
+    memset(class_sp, 0, sizeof(*class_sp));
+    class_sp->buffer_size = buffer_size;
+
+    (void)sizer_simulate(stream_csp, served_au8, min_size, max_size, (size_t)-1, &demands, &class_sp->peak);
+    class_sp->demands = demands;
+
+    if (0u == demands)
+    {
+        return;
+    }
+
+    /* Smallest capacity in [0, peak] whose failure rate meets the target. */
+    lo = 0u;
+    hi = class_sp->peak;
+    while (lo < hi)
+    {
+        size_t mid = lo + ((hi - lo) / 2u);
+
+        fails = sizer_simulate(stream_csp, served_au8, min_size, max_size, mid, &demands, NULL);
+        if (((double)fails / (double)demands) <= cfg_csp->target_fail)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1u;
+        }
+    }
+
+    fails = sizer_simulate(stream_csp, served_au8, min_size, max_size, lo, &demands, NULL);
+    class_sp->buffer_count = lo;
+    class_sp->fail_rate    = (double)fails / (double)demands;
+    class_sp->memory_bytes = (uint64_t)lo * ((uint64_t)buffer_size + sizeof(buffer_st));
+
+    for (index = 0u; index < stream_csp->demand_count; ++index)
+    {
+        uint32_t size = stream_csp->size_au32[index];
+
+        if ((size > min_size) && (size <= max_size))
+        {
+            requested += size;
+        }
+    }
+
+    class_sp->frag = 1.0 - ((double)requested / ((double)demands * (double)buffer_size));
+}
+
+/* -------------------------------------------------------------------------- */
+/* Candidates                                                                 */
+/* -------------------------------------------------------------------------- */
+
+static int sizer_cmp_u32(void const *a_p, void const *b_p)
+{
+    uint32_t a = *(uint32_t const *)a_p;
+    uint32_t b = *(uint32_t const *)b_p;
+
+    return (a > b) - (a < b);
+}
+
+static size_t sizer_round_up(size_t value, size_t align)
+{
+    return ((value + align - 1u) / align) * align;
+}
+
+/**
+ * @brief Candidate buffer sizes: powers of two and request-size percentiles,
+ *        rounded up to the alignment, sorted and unique.
+ */
+static size_t sizer_candidates(sizer_cfg_st const *cfg_csp, sizer_stream_st const *stream_csp, size_t *cand_az)
+{
+    static double const pcts_ad[] = { 50.0, 75.0, 90.0, 95.0, 99.0, 99.9 };
+    uint32_t *sorted_au32 = bench_calloc(stream_csp->demand_count + 1u, sizeof(uint32_t));
+    size_t    top         = sizer_round_up((0u != stream_csp->max_size) ? stream_csp->max_size : 1u, cfg_csp->align);
+    size_t    count       = 0u;
+    size_t    unique      = 0u;
+    size_t    size;
+    size_t    index;
+
+    memcpy(sorted_au32, stream_csp->size_au32, stream_csp->demand_count * sizeof(uint32_t));
+    qsort(sorted_au32, stream_csp->demand_count, sizeof(uint32_t), sizer_cmp_u32);
+
+    for (size = cfg_csp->align; (size < top) && (count < (SIZER_MAX_CANDIDATES - 8u)); size *= 2u)
+    {
+        cand_az[count++] = size;
+    }
+
+    for (index = 0u; (0u < stream_csp->demand_count) && (index < (sizeof(pcts_ad) / sizeof(pcts_ad[0]))); ++index)
+    {
+        size_t rank = (size_t)(((double)stream_csp->demand_count * pcts_ad[index]) / 100.0);
+
+        if (rank >= stream_csp->demand_count)
+        {
+            rank = stream_csp->demand_count - 1u;
+        }
+        cand_az[count++] = sizer_round_up((0u != sorted_au32[rank]) ? sorted_au32[rank] : 1u, cfg_csp->align);
+    }
+
+    cand_az[count++] = top;
+    free(sorted_au32);
+
+    /* Sort and drop duplicates. */
+    for (index = 1u; index < count; ++index)
+    {
+        size_t value = cand_az[index];
+        size_t pos   = index;
+
+        while ((pos > 0u) && (cand_az[pos - 1u] > value))
+        {
+            cand_az[pos] = cand_az[pos - 1u];
+            pos--;
+        }
+        cand_az[pos] = value;
+    }
+
+    for (index = 0u; index < count; ++index)
+    {
+        if ((0u == unique) || (cand_az[unique - 1u] != cand_az[index]))
+        {
+            cand_az[unique++] = cand_az[index];
+        }
+    }
+
+    return unique;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Main                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static void sizer_usage(char const *prog_cp)
+{
+    fprintf(stderr,
+            "usage: %s TRACE [--sizes=FILE] [--target-fail=P] [--align=N] [--buffer-size=N]\n"
+            "          [--format=console|json]\n",
+            prog_cp);
+}
+
+static bool sizer_parse_args(int argc, char **argv, sizer_cfg_st *cfg_sp)
+{
+    int index;
+
+    memset(cfg_sp, 0, sizeof(*cfg_sp));
+    cfg_sp->format_e    = BENCH_FORMAT_CONSOLE;
+    cfg_sp->target_fail = 1e-4;
+    cfg_sp->align       = 64u;
+
+    for (index = 1; index < argc; ++index)
+    {
+        char const *value_cp;
+
+        if (true == bench_match_option(argv[index], "--format", &value_cp))
+        {
+            if ((false == bench_parse_format(value_cp, &cfg_sp->format_e)) ||
+                (BENCH_FORMAT_CSV == cfg_sp->format_e))
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--sizes", &value_cp))
+        {
+            cfg_sp->sizes_path_cp = value_cp;
+        }
+        else if (true == bench_match_option(argv[index], "--target-fail", &value_cp))
+        {
+            cfg_sp->target_fail = strtod(value_cp, NULL);
+        }
+        else if (true == bench_match_option(argv[index], "--align", &value_cp))
+        {
+            cfg_sp->align = (size_t)strtoull(value_cp, NULL, 10);
+            if (0u == cfg_sp->align)
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--buffer-size", &value_cp))
+        {
+            cfg_sp->buffer_size = (size_t)strtoull(value_cp, NULL, 10);
+        }
+        else if (('-' != argv[index][0]) && (NULL == cfg_sp->trace_path_cp))
+        {
+            cfg_sp->trace_path_cp = argv[index];
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return (NULL != cfg_sp->trace_path_cp);
+}
+
+int main(int argc, char **argv)
+{
+    sizer_cfg_st     cfg_s;
+    bench_trace_st   trace_s;
+    sizer_stream_st  stream_s;
+    sizer_class_st   single_s;
+    sizer_class_st   best_small_s;
+    sizer_class_st   best_large_s;
+    sizer_class_st   class_s;
+    size_t           cand_az[SIZER_MAX_CANDIDATES];
+    size_t           cand_count;
+    size_t           top;
+    uint8_t         *served_au8;
+    bool             have_split = false;
+    size_t           index;
+
+    if (false == sizer_parse_args(argc, argv, &cfg_s))
+    {
+        sizer_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (false == bench_trace_load(cfg_s.trace_path_cp, &trace_s))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if ((false == sizer_build_stream(&cfg_s, &trace_s, &stream_s)) || (0u == stream_s.demand_count))
+    {
+        fprintf(stderr, "%s: no acquires to size for\n", cfg_s.trace_path_cp);
+        return EXIT_FAILURE;
+    }
+
+    served_au8 = bench_calloc(stream_s.demand_count, 1u);
+    cand_count = sizer_candidates(&cfg_s, &stream_s, cand_az);
+    top        = cand_az[cand_count - 1u];
+
+    /* Single class: every request fits the largest candidate. */
+    sizer_size_class(&cfg_s, &stream_s, served_au8, 0u, UINT32_MAX, top, &single_s);
+
+    if (BENCH_FORMAT_CONSOLE == cfg_s.format_e)
+    {
+        printf("trace:   %zu acquires, requests up to %u bytes, target failure rate %g\n\n",
+               stream_s.demand_count, stream_s.max_size, cfg_s.target_fail);
+        printf("%12s %10s %12s\n", "buffer_size", "frag %", "too large");
+    }
+
+    for (index = 0u; index < cand_count; ++index)
+    {
+        size_t   size      = cand_az[index];
+        uint64_t requested = 0u;
+        size_t   fits      = 0u;
+        size_t   demand;
+
+        for (demand = 0u; demand < stream_s.demand_count; ++demand)
+        {
+            if (stream_s.size_au32[demand] <= size)
+            {
+                requested += stream_s.size_au32[demand];
+                fits++;
+            }
+        }
+
+        if (BENCH_FORMAT_CONSOLE == cfg_s.format_e)
+        {
+            printf("%12zu %10.2f %12zu\n", size,
+                   (0u < fits) ? (100.0 * (1.0 - ((double)requested / ((double)fits * (double)size)))) : 0.0,
+                   stream_s.demand_count - fits);
+        }
+    }
+
+    /* Two classes: (0, t] in buffers of t bytes, (t, max] in buffers of top bytes. */
+    memset(&best_small_s, 0, sizeof(best_small_s));
+    memset(&best_large_s, 0, sizeof(best_large_s));
+
+    if (BENCH_FORMAT_CONSOLE == cfg_s.format_e)
+    {
+        printf("\n%12s %12s %12s %12s %14s\n", "split at", "small count", "large count", "fail %", "memory bytes");
+    }
+
+    for (index = 0u; (index + 1u) < cand_count; ++index)
+    {
+        sizer_class_st small_s;
+        uint64_t       memory;
+
+        sizer_size_class(&cfg_s, &stream_s, served_au8, 0u, (uint32_t)cand_az[index], cand_az[index], &small_s);
+        sizer_size_class(&cfg_s, &stream_s, served_au8, (uint32_t)cand_az[index], UINT32_MAX, top, &class_s);
+
+        if ((0u == small_s.demands) || (0u == class_s.demands))
+        {
+            continue;
+        }
+
+        memory = small_s.memory_bytes + class_s.memory_bytes;
+
+        if (BENCH_FORMAT_CONSOLE == cfg_s.format_e)
+        {
+            printf("%12zu %12zu %12zu %12.4f %14llu\n", cand_az[index],
+                   small_s.buffer_count, class_s.buffer_count,
+                   100.0 * (((small_s.fail_rate * (double)small_s.demands) +
+                             (class_s.fail_rate * (double)class_s.demands)) / (double)stream_s.demand_count),
+                   (unsigned long long)memory);
+        }
+
+        if ((false == have_split) || (memory < (best_small_s.memory_bytes + best_large_s.memory_bytes)))
+        {
+            best_small_s = small_s;
+            best_large_s = class_s;
+            have_split   = true;
+        }
+    }
+
+    if (BENCH_FORMAT_JSON == cfg_s.format_e)
+    {
+        printf("{\"acquires\": %zu, \"max_request\": %u, \"target_fail\": %g,\n"
+               " \"single\": {\"buffer_size\": %zu, \"buffer_count\": %zu, \"peak\": %zu, "
+               "\"fail_rate\": %g, \"frag\": %.4f, \"memory_bytes\": %llu}",
+               stream_s.demand_count, stream_s.max_size, cfg_s.target_fail,
+               single_s.buffer_size, single_s.buffer_count, single_s.peak,
+               single_s.fail_rate, single_s.frag, (unsigned long long)single_s.memory_bytes);
+        if (true == have_split)
+        {
+            printf(",\n \"split\": {\"small_size\": %zu, \"small_count\": %zu, \"large_size\": %zu, "
+                   "\"large_count\": %zu, \"memory_bytes\": %llu}",
+                   best_small_s.buffer_size, best_small_s.buffer_count,
+                   best_large_s.buffer_size, best_large_s.buffer_count,
+                   (unsigned long long)(best_small_s.memory_bytes + best_large_s.memory_bytes));
+        }
+        printf("}\n");
+    }
+    else
+    {
+        printf("\nsingle class: BUF_COUNT %zu, BUF_SIZE %zu (peak %zu, fail %.4f%%, frag %.2f%%), %llu bytes\n",
+               single_s.buffer_count, single_s.buffer_size, single_s.peak,
+               100.0 * single_s.fail_rate, 100.0 * single_s.frag,
+               (unsigned long long)single_s.memory_bytes);
+
+        if ((true == have_split) &&
+            ((best_small_s.memory_bytes + best_large_s.memory_bytes) < single_s.memory_bytes))
+        {
+            printf("recommended:  two classes, %zu x %zu bytes + %zu x %zu bytes, %llu bytes (%.1f%% of single class)\n",
+                   best_small_s.buffer_count, best_small_s.buffer_size,
+                   best_large_s.buffer_count, best_large_s.buffer_size,
+                   (unsigned long long)(best_small_s.memory_bytes + best_large_s.memory_bytes),
+                   (100.0 * (double)(best_small_s.memory_bytes + best_large_s.memory_bytes)) /
+                   (double)single_s.memory_bytes);
+        }
+        else
+        {
+            printf("recommended:  single class, BUF_COUNT %zu, BUF_SIZE %zu, %llu bytes\n",
+                   single_s.buffer_count, single_s.buffer_size,
+                   (unsigned long long)single_s.memory_bytes);
+        }
+    }
+
+    free(served_au8);
+    free(stream_s.events_as);
+    free(stream_s.size_au32);
+    bench_trace_free(&trace_s);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file pool_stats.c
+ * @brief Print the live statistics of a pool published with buffer_shm.h.
+ *
+ * Maps the segment read-only and never touches the service: every sample
+ * is a handful of loads from shared memory.
+ *
+ * Console mode prints one line per interval with per-second rates.
+ * Prometheus mode prints the text exposition format once (or --count
+ * times), e.g. for a textfile collector or a scrape wrapper.
+ *
+ * If the service died in the middle of an occupancy update, the occupancy
+ * reads as "torn" (console) or is omitted (Prometheus); the tool never
+ * waits for the writer.
+ *
+ * Build (the library must be built with the same BUFFER_CFG_* options as
+ * the service):
+ *   cc -O2 -DBUFFER_CFG_STATS=1 -I. -Ibench tools/pool_stats.c buffer_shm.c buffer.c \
+ *      bench/bench_util.c -o pool_stats
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "buffer.h"
+#include "buffer_shm.h"
+#include "bench_util.h"
+
+#if (0 == BUFFER_CFG_STATS)
+#error "pool_stats needs BUFFER_CFG_STATS=1"
+#endif
+
+/**
+ * @brief Tool configuration (from the command line).
+ */
+typedef struct
+{
+    char const *name_cp;
+    uint32_t    interval_ms;
+    uint32_t    count;               /**< Samples to print, 0 for no limit. */
+    bool        is_prometheus;
+} stats_cfg_st;
+
+static void stats_usage(char const *prog_cp)
+{
+    fprintf(stderr,
+            "usage: %s NAME [--interval-ms=N] [--count=N] [--prometheus]\n",
+            prog_cp);
+}
+
+static bool stats_parse_args(int argc, char **argv, stats_cfg_st *cfg_sp)
+{
+    int index;
+
+    memset(cfg_sp, 0, sizeof(*cfg_sp));
+    cfg_sp->interval_ms = 1000u;
+
+    for (index = 1; index < argc; ++index)
+    {
+        char const *value_cp;
+
+        if (true == bench_match_option(argv[index], "--interval-ms", &value_cp))
+        {
+            cfg_sp->interval_ms = (uint32_t)strtoul(value_cp, NULL, 10);
+            if (0u == cfg_sp->interval_ms)
+            {
+                return false;
+            }
+        }
+        else if (true == bench_match_option(argv[index], "--count", &value_cp))
+        {
+            cfg_sp->count = (uint32_t)strtoul(value_cp, NULL, 10);
+        }
+        else if (0 == strcmp(argv[index], "--prometheus"))
+        {
+            cfg_sp->is_prometheus = true;
+        }
+        else if (('-' != argv[index][0]) && (NULL == cfg_sp->name_cp))
+        {
+            cfg_sp->name_cp = argv[index];
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if ((true == cfg_sp->is_prometheus) && (0u == cfg_sp->count))
+    {
+        cfg_sp->count = 1u;
+    }
+
+    return (NULL != cfg_sp->name_cp);
+}
+
+static void stats_print_metric(char const *name_cp, char const *type_cp, char const *help_cp,
+                               char const *pool_cp, unsigned long long value)
+{
+    printf("# HELP buffer_pool_%s %s\n", name_cp, help_cp);
+    printf("# TYPE buffer_pool_%s %s\n", name_cp, type_cp);
+    printf("buffer_pool_%s{pool=\"%s\"} %llu\n", name_cp, pool_cp, value);
+}
+
+static void stats_print_prometheus(stats_cfg_st const *cfg_csp,
+                                   buffer_shm_header_st const *header_csp,
+                                   buffer_pool_counters_st const *counters_csp)
+{
+    char const *pool_cp = ('/' == cfg_csp->name_cp[0]) ? &cfg_csp->name_cp[1] : cfg_csp->name_cp;
+
+    stats_print_metric("acquires_total", "counter", "Successful acquires.",
+                       pool_cp, (unsigned long long)counters_csp->acquires);
+    stats_print_metric("failed_acquires_total", "counter", "Acquires that found no free buffer.",
+                       pool_cp, (unsigned long long)counters_csp->failed_acquires);
+    stats_print_metric("releases_total", "counter", "Releases of in-use buffers.",
+                       pool_cp, (unsigned long long)counters_csp->releases);
+    stats_print_metric("invalid_releases_total", "counter", "Releases of NULL or already free buffers.",
+                       pool_cp, (unsigned long long)counters_csp->invalid_releases);
+    stats_print_metric("foreign_releases_total", "counter", "Releases of pointers not owned by the pool.",
+                       pool_cp, (unsigned long long)counters_csp->foreign_releases);
+    stats_print_metric("scan_steps_total", "counter", "Descriptors visited by acquire and find.",
+                       pool_cp, (unsigned long long)counters_csp->scan_steps);
+    stats_print_metric("buffers", "gauge", "Buffers in the pool.",
+                       pool_cp, (unsigned long long)header_csp->buffer_count);
+
+    /* A torn occupancy (service died mid-update) is left out, not reported as 0. */
+    if (true == counters_csp->occupancy_valid)
+    {
+        stats_print_metric("in_use", "gauge", "Buffers currently acquired.",
+                           pool_cp, (unsigned long long)counters_csp->in_use);
+        stats_print_metric("high_water", "gauge", "Highest number of buffers in use.",
+                           pool_cp, (unsigned long long)counters_csp->high_water);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    stats_cfg_st                cfg_s;
+    buffer_shm_st               shm_s;
+    buffer_shm_header_st const *header_csp;
+    buffer_pool_counters_st     prev_s;
+    buffer_pool_counters_st     now_s;
+    struct timespec             pause_s;
+    uint32_t                    sample;
+
+    if (false == stats_parse_args(argc, argv, &cfg_s))
+    {
+        stats_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (false == buffer_shm_open(&shm_s, cfg_s.name_cp))
+    {
+        fprintf(stderr, "%s: no statistics segment with a matching layout\n", cfg_s.name_cp);
+        return EXIT_FAILURE;
+    }
+
+    header_csp      = buffer_shm_header(&shm_s);
+    pause_s.tv_sec  = (time_t)(cfg_s.interval_ms / 1000u);
+    pause_s.tv_nsec = (long)(cfg_s.interval_ms % 1000u) * 1000000L;
+
+    (void)buffer_pool_stats_sum(buffer_shm_stats(&shm_s), &prev_s);
+
+    if (false == cfg_s.is_prometheus)
+    {
+        printf("pool %s: %llu buffers of %llu bytes, pid %lld\n", cfg_s.name_cp,
+               (unsigned long long)header_csp->buffer_count,
+               (unsigned long long)header_csp->buffer_size,
+               (long long)header_csp->pid);
+        printf("%12s %12s %12s %10s %10s %10s %12s\n",
+               "acquire/s", "fail/s", "release/s", "in_use", "free", "high", "scan/op");
+    }
+
+    for (sample = 0u; (0u == cfg_s.count) || (sample < cfg_s.count); ++sample)
+    {
+        if (true == cfg_s.is_prometheus)
+        {
+            (void)buffer_pool_stats_sum(buffer_shm_stats(&shm_s), &now_s);
+            stats_print_prometheus(&cfg_s, header_csp, &now_s);
+        }
+        else
+        {
+            double   seconds = (double)cfg_s.interval_ms / 1000.0;
+            uint64_t calls;
+
+            (void)nanosleep(&pause_s, NULL);
+            (void)buffer_pool_stats_sum(buffer_shm_stats(&shm_s), &now_s);
+
+            /* Acquires scan for a free buffer, releases scan for the pointer. */
+            calls = (now_s.acquires         - prev_s.acquires)         +
+                    (now_s.failed_acquires  - prev_s.failed_acquires)  +
+                    (now_s.releases         - prev_s.releases)         +
+                    (now_s.invalid_releases - prev_s.invalid_releases) +
+                    (now_s.foreign_releases - prev_s.foreign_releases);
+            printf("%12.0f %12.0f %12.0f ",
+                   (double)(now_s.acquires - prev_s.acquires) / seconds,
+                   (double)(now_s.failed_acquires - prev_s.failed_acquires) / seconds,
+                   (double)(now_s.releases - prev_s.releases) / seconds);
+            if (true == now_s.occupancy_valid)
+            {
+                printf("%10zu %10llu %10zu ",
+                       now_s.in_use,
+                       (unsigned long long)((now_s.in_use < header_csp->buffer_count) ?
+                                            (header_csp->buffer_count - now_s.in_use) : 0u),
+                       now_s.high_water);
+            }
+            else
+            {
+                printf("%10s %10s %10s ", "torn", "-", "-");
+            }
+            printf("%12.1f\n",
+                   (0u < calls) ? ((double)(now_s.scan_steps - prev_s.scan_steps) / (double)calls) : 0.0);
+            fflush(stdout);
+        }
+
+        prev_s = now_s;
+
+        if ((true == cfg_s.is_prometheus) && ((sample + 1u) != cfg_s.count))
+        {
+            (void)nanosleep(&pause_s, NULL);
+        }
+    }
+
+    buffer_shm_close(&shm_s);
+    return EXIT_SUCCESS;
+}